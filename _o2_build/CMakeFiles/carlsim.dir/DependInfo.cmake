@@ -0,0 +1,32 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/carlsim/dummy.cpp" "CMakeFiles/carlsim.dir/carlsim/dummy.cpp.o" "gcc" "CMakeFiles/carlsim.dir/carlsim/dummy.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_o2_build/libcarlsim.so" "/root/repo/_o2_build/libcarlsim.so.4.0.0"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/carlsim/interface/CMakeFiles/carlsim-interface.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/kernel/CMakeFiles/carlsim-kernel.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/monitor/CMakeFiles/carlsim-monitor.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/tools/simple_weight_tuner/CMakeFiles/carlsim-simple-weight-tuner.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/tools/stopwatch/CMakeFiles/carlsim-stopwatch.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/tools/visual_stimulus/CMakeFiles/carlsim-visual-stimulus.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim.dir/carlsim/dummy.cpp.o"
+  "CMakeFiles/carlsim.dir/carlsim/dummy.cpp.o.d"
+  "libcarlsim.pdb"
+  "libcarlsim.so"
+  "libcarlsim.so.4.0.0"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/carlsim/interface/src/callback_core.cpp" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/callback_core.cpp.o" "gcc" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/callback_core.cpp.o.d"
+  "/root/repo/carlsim/interface/src/carlsim.cpp" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/carlsim.cpp.o" "gcc" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/carlsim.cpp.o.d"
+  "/root/repo/carlsim/interface/src/linear_algebra.cpp" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/linear_algebra.cpp.o" "gcc" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/linear_algebra.cpp.o.d"
+  "/root/repo/carlsim/interface/src/poisson_rate.cpp" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/poisson_rate.cpp.o" "gcc" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/poisson_rate.cpp.o.d"
+  "/root/repo/carlsim/interface/src/user_errors.cpp" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/user_errors.cpp.o" "gcc" "carlsim/interface/CMakeFiles/carlsim-interface.dir/src/user_errors.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/carlsim/kernel/CMakeFiles/carlsim-kernel.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/monitor/CMakeFiles/carlsim-monitor.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
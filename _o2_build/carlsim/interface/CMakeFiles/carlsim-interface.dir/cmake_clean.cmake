@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-interface.dir/src/callback_core.cpp.o"
+  "CMakeFiles/carlsim-interface.dir/src/callback_core.cpp.o.d"
+  "CMakeFiles/carlsim-interface.dir/src/carlsim.cpp.o"
+  "CMakeFiles/carlsim-interface.dir/src/carlsim.cpp.o.d"
+  "CMakeFiles/carlsim-interface.dir/src/linear_algebra.cpp.o"
+  "CMakeFiles/carlsim-interface.dir/src/linear_algebra.cpp.o.d"
+  "CMakeFiles/carlsim-interface.dir/src/poisson_rate.cpp.o"
+  "CMakeFiles/carlsim-interface.dir/src/poisson_rate.cpp.o.d"
+  "CMakeFiles/carlsim-interface.dir/src/user_errors.cpp.o"
+  "CMakeFiles/carlsim-interface.dir/src/user_errors.cpp.o.d"
+  "libcarlsim-interface.a"
+  "libcarlsim-interface.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-interface.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
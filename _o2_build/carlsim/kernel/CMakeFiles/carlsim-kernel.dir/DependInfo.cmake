@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/carlsim/kernel/src/print_snn_info.cpp" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/print_snn_info.cpp.o" "gcc" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/print_snn_info.cpp.o.d"
+  "/root/repo/carlsim/kernel/src/snn_cpu_module.cpp" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/snn_cpu_module.cpp.o" "gcc" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/snn_cpu_module.cpp.o.d"
+  "/root/repo/carlsim/kernel/src/snn_cpu_simd.cpp" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/snn_cpu_simd.cpp.o" "gcc" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/snn_cpu_simd.cpp.o.d"
+  "/root/repo/carlsim/kernel/src/snn_manager.cpp" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/snn_manager.cpp.o" "gcc" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/snn_manager.cpp.o.d"
+  "/root/repo/carlsim/kernel/src/spike_buffer.cpp" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/spike_buffer.cpp.o" "gcc" "carlsim/kernel/CMakeFiles/carlsim-kernel.dir/src/spike_buffer.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/carlsim/monitor/CMakeFiles/carlsim-monitor.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
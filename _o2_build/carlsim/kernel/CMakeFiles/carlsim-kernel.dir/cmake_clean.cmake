@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-kernel.dir/src/print_snn_info.cpp.o"
+  "CMakeFiles/carlsim-kernel.dir/src/print_snn_info.cpp.o.d"
+  "CMakeFiles/carlsim-kernel.dir/src/snn_cpu_module.cpp.o"
+  "CMakeFiles/carlsim-kernel.dir/src/snn_cpu_module.cpp.o.d"
+  "CMakeFiles/carlsim-kernel.dir/src/snn_cpu_simd.cpp.o"
+  "CMakeFiles/carlsim-kernel.dir/src/snn_cpu_simd.cpp.o.d"
+  "CMakeFiles/carlsim-kernel.dir/src/snn_manager.cpp.o"
+  "CMakeFiles/carlsim-kernel.dir/src/snn_manager.cpp.o.d"
+  "CMakeFiles/carlsim-kernel.dir/src/spike_buffer.cpp.o"
+  "CMakeFiles/carlsim-kernel.dir/src/spike_buffer.cpp.o.d"
+  "libcarlsim-kernel.a"
+  "libcarlsim-kernel.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-kernel.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/carlsim/monitor/connection_monitor.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/connection_monitor.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/connection_monitor.cpp.o.d"
+  "/root/repo/carlsim/monitor/connection_monitor_core.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/connection_monitor_core.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/connection_monitor_core.cpp.o.d"
+  "/root/repo/carlsim/monitor/group_monitor.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/group_monitor.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/group_monitor.cpp.o.d"
+  "/root/repo/carlsim/monitor/group_monitor_core.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/group_monitor_core.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/group_monitor_core.cpp.o.d"
+  "/root/repo/carlsim/monitor/neuron_monitor.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/neuron_monitor.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/neuron_monitor.cpp.o.d"
+  "/root/repo/carlsim/monitor/neuron_monitor_core.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/neuron_monitor_core.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/neuron_monitor_core.cpp.o.d"
+  "/root/repo/carlsim/monitor/spike_monitor.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/spike_monitor.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/spike_monitor.cpp.o.d"
+  "/root/repo/carlsim/monitor/spike_monitor_core.cpp" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/spike_monitor_core.cpp.o" "gcc" "carlsim/monitor/CMakeFiles/carlsim-monitor.dir/spike_monitor_core.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/carlsim/kernel/CMakeFiles/carlsim-kernel.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
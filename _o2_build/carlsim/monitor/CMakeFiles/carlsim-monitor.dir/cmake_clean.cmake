@@ -0,0 +1,25 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-monitor.dir/connection_monitor.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/connection_monitor.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/connection_monitor_core.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/connection_monitor_core.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/group_monitor.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/group_monitor.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/group_monitor_core.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/group_monitor_core.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/neuron_monitor.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/neuron_monitor.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/neuron_monitor_core.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/neuron_monitor_core.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/spike_monitor.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/spike_monitor.cpp.o.d"
+  "CMakeFiles/carlsim-monitor.dir/spike_monitor_core.cpp.o"
+  "CMakeFiles/carlsim-monitor.dir/spike_monitor_core.cpp.o.d"
+  "libcarlsim-monitor.a"
+  "libcarlsim-monitor.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-monitor.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,37 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/carlsim/test/carlsim_tests_common.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/carlsim_tests_common.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/carlsim_tests_common.cpp.o.d"
+  "/root/repo/carlsim/test/coba.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/coba.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/coba.cpp.o.d"
+  "/root/repo/carlsim/test/conn_mon.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/conn_mon.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/conn_mon.cpp.o.d"
+  "/root/repo/carlsim/test/connect.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/connect.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/connect.cpp.o.d"
+  "/root/repo/carlsim/test/core.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/core.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/core.cpp.o.d"
+  "/root/repo/carlsim/test/cuba.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/cuba.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/cuba.cpp.o.d"
+  "/root/repo/carlsim/test/group_mon.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/group_mon.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/group_mon.cpp.o.d"
+  "/root/repo/carlsim/test/interface.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/interface.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/interface.cpp.o.d"
+  "/root/repo/carlsim/test/main.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/main.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/main.cpp.o.d"
+  "/root/repo/carlsim/test/multi_runtimes.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/multi_runtimes.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/multi_runtimes.cpp.o.d"
+  "/root/repo/carlsim/test/poiss_rate.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/poiss_rate.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/poiss_rate.cpp.o.d"
+  "/root/repo/carlsim/test/spike_gen.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/spike_gen.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/spike_gen.cpp.o.d"
+  "/root/repo/carlsim/test/spike_mon.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/spike_mon.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/spike_mon.cpp.o.d"
+  "/root/repo/carlsim/test/stdp.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/stdp.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/stdp.cpp.o.d"
+  "/root/repo/carlsim/test/stp.cpp" "carlsim/test/CMakeFiles/carlsim-tests.dir/stp.cpp.o" "gcc" "carlsim/test/CMakeFiles/carlsim-tests.dir/stp.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/interface/CMakeFiles/carlsim-interface.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/monitor/CMakeFiles/carlsim-monitor.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/kernel/CMakeFiles/carlsim-kernel.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,39 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-tests.dir/carlsim_tests_common.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/carlsim_tests_common.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/coba.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/coba.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/conn_mon.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/conn_mon.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/connect.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/connect.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/core.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/core.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/cuba.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/cuba.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/group_mon.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/group_mon.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/interface.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/interface.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/main.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/main.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/multi_runtimes.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/multi_runtimes.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/poiss_rate.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/poiss_rate.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/spike_gen.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/spike_gen.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/spike_mon.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/spike_mon.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/stdp.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/stdp.cpp.o.d"
+  "CMakeFiles/carlsim-tests.dir/stp.cpp.o"
+  "CMakeFiles/carlsim-tests.dir/stp.cpp.o.d"
+  "carlsim-tests"
+  "carlsim-tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tools/simple_weight_tuner/simple_weight_tuner.cpp" "tools/simple_weight_tuner/CMakeFiles/carlsim-simple-weight-tuner.dir/simple_weight_tuner.cpp.o" "gcc" "tools/simple_weight_tuner/CMakeFiles/carlsim-simple-weight-tuner.dir/simple_weight_tuner.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/carlsim/interface/CMakeFiles/carlsim-interface.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/monitor/CMakeFiles/carlsim-monitor.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/kernel/CMakeFiles/carlsim-kernel.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
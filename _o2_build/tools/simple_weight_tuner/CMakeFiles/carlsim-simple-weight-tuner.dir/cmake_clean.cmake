@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-simple-weight-tuner.dir/simple_weight_tuner.cpp.o"
+  "CMakeFiles/carlsim-simple-weight-tuner.dir/simple_weight_tuner.cpp.o.d"
+  "libcarlsim-simple-weight-tuner.a"
+  "libcarlsim-simple-weight-tuner.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-simple-weight-tuner.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libcarlsim-simple-weight-tuner.a"
+)
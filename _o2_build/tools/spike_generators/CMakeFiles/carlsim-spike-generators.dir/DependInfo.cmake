@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tools/spike_generators/interactive_spikegen.cpp" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/interactive_spikegen.cpp.o" "gcc" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/interactive_spikegen.cpp.o.d"
+  "/root/repo/tools/spike_generators/periodic_spikegen.cpp" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/periodic_spikegen.cpp.o" "gcc" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/periodic_spikegen.cpp.o.d"
+  "/root/repo/tools/spike_generators/pre_post_group_spikegen.cpp" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/pre_post_group_spikegen.cpp.o" "gcc" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/pre_post_group_spikegen.cpp.o.d"
+  "/root/repo/tools/spike_generators/spikegen_from_file.cpp" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/spikegen_from_file.cpp.o" "gcc" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/spikegen_from_file.cpp.o.d"
+  "/root/repo/tools/spike_generators/spikegen_from_vector.cpp" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/spikegen_from_vector.cpp.o" "gcc" "tools/spike_generators/CMakeFiles/carlsim-spike-generators.dir/spikegen_from_vector.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_o2_build/carlsim/interface/CMakeFiles/carlsim-interface.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/monitor/CMakeFiles/carlsim-monitor.dir/DependInfo.cmake"
+  "/root/repo/_o2_build/carlsim/kernel/CMakeFiles/carlsim-kernel.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
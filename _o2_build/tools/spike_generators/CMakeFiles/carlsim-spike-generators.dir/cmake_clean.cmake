@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-spike-generators.dir/interactive_spikegen.cpp.o"
+  "CMakeFiles/carlsim-spike-generators.dir/interactive_spikegen.cpp.o.d"
+  "CMakeFiles/carlsim-spike-generators.dir/periodic_spikegen.cpp.o"
+  "CMakeFiles/carlsim-spike-generators.dir/periodic_spikegen.cpp.o.d"
+  "CMakeFiles/carlsim-spike-generators.dir/pre_post_group_spikegen.cpp.o"
+  "CMakeFiles/carlsim-spike-generators.dir/pre_post_group_spikegen.cpp.o.d"
+  "CMakeFiles/carlsim-spike-generators.dir/spikegen_from_file.cpp.o"
+  "CMakeFiles/carlsim-spike-generators.dir/spikegen_from_file.cpp.o.d"
+  "CMakeFiles/carlsim-spike-generators.dir/spikegen_from_vector.cpp.o"
+  "CMakeFiles/carlsim-spike-generators.dir/spikegen_from_vector.cpp.o.d"
+  "libcarlsim-spike-generators.a"
+  "libcarlsim-spike-generators.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-spike-generators.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
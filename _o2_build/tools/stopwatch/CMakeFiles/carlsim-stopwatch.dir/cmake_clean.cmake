@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-stopwatch.dir/stopwatch.cpp.o"
+  "CMakeFiles/carlsim-stopwatch.dir/stopwatch.cpp.o.d"
+  "libcarlsim-stopwatch.a"
+  "libcarlsim-stopwatch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-stopwatch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/carlsim-visual-stimulus.dir/visual_stimulus.cpp.o"
+  "CMakeFiles/carlsim-visual-stimulus.dir/visual_stimulus.cpp.o.d"
+  "libcarlsim-visual-stimulus.a"
+  "libcarlsim-visual-stimulus.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/carlsim-visual-stimulus.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
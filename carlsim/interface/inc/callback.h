@@ -49,9 +49,47 @@
 #ifndef _CALLBACK_H_
 #define _CALLBACK_H_
 
+#include <vector>
+#include <utility>
+
 // CARLsim user interface classes
 class CARLsim; // forward-declaration
 
+/*!
+ * \brief collects the spikes a SpikeGenerator schedules for a time slice
+ *
+ * A SpikeSink is handed to SpikeGenerator::generateSpikes, which adds one (spike time, neuron ID) event per spike
+ * to be scheduled. The sink is owned by CARLsim and re-used for every call, so that filling it does not allocate
+ * memory once it has grown to the size of a typical time slice.
+ * \since v4.0
+ */
+class SpikeSink {
+public:
+	SpikeSink() {}
+
+	/*!
+	 * \brief schedules a spike
+	 * \param[in] spikeTime the time (ms) at which the neuron should spike
+	 * \param[in] neurId the neuron index in the group
+	 */
+	void addSpike(int spikeTime, int neurId) { spikes_.push_back(std::make_pair(spikeTime, neurId)); }
+
+	//! returns the number of spikes in the sink
+	int getNumSpikes() const { return spikes_.size(); }
+
+	//! returns the time (ms) of the i-th spike in the sink
+	int getSpikeTime(int i) const { return spikes_[i].first; }
+
+	//! returns the neuron index (in the group) of the i-th spike in the sink
+	int getNeuronId(int i) const { return spikes_[i].second; }
+
+	//! removes all spikes from the sink (keeps the allocated memory)
+	void clear() { spikes_.clear(); }
+
+private:
+	std::vector<std::pair<int, int> > spikes_; //!< (spike time, neuron ID) events
+};
+
 /*! Spike generation can be performed using spike generators. Spike generators are dummy-neurons that have their spikes
  * specified externally either defined by a Poisson firing rate or via a spike injection mechanism. Spike generators can
  * have post-synaptic connections with STDP and STP, but unlike Izhikevich neurons, they do not receive any pre-synaptic
@@ -62,12 +100,16 @@ class CARLsim; // forward-declaration
  * fired or not. */
 class SpikeGenerator {
 public:
-	//SpikeGenerator() {};
+	SpikeGenerator() : nextSpikeTimeImplemented_(true) {}
     virtual ~SpikeGenerator() {}
 
 	/*!
 	 * \brief controls spike generation using a callback mechanism
 	 *
+	 * This method is called repeatedly for every neuron in the group and every spike, until it returns a spike time
+	 * that cannot be scheduled. It is only used if generateSpikes is not implemented. A SpikeGenerator must implement
+	 * at least one of the two methods, otherwise the simulation exits with an error.
+	 *
 	 * \attention The virtual method should never be called directly
 	 * \param s pointer to the simulator object
 	 * \param grpId the group id
@@ -76,7 +118,37 @@ public:
 	 * \param lastScheduledSpikeTime the last spike time which was scheduled
 	 * \param endOfTimeSlice the end of the current scheduling time slice. Spike times after this will not be scheduled.
 	 */
-	virtual int nextSpikeTime(CARLsim* s, int grpId, int i, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice) = 0;
+	virtual int nextSpikeTime(CARLsim* /*s*/, int /*grpId*/, int /*i*/, int /*currentTime*/, int /*lastScheduledSpikeTime*/,
+		int /*endOfTimeSlice*/) {
+		nextSpikeTimeImplemented_ = false;
+		return -1;
+	}
+
+	/*!
+	 * \brief schedules all spikes of a group for a scheduling time slice in a single call
+	 *
+	 * This method is called once per group and time slice, and should add every spike with a spike time in
+	 * [tStart, tEnd) to the sink. Spikes outside of this window are ignored. Unlike nextSpikeTime, the generator
+	 * is responsible for not scheduling the same spike twice across time slices.
+	 * The default implementation returns false, in which case CARLsim falls back to calling nextSpikeTime for every
+	 * neuron.
+	 *
+	 * \attention The virtual method should never be called directly
+	 * \param s pointer to the simulator object
+	 * \param grpId the group id
+	 * \param tStart the current simulation time (ms), which is the beginning of the scheduling time slice
+	 * \param tEnd the end of the scheduling time slice (ms)
+	 * \param sink the SpikeSink to which the spikes should be added
+	 * \returns true if the method is implemented, false otherwise
+	 * \since v4.0
+	 */
+	virtual bool generateSpikes(CARLsim* /*s*/, int /*grpId*/, int /*tStart*/, int /*tEnd*/, SpikeSink& /*sink*/) {
+		return false;
+	}
+
+private:
+	friend class SpikeGeneratorCore;
+	bool nextSpikeTimeImplemented_; //!< cleared by the default nextSpikeTime, i.e. if neither callback is implemented
 };
 
 /*!
@@ -54,6 +54,7 @@ class SNN;
 
 class ConnectionGenerator;
 class SpikeGenerator;
+class SpikeSink;
 
 /// **************************************************************************************************************** ///
 /// Classes for relay callback
@@ -74,6 +75,14 @@ public:
 	 */
 	virtual int nextSpikeTime(SNN* s, int grpId, int i, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice);
 
+	//! schedules all spikes of a group for a time slice using a callback mechanism
+	/*! \attention The virtual method should never be called directly
+	 */
+	virtual bool generateSpikes(SNN* s, int grpId, int tStart, int tEnd, SpikeSink& sink);
+
+	//! returns false if the user-defined SpikeGenerator fell back to the default nextSpikeTime
+	bool isNextSpikeTimeImplemented();
+
 private:
 	CARLsim* carlsim;
 	SpikeGenerator* sGen;
@@ -498,6 +498,49 @@ public:
 	*/
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	/*!
+	* \brief Sets the number of worker threads of every CPU runtime
+	*
+	* By default, the CPU cores are shared evenly among the CPU runtimes, and every worker of a runtime integrates at
+	* least MIN_NEURONS_PER_CPU_THREAD neurons. This function overrides that choice: every CPU runtime will use
+	* <tt>numThreads</tt> workers (but never more workers than it has regular neurons). A value of 0 restores the
+	* default. Spikes and weights do not depend on the number of workers, so this is mainly useful to benchmark or
+	* test the multi-threaded CPU path.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] numThreads the number of workers per CPU runtime, or 0 to choose automatically
+	*
+	* \note On platforms without pthread barriers (Windows, macOS) every CPU runtime runs on a single thread and the
+	* setting is ignored.
+	*/
+	void setNumCPUThreads(int numThreads);
+
+	/*!
+	* \brief Sets the number of CPU cores available to the CPU runtimes
+	*
+	* By default, CARLsim uses all online cores: in ::HYBRID_MODE, the partitioner creates at most one CPU runtime per
+	* core, and the workers of the CPU runtimes share the cores evenly. This function overrides the number of cores
+	* for both decisions, e.g. to leave cores to other processes, or to get the same partitions on every machine.
+	* A value of 0 restores the default.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] numCores the number of cores available to the CPU runtimes, or 0 to use all online cores
+	* \see CARLsim::setNumCPUThreads
+	*/
+	void setNumCPUCores(int numCores);
+
+	/*!
+	* \brief Enables or disables the vectorized (AVX2 / AVX-512) neuron update of the CPU runtimes
+	*
+	* By default, CPU runtimes integrate Izhikevich and LIF neurons with vector instructions if the processor
+	* supports them. The vectorized path computes the same results as the scalar path, so disabling it is mainly
+	* useful to benchmark or test the two paths against each other.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] isSet whether to use vector instructions where available (true) or the scalar path only (false)
+	*/
+	void setCPUVectorization(bool isSet);
+
 	/*!
 	 * \brief Sets Izhikevich params a, b, c, and d with as mean +- standard deviation
 	 *
@@ -924,6 +967,91 @@ public:
 	 */
 	void loadSimulation(FILE* fid);
 
+	/*!
+	 * \brief Caches the generated connectivity on disk and reuses it in later runs with the same topology
+	 *
+	 * When set, CARLsim::setupNetwork hashes everything that determines the synapses of the network (random seed,
+	 * group sizes, types, grids and placement, and the configuration of every connection) and looks for the file
+	 * <tt>conn_<hash>.dat</tt> in the directory dirName. If the file exists, the synapses are read from the
+	 * (memory-mapped) file instead of being generated. Otherwise, the synapses are generated as usual and written to
+	 * that file. This avoids rebuilding the same network in parameter sweeps that only change neuron parameters.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] dirName   existing directory that holds the cache files
+	 *
+	 * \note Networks with user-defined connections, and networks loaded with CARLsim::loadSimulation, are not cached.
+	 * \note The cache holds the connectivity only; the runtime data is still generated in CARLsim::setupNetwork.
+	 * \see CARLsim::loadSimulation
+	 */
+	void setConnectionCache(const std::string& dirName);
+
+	/*!
+	 * \brief Saves the complete runtime state of a simulation to file, so that it can be resumed later
+	 *
+	 * Unlike CARLsim::saveSimulation, which stores the network (weights and delays), a checkpoint stores everything
+	 * that changes while the network runs: the neuron state (membrane potential, recovery variable, currents,
+	 * conductances, refractory counters, homeostatic firing averages), the synapse state (weights, weight changes,
+	 * last spike times, STP variables), the spikes that are still in flight, the neuromodulator levels, the simulation
+	 * time, and the state of the random number generator.
+	 * A network that is set up exactly like the one that created the checkpoint and that calls
+	 * CARLsim::loadCheckpoint will then produce the same spikes as the original simulation would have.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] fileName   name of the checkpoint file
+	 *
+	 * \note Checkpoints are supported for networks that run on CPU cores only.
+	 * \note Spike generators that keep their own state (such as a SpikeGenerator object) are not part of the
+	 * checkpoint; they are asked for spikes again starting at the restored simulation time.
+	 * \see CARLsim::loadCheckpoint
+	 */
+	void saveCheckpoint(const std::string& fileName);
+
+	/*!
+	 * \brief Restores the runtime state of a simulation that was saved with CARLsim::saveCheckpoint
+	 *
+	 * The network must be configured, partitioned, and set up exactly like the one that created the checkpoint
+	 * (including the random seed, unless all connections are loaded with CARLsim::loadSimulation).
+	 * The simulation then continues at the time at which the checkpoint was taken, and monitors record from there.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] fileName   name of a checkpoint file created with CARLsim::saveCheckpoint
+	 * \see CARLsim::saveCheckpoint
+	 */
+	void loadCheckpoint(const std::string& fileName);
+
+	/*!
+	 * \brief Saves the plastic weights that changed since the last full checkpoint
+	 *
+	 * In networks with STDP, a learning run can be checkpointed much more cheaply by writing one full checkpoint
+	 * (CARLsim::saveCheckpoint) as a base, followed by delta checkpoints that hold only the weights (and pending
+	 * weight changes) of the plastic synapses that changed since that base.
+	 * Every delta is chained to its base and numbered. CARLsim::loadCheckpointDelta accepts only deltas of the base
+	 * that was loaded last, in the order in which they were saved.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] fileName   name of the delta checkpoint file
+	 * \param[in] epsilon    only synapses whose weight moved by more than epsilon since the base are written. The
+	 *                       default (0) writes every synapse that changed, which restores the weights exactly.
+	 *
+	 * \note A delta holds the plastic weights only. All other state (neurons, in-flight spikes, time) is restored
+	 * from the base.
+	 * \see CARLsim::loadCheckpointDelta
+	 * \see CARLsim::saveCheckpoint
+	 */
+	void saveCheckpointDelta(const std::string& fileName, float epsilon=0.0f);
+
+	/*!
+	 * \brief Applies a delta checkpoint on top of its base
+	 *
+	 * The base must have been restored with CARLsim::loadCheckpoint first. Several deltas of the same base can be
+	 * replayed in the order in which they were saved.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] fileName   name of a delta checkpoint file created with CARLsim::saveCheckpointDelta
+	 * \see CARLsim::saveCheckpointDelta
+	 */
+	void loadCheckpointDelta(const std::string& fileName);
+
 	/*!
 	 * \brief reset Spike Counter to zero
 	 *
@@ -1111,7 +1239,9 @@ public:
 	 * specifying individual spike times for each neuron in a group.
 	 *
 	 * In order to specify spike times, a new class must be defined first that derives from the SpikeGenerator class
-	 * and implements the virtual method SpikeGenerator::nextSpikeTime.
+	 * and implements the virtual method SpikeGenerator::generateSpikes, which schedules the spikes of all neurons for a
+	 * scheduling time slice in a single call. Alternatively, the virtual method SpikeGenerator::nextSpikeTime can be
+	 * implemented, which is called once per neuron and spike.
 	 * Then, in order for a custom SpikeGenerator to be associated with a SpikeGenerator group,
 	 * CARLsim::setSpikeGenerator must be called on the group in ::CONFIG_STATE:.
 	 *
@@ -1221,8 +1351,12 @@ public:
 	 * \param[in] grpId      group ID
 	 * \param[in] spikeRate  pointer to PoissonRate object
 	 * \param[in] refPeriod  refactory period (ms). Default: 1ms.
+	 * \param[in] eventDriven  whether to draw the time until the next spike of each neuron instead of testing every
+	 *                        neuron every millisecond. Spike trains have the same statistics, but only neurons that fire
+	 *                        are touched, which pays off for large groups with low rates. Default: false.
 	 *
 	 * \note This method can only be applied to SpikeGenerator groups.
+	 * \note refPeriod is only enforced in event-driven mode. Event-driven mode is only supported on CPU_CORES.
 	 * \note setSpikeRate will *not* take over ownership of PoissonRate. In other words, if you allocate the
 	 * PoissonRate object on the heap, you are responsible for correctly deallocating it.
 	 * \attention Make sure to reset spike rate after use (i.e., for the next call to runNetwork), otherwise
@@ -1230,7 +1364,7 @@ public:
 	 * \see setExternalCurrent
 	 * \see setSpikeGenerator
 	 */
-	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod=1);
+	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod=1, bool eventDriven=false);
 
 	/*!
 	 * \brief Sets the weight value of a specific synapse
@@ -1565,6 +1699,15 @@ public:
 	 */
 	int getNumSynapses();
 
+	/*!
+	 * \brief returns the file that holds the cached connectivity of the network
+	 *
+	 * Returns an empty string if the connectivity is not cached.
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \see CARLsim::setConnectionCache
+	 */
+	std::string getConnectionCacheFile();
+
 	/*!
 	 * \brief returns the first neuron id of a groupd specified by grpId
 	 *
@@ -1573,6 +1716,14 @@ public:
 	 */
 	int getGroupStartNeuronId(int grpId);
 
+	/*!
+	 * \brief returns the id of the local network (runtime) that simulates the group specified by grpId
+	 *
+	 * Ids below GPU_RUNTIME_BASE + number of GPUs are GPU runtimes, ids from CPU_RUNTIME_BASE on are CPU runtimes.
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 */
+	int getGroupNetId(int grpId);
+
 	/*!
 	 * \brief returns the last neuron id of a groupd specified by grpId
 	 *
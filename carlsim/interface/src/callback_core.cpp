@@ -65,6 +65,17 @@ int SpikeGeneratorCore::nextSpikeTime(SNN* s, int grpId, int i, int currentTime,
 		return 0xFFFFFFFF;
 }
 
+bool SpikeGeneratorCore::generateSpikes(SNN* s, int grpId, int tStart, int tEnd, SpikeSink& sink) {
+	if (sGen != NULL)
+		return sGen->generateSpikes(carlsim, grpId, tStart, tEnd, sink);
+	else
+		return false;
+}
+
+bool SpikeGeneratorCore::isNextSpikeTimeImplemented() {
+	return sGen == NULL || sGen->nextSpikeTimeImplemented_;
+}
+
 ConnectionGeneratorCore::ConnectionGeneratorCore(CARLsim* c, ConnectionGenerator* cg) {
 	carlsim = c;
 	cGen = cg;
@@ -558,6 +558,35 @@ public:
 		//std::cout << "numStepsPerMs is (in interface): " + numStepsPerMs << std::endl;
 	}
 
+	// sets the number of workers of every CPU runtime (0: automatic)
+	void setNumCPUThreads(int numThreads) {
+		std::string funcName = "setNumCPUThreads()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(numThreads >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "numThreads");
+
+		snn_->setNumCPUThreads(numThreads);
+	}
+
+	// sets the number of cores available to the CPU runtimes (0: all online cores)
+	void setNumCPUCores(int numCores) {
+		std::string funcName = "setNumCPUCores()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(numCores >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "numCores");
+
+		snn_->setNumCPUCores(numCores);
+	}
+
+	// enables or disables the vectorized neuron update of the CPU runtimes
+	void setCPUVectorization(bool isSet) {
+		std::string funcName = "setCPUVectorization()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUVectorization(isSet);
+	}
+
 	// set neuron parameters for Izhikevich neuron, with standard deviations
 	void setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 		float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -961,6 +990,68 @@ public:
 		snn_->loadSimulation(fid);
 	}
 
+	// caches the generated connectivity in a directory
+	void setConnectionCache(const std::string& dirName) {
+		std::string funcName = "setConnectionCache(\"" + dirName + "\")";
+		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName,
+			funcName, "CONFIG.");
+
+		snn_->setConnectionCache(dirName);
+	}
+
+	// writes the complete runtime state to file
+	void saveCheckpoint(const std::string& fileName) {
+		std::string funcName = "saveCheckpoint(\"" + fileName + "\")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		FILE* fpCheckpoint = fopen(fileName.c_str(), "wb");
+		UserErrors::assertTrue(fpCheckpoint != NULL, UserErrors::FILE_CANNOT_OPEN, funcName, fileName);
+
+		snn_->saveCheckpoint(fpCheckpoint);
+
+		fclose(fpCheckpoint);
+	}
+
+	// restores the runtime state from file
+	void loadCheckpoint(const std::string& fileName) {
+		std::string funcName = "loadCheckpoint(\"" + fileName + "\")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		FILE* fpCheckpoint = fopen(fileName.c_str(), "rb");
+		UserErrors::assertTrue(fpCheckpoint != NULL, UserErrors::FILE_CANNOT_OPEN, funcName, fileName);
+
+		snn_->loadCheckpoint(fpCheckpoint);
+
+		fclose(fpCheckpoint);
+	}
+
+	// writes the plastic weights that changed since the last full checkpoint
+	void saveCheckpointDelta(const std::string& fileName, float epsilon) {
+		std::string funcName = "saveCheckpointDelta(\"" + fileName + "\")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		UserErrors::assertTrue(epsilon >= 0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "epsilon");
+		FILE* fpCheckpoint = fopen(fileName.c_str(), "wb");
+		UserErrors::assertTrue(fpCheckpoint != NULL, UserErrors::FILE_CANNOT_OPEN, funcName, fileName);
+
+		snn_->saveCheckpointDelta(fpCheckpoint, epsilon);
+
+		fclose(fpCheckpoint);
+	}
+
+	// applies a delta checkpoint on top of its base
+	void loadCheckpointDelta(const std::string& fileName) {
+		std::string funcName = "loadCheckpointDelta(\"" + fileName + "\")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		FILE* fpCheckpoint = fopen(fileName.c_str(), "rb");
+		UserErrors::assertTrue(fpCheckpoint != NULL, UserErrors::FILE_CANNOT_OPEN, funcName, fileName);
+
+		snn_->loadCheckpointDelta(fpCheckpoint);
+
+		fclose(fpCheckpoint);
+	}
+
 	// scales the weight of every synapse in the connection with a scaling factor
 	void scaleWeights(short int connId, float scale, bool updateWeightRange) {
 		std::stringstream funcName;	funcName << "scaleWeights(" << connId << "," << scale << "," << updateWeightRange
@@ -1160,7 +1251,7 @@ public:
 	}
 
 	// assign spike rate to poisson group
-	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod) {
+	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod, bool eventDriven) {
 		std::string funcName = "setSpikeRate()";
 		UserErrors::assertTrue(carlsimState_==SETUP_STATE || carlsimState_==RUN_STATE,
 			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
@@ -1171,7 +1262,7 @@ public:
 		//UserErrors::assertTrue(!spikeRate->isOnGPU() || spikeRate->isOnGPU()&&getSimMode()==GPU_MODE,
 		//	UserErrors::CAN_ONLY_BE_CALLED_IN_MODE, funcName, "PoissonRate on GPU", "GPU_MODE.");
 
-		snn_->setSpikeRate(grpId, spikeRate, refPeriod);
+		snn_->setSpikeRate(grpId, spikeRate, refPeriod, eventDriven);
 	}
 
 	void setWeight(short int connId, int neurIdPre, int neurIdPost, float weight, bool updateWeightRange) {
@@ -1287,6 +1378,16 @@ public:
 		return snn_->getGroupStartNeuronId(grpId);
 	}
 
+	int getGroupNetId(int grpId) {
+		std::stringstream funcName; funcName << "getGroupNetId(" << grpId << ")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+		UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(), "grpId",
+			"[0,getNumGroups()]");
+
+		return snn_->getGroupNetId(grpId);
+	}
+
 	int getGroupEndNeuronId(int grpId) {
 		std::stringstream funcName; funcName << "getGroupEndNeuronId(" << grpId << ")";
 		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
@@ -1357,6 +1458,14 @@ public:
 		return snn_->getNumSynapses();
 	}
 
+	std::string getConnectionCacheFile() {
+		std::string funcName = "getConnectionCacheFile()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+
+		return snn_->getConnectionCacheFile();
+	}
+
 	GroupSTDPInfo getGroupSTDPInfo(int grpId) {
 		std::stringstream funcName; funcName << "getGroupSTDPInfo(" << grpId << ")";
 		UserErrors::assertTrue(grpId >= 0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(),
@@ -1811,6 +1920,18 @@ void CARLsim::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs
 	_impl->setIntegrationMethod(method, numStepsPerMs);
 }
 
+void CARLsim::setNumCPUThreads(int numThreads) {
+	_impl->setNumCPUThreads(numThreads);
+}
+
+void CARLsim::setNumCPUCores(int numCores) {
+	_impl->setNumCPUCores(numCores);
+}
+
+void CARLsim::setCPUVectorization(bool isSet) {
+	_impl->setCPUVectorization(isSet);
+}
+
 // set neuron params
 void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd, float izh_c, 
 	float izh_c_sd, float izh_d, float izh_d_sd)
@@ -1939,6 +2060,15 @@ void CARLsim::biasWeights(short int connId, float bias, bool updateWeightRange)
 
 // Loads a simulation (and network state) from file. The file pointer fid must point to a
 void CARLsim::loadSimulation(FILE* fid) { _impl->loadSimulation(fid); }
+void CARLsim::setConnectionCache(const std::string& dirName) { _impl->setConnectionCache(dirName); }
+
+// Saves / restores the complete runtime state of a simulation
+void CARLsim::saveCheckpoint(const std::string& fileName) { _impl->saveCheckpoint(fileName); }
+void CARLsim::loadCheckpoint(const std::string& fileName) { _impl->loadCheckpoint(fileName); }
+void CARLsim::saveCheckpointDelta(const std::string& fileName, float epsilon) {
+	_impl->saveCheckpointDelta(fileName, epsilon);
+}
+void CARLsim::loadCheckpointDelta(const std::string& fileName) { _impl->loadCheckpointDelta(fileName); }
 
 // Multiplies the weight of every synapse in the connection with a scaling factor
 void CARLsim::scaleWeights(short int connId, float scale, bool updateWeightRange) {
@@ -1979,8 +2109,8 @@ NeuronMonitor* CARLsim::setNeuronMonitor(int grpId, const std::string& fileName)
 }
 
 // Sets a spike rate
-void CARLsim::setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod) {
-	_impl->setSpikeRate(grpId, spikeRate, refPeriod);
+void CARLsim::setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod, bool eventDriven) {
+	_impl->setSpikeRate(grpId, spikeRate, refPeriod, eventDriven);
 }
 
 // Sets the weight value of a specific synapse
@@ -2066,9 +2196,15 @@ int CARLsim::getNumNeuronsGenInh() { return _impl->getNumNeuronsGenInh(); }
 // returns the total number of allocated post-synaptic connections in the network
 int CARLsim::getNumSynapses() { return _impl->getNumSynapses(); }
 
+// returns the file that holds the cached connectivity
+std::string CARLsim::getConnectionCacheFile() { return _impl->getConnectionCacheFile(); }
+
 // returns the first neuron id of a groupd specified by grpId
 int CARLsim::getGroupStartNeuronId(int grpId) { return _impl->getGroupStartNeuronId(grpId); }
 
+// returns the local network that simulates the group
+int CARLsim::getGroupNetId(int grpId) { return _impl->getGroupNetId(grpId); }
+
 // returns the last neuron id of a groupd specified by grpId
 int CARLsim::getGroupEndNeuronId(int grpId) { return _impl->getGroupEndNeuronId(grpId); }
 
@@ -244,6 +244,15 @@ public:
 	//! Sets the integration method and the number of integration steps per 1ms simulation time step
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	//! Sets the number of workers of every CPU runtime (0: one worker per MIN_NEURONS_PER_CPU_THREAD neurons, limited by the cores)
+	void setNumCPUThreads(int numThreads) { assert(numThreads >= 0); numCPUThreadsUser = numThreads; }
+
+	//! Sets the number of cores the CPU runtimes are spread over in HYBRID_MODE and share their workers (0: all online cores)
+	void setNumCPUCores(int numCores) { assert(numCores >= 0); numCPUCoresUser = numCores; }
+
+	//! Enables the vectorized neuron update of the CPU runtimes (if supported by the processor), or forces the scalar path
+	void setCPUVectorization(bool isSet) { simdWidth_CPU = isSet ? detectSIMDWidth_CPU() : 1; }
+
 	//! Sets the Izhikevich parameters a, b, c, and d of a neuron group.
 	/*!
 	 * \brief Parameter values for each neuron are given by a normal distribution with mean _a, _b, _c, _d and standard deviation _a_sd, _b_sd, _c_sd, and _d_sd, respectively
@@ -410,6 +419,9 @@ public:
 	 */
 	void loadSimulation(FILE* fid);
 
+	//! caches the generated connectivity in directory dirName, keyed by a hash of the network topology
+	void setConnectionCache(const std::string& dirName);
+
 	// multiplies every weight with a scaling factor
 	void scaleWeights(short int connId, float scale, bool updateWeightRange = false);
 
@@ -455,8 +467,9 @@ public:
 	 * \param grpId ID of the neuron group
 	 * \param spikeRate pointer to a PoissonRate instance
 	 * \param refPeriod (optional) refractive period,  default = 1
+	 * \param eventDriven (optional) draw inter-spike intervals instead of testing every neuron every ms (CPU only)
 	 */
-	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod);
+	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod, bool eventDriven = false);
 
 	//! sets the weight value of a specific synapse
 	void setWeight(short int connId, int neurIdPre, int neurIdPost, float weight, bool updateWeightRange = false);
@@ -503,6 +516,18 @@ public:
 	 */
 	void saveSimulation(FILE* fid, bool saveSynapseInfo = false);
 
+	//! writes the complete runtime state of the simulation (neurons, synapses, in-flight spikes, time, RNG) to file
+	void saveCheckpoint(FILE* fid);
+
+	//! restores a runtime state written by SNN::saveCheckpoint, so that the simulation continues from there
+	void loadCheckpoint(FILE* fid);
+
+	//! writes the plastic weights that changed by more than epsilon since the last full checkpoint
+	void saveCheckpointDelta(FILE* fid, float epsilon = 0.0f);
+
+	//! applies a delta checkpoint on top of its base, which must have been loaded with SNN::loadCheckpoint
+	void loadCheckpointDelta(FILE* fid);
+
 	//! function writes population weights from gIDpre to gIDpost to file fname in binary.
 	//void writePopWeights(std::string fname, int gIDpre, int gIDpost);
 
@@ -554,6 +579,7 @@ public:
 
 	// get functions for GroupInfo
 	int getGroupStartNeuronId(int gGrpId) { return groupConfigMDMap[gGrpId].gStartN; }
+	int getGroupNetId(int gGrpId) { return groupConfigMDMap[gGrpId].netId; }
 	int getGroupEndNeuronId(int gGrpId) { return groupConfigMDMap[gGrpId].gEndN; }
 	int getGroupNumNeurons(int gGrpId) { return groupConfigMap[gGrpId].numN; }
 
@@ -561,6 +587,7 @@ public:
 
 	Point3D getNeuronLocation3D(int neurId);
 	Point3D getNeuronLocation3D(int grpId, int relNeurId);
+	Point3D getGridLocation3D(const Grid3D& grid, int relNeurId);
 
 	int getNumConnections() { return numConnections; }
 	int getNumSynapticConnections(short int connectionId);		//!< gets number of connections associated with a connection ID
@@ -574,6 +601,7 @@ public:
 	int getNumNeuronsGenExc() { return glbNetworkConfig.numNExcPois; }
 	int getNumNeuronsGenInh() { return glbNetworkConfig.numNInhPois; }
 	int getNumSynapses() { return glbNetworkConfig.numSynNet; }
+	std::string getConnectionCacheFile() { return connCacheFile_; }
 
 	int getRandSeed() { return randSeed_; }
 
@@ -600,6 +628,11 @@ public:
 
 	std::vector< std::vector<float> > getWeightMatrix2D(short int connId);
 
+	//! copies the weights of all synapses in a connection into a flat array, one entry per existing synapse
+	//! (ordered by post-synaptic neuron); optionally also returns the group-relative pre/post neuron IDs
+	void getWeightsSparse(short int connId, std::vector<float>& wts, std::vector<int>* nIdsPre = NULL,
+		std::vector<int>* nIdsPost = NULL);
+
 	std::vector<float> getConductanceAMPA(int grpId);
 	std::vector<float> getConductanceNMDA(int grpId);
 	std::vector<float> getConductanceGABAa(int grpId);
@@ -629,6 +662,10 @@ public:
 	double getRFDist3D(const RadiusRF& radius, const Point3D& pre, const Point3D& post);
 	bool isPoint3DinRF(const RadiusRF& radius, const Point3D& pre, const Point3D& post);
 
+	//! finds all neurons of a group whose RF contains point pre, using index arithmetic on the group's Grid3D
+	void findNeuronsInRF(const Grid3D& grid, const RadiusRF& radius, const Point3D& pre, std::vector<int>& relNeurIds);
+	void getGridIndexRangeInRF(int num, float dist, float offset, double loc, double rad, int& lo, int& hi);
+
 	bool isSimulationWithCompartments() { return sim_with_compartments; }
 	bool isSimulationWithCOBA() { return sim_with_conductances; }
 	bool isSimulationWithCUBA() { return !sim_with_conductances; }
@@ -681,13 +718,26 @@ private:
 	 * \brief generate connections among groups according to connect configuration
 	 */
 	void connectNetwork();
-	inline void connectNeurons(int netId, int srcGrp, int destGrp, int srcN, int destN, short int connId, int externalNetId);
+	void generateConnectionBlocks(); //!< generates the synapses of all connection blocks, in parallel where possible
+	void generateConnectionBlockRange(int chunkId, int numChunks);
+	static void* helperGenerateConnectionBlocks(void*);
+	void addConnectionBlock(int netId, ConnectionBlock& block, int externalNetId);
+	void updateGroupSynapseCounts(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	uint64_t getTopologyHash(); //!< hash of everything that determines the synapses generated by connectNetwork()
+	std::string getConnectionCacheFileName();
+	void saveConnectionCache(const std::string& fileName);
+	bool loadConnectionCache(const std::string& fileName);
+	bool parseConnectionCache(const char* cursor, const char* end);
+	inline void connectNeurons(int netId, int srcGrp, int destGrp, int srcN, int destN, short int connId, uint8_t delay, int externalNetId);
 	inline void connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId);
-	void connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectOneToOne(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	inline void addBlockSynapse(ConnectionBlock& block, CounterRNG& rng, int gPreN, int gPostN);
+	void connectFull(ConnectionBlock& block, CounterRNG& rng);
+	void connectOneToOne(ConnectionBlock& block, CounterRNG& rng);
+	void connectRandom(ConnectionBlock& block, CounterRNG& rng);
+	void connectGaussian(ConnectionBlock& block, CounterRNG& rng);
 	void connectUserDefined(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	long long nextRandomCandidate(long long lastCandidate, double connProb, CounterRNG& rng); //!< geometric skip-sampling of candidates
+	bool isRFUnrestricted(const RadiusRF& radius); //!< whether every pre-neuron lies in the RF of every post-neuron
 
 	void deleteObjects();			//!< deallocates all used data structures in snn_cpu.cpp
 
@@ -700,8 +750,7 @@ private:
 		int& _numNPois, int& _numNExcPois, int& _numNInhPois);
 	void findNumNSpikeGenAndOffset(int _netId);
 
-	void generatePostSynapticSpike(int preNId, int postNId, int synId, int tD, int netId);
-	void fillSpikeGenBits(int netId);
+	void fillSpikeGenBits(int netId, unsigned int* spikeGenBits);
 	void userDefinedSpikeGenerator(int gGrpId);
 
 	float generateWeight(int connProp, float initWt, float maxWt, int nid, int grpId);
@@ -725,6 +774,12 @@ private:
 
 	void partitionSNN();
 
+	//! assigns the groups without a preferred partition to the CPU partitions in HYBRID_MODE (gGrpId -> netId)
+	void partitionHybridSNN(std::map<int, int>& hybridNetIds);
+
+	//! estimates the number of synapses of a connection before it is made
+	double estimateNumSynapses(const ConnectConfig& connConfig);
+
 	void generateRuntimeSNN();
 
 	/*!
@@ -758,6 +813,11 @@ private:
 	void printSikeRoutingInfo();
 
 	int loadSimulation_internal(bool onlyPlastic);
+	void loadSimulationSynapses_internal(); //!< reads the bulk synapse sections of a file of version 0.4 or later
+	void collectCheckpointCounters(int netId, std::vector<std::pair<void*, size_t> >& arrays); //!< spike counters of a checkpoint
+	void collectCheckpointArrays(int netId, std::vector<std::pair<void*, size_t> >& arrays); //!< state arrays of a checkpoint
+	void setCheckpointBase(uint64_t checkpointId); //!< takes the snapshot of the plastic weights that deltas refer to
+	void findPlasticSynapses(int netId, std::vector<unsigned int>& synIds); //!< ids of the synapses that can change
 
 	void resetConductances(int netId);
 	void resetCurrent(int netId);
@@ -774,6 +834,7 @@ private:
 	void resetTimeTable();
 	void resetFiringTable();
 	void routeSpikes();
+	void generateSpikeRoutes();
 	void transferSpikes(void* dest, int destNetId, void* src, int srcNetId, int size);
 	void resetTiming();
 
@@ -960,8 +1021,10 @@ private:
 	//allocates runtime data on CPU memory
 	void allocateSNN_CPU(int netId); 
 
+	//! copies the external spikes of a CPU runtime to another CPU runtime and converts them to local ids in one pass
+	void routeSpikes_CPU(int srcNetId, const SpikeRoute& route);
+
 	// runNetwork functions - multithreaded in LINUX using pthreads
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void assignPoissonFiringRate_CPU(int netId);
 	void clearExtFiringTable_CPU(int netId);
 	void convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
@@ -977,28 +1040,12 @@ private:
 	void spikeGeneratorUpdate_CPU(int netId);
 	void updateTimingTable_CPU(int netId);
 	void updateWeights_CPU(int netId);
-#else // for APPLE and Win systems - returns a void* to pthread_create - only differ in the return type compared to the counterparts above
-	void* assignPoissonFiringRate_CPU(int netId);
-	void* clearExtFiringTable_CPU(int netId);
-	void* convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void* convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void* doCurrentUpdateD2_CPU(int netId);
-	void* doCurrentUpdateD1_CPU(int netId);
-	void* doSTPUpdateAndDecayCond_CPU(int netId);
-	void* deleteRuntimeData_CPU(int netId);
-	void* findFiring_CPU(int netId);
-	void* globalStateUpdate_CPU(int netId);
-	void* resetSpikeCnt_CPU(int netId, int lGrpId); //!< Resets the spike count for a particular group.
-	void* shiftSpikeTables_CPU(int netId);
-	void* spikeGeneratorUpdate_CPU(int netId);
-	void* updateTimingTable_CPU(int netId);
-	void* updateWeights_CPU(int netId);
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // POSIX
 
 	// static multithreading helper methods for the above CPU runNetwork() methods
 	static void* helperAssignPoissonFiringRate_CPU(void*);
 	static void* helperClearExtFiringTable_CPU(void*);
-	static void* helperConvertExtSpikesD2_CPU(void*);
-	static void* helperConvertExtSpikesD1_CPU(void*);
 	static void* helperDoCurrentUpdateD2_CPU(void*);
 	static void* helperDoCurrentUpdateD1_CPU(void*);
 	static void* helperDoSTPUpdateAndDecayCond_CPU(void*);
@@ -1010,6 +1057,18 @@ private:
 	static void* helperSpikeGeneratorUpdate_CPU(void*);
 	static void* helperUpdateTimingTable_CPU(void*);
 	static void* helperUpdateWeights_CPU(void*);
+
+	// persistent worker pool that runs the above helpers, one or more pinned workers per CPU runtime
+	void startCPUWorkerPool();
+	void stopCPUWorkerPool();
+	void runCPUWorkerPool(void* (*helper)(void*), int lGrpId = 0, bool chunked = false);
+	static void* helperCPUWorker(void*);
+
+	// chunked counterparts run by every worker of a CPU runtime, each one owning a contiguous neuron range
+	void globalStateUpdateChunk_CPU(int netId, int chunkId, int numChunks, int startN, int endN);
+	static void* helperGlobalStateUpdateChunk_CPU(void*);
+	static void* helperDoCurrentUpdateD2Chunk_CPU(void*);
+	static void* helperDoCurrentUpdateD1Chunk_CPU(void*);
 #endif
 
 	// CPU computing backend: data transfer function
@@ -1041,15 +1100,40 @@ private:
 	void copyExtFiringTable(int netId);
 	
 	// CPU backend: utility function
+	void deliverSpikesD2_CPU(int netId, int startPostN, int endPostN);
+	void deliverSpikesD1_CPU(int netId, int startPostN, int endPostN);
+	template<int target, bool withSTP, bool withRise>
+	void deliverPreSynapticSpike_CPU(int netId, int preNId, int tD, int synStart, int synEnd, int startPostN, int endPostN);
+	void assignDeliveryKernels_CPU(int netId);
+	void updateLTD(int postNId, short int post_grpId, unsigned int pos, unsigned int pre_type, int netId);
+	void updateNeuronStates_CPU(int netId, int startN, int endN, bool lastIter);
+	int updateNeuronStates_SIMD(int netId, int lGrpId, int startN, int endN, bool lastIter);
+	int detectSIMDWidth_CPU();
+	void updateGroupStates_CPU(int netId);
 	void firingUpdateSTP(int lNId, int lGrpId, int netId);
 	void updateLTP(int lNId, int lGrpId, int netId);
 	void resetFiredNeuron(int lNId, short int lGrpId, int netId);
 	bool getPoissonSpike(int lNId, int netId);
+	void schedulePoissonSpike_CPU(int lNId, int lGrpId, int netId, int tBase);
 	bool getSpikeGenBit(unsigned int nIdPos, int netId);
+	void recordSpike_CPU(int lNId, int lGrpId, int netId);
+
+	//! receptors targeted by a pre-synaptic group, selects the specialization of deliverPreSynapticSpike_CPU()
+	enum DeliveryTarget_CPU {
+		CUBA_DELIVERY,     //!< current-based synapses
+		COBA_EXC_DELIVERY, //!< conductance-based synapses, AMPA and NMDA
+		COBA_INH_DELIVERY, //!< conductance-based synapses, GABAa and GABAb
+		COBA_ANY_DELIVERY  //!< conductance-based synapses, any other combination of receptors
+	};
+
+	//! pointer to a specialization of deliverPreSynapticSpike_CPU()
+	typedef void (SNN::*DeliveryKernel_CPU)(int netId, int preNId, int tD, int synStart, int synEnd, int startPostN, int endPostN);
 
 	// +++++ PRIVATE PROPERTIES +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 	SNNState snnState; //!< state of the network
 	FILE* loadSimFID;
+	std::string connCacheDir_; //!< directory of the connection cache, empty if connectivity is not cached
+	std::string connCacheFile_; //!< cache file of the current topology, set in setupNetwork()
 
 	const std::string networkName_;	//!< network name
 	const LoggerMode loggerMode_;	//!< current logger mode (USER, DEVELOPER, SILENT, CUSTOM)
@@ -1059,10 +1143,32 @@ private:
 	int numGPUs;    //!< number of GPU(s) is used in the simulation
 	int numCores;   //!< number of CPU Core(s) is used in the simulation
 
+	DeliveryKernel_CPU deliveryKernels_CPU[MAX_NET_PER_SNN][MAX_GRP_PER_SNN]; //!< spike delivery kernel of every pre-synaptic group of a CPU runtime
+	int simdWidth_CPU; //!< number of neurons integrated per vector instruction by the CPU runtimes (1: scalar path only)
+	int numCPUThreadsUser; //!< number of workers per CPU runtime set by setNumCPUThreads (0: automatic)
+	int numCPUCoresUser; //!< number of cores available to the CPU runtimes set by setNumCPUCores (0: all online cores)
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	// persistent CPU worker pool, created in setupNetwork() and reused by every simulation step
+	std::vector<pthread_t> cpuWorkerThreads;         //!< one or more workers per CPU runtime
+	std::vector<ThreadStruct> cpuWorkerArgs;         //!< arguments handed to the helper of each worker
+	pthread_barrier_t cpuWorkerBarrierStart;         //!< releases the workers into the posted job
+	pthread_barrier_t cpuWorkerBarrierDone;          //!< signals the manager that all workers finished the job
+	pthread_barrier_t cpuRuntimeBarrier[MAX_NET_PER_SNN]; //!< synchronizes the workers of one CPU runtime within a chunked job
+	pthread_mutex_t cpuDAMutex;                      //!< serializes dopamine releases into groups shared by several workers
+	int numCPUThreadsPerRuntime[MAX_NET_PER_SNN];    //!< number of workers (chunks) of each CPU runtime
+	void* (*cpuWorkerJob)(void*);                    //!< helper to run in the current phase, NULL tells the workers to exit
+	bool cpuWorkerJobChunked;                        //!< whether all workers of a runtime run the job, or only chunk 0
+	int numCPUWorkers;                               //!< number of running workers
+	bool cpuWorkerPoolRunning;                       //!< whether the pool has been started
+#endif
+
 	int numAvailableGPUs; //!< number of available GPU(s) in the machine
 
 	bool simulatorDeleted;
 	bool spikeRateUpdated;
+	PoissonTimingWheel poissonWheels_[MAX_NET_PER_SNN]; //!< next spike times of event-driven Poisson neurons per CPU runtime
+	std::vector<int> poissonDue_[MAX_NET_PER_SNN];       //!< scratch list of event-driven Poisson neurons due in a step
 
 	//! switch to make all weights fixed (such as in testing phase) or not
 	bool sim_in_testing;
@@ -1082,15 +1188,18 @@ private:
 	std::list<ConnectConfig> externalConnectLists[MAX_NET_PER_SNN];
 	std::list<compConnectConfig> localCompConnectLists[MAX_NET_PER_SNN];
 
-	std::list<ConnectionInfo> connectionLists[MAX_NET_PER_SNN];
+	SynapseStagingBuffer connectionLists[MAX_NET_PER_SNN]; //!< synapses generated by connect*, per local network
+	std::vector<ConnectionBlock> connectionBlocks; //!< blocks of pre-neurons of the connections, only used by connectNetwork()
 
 	std::list<RoutingTableEntry> spikeRoutingTable;
+	std::vector<SpikeRoute> spikeRoutes[MAX_NET_PER_SNN]; //!< spike routes of every source network, see generateSpikeRoutes()
 
 	float 		*mulSynFast;	//!< scaling factor for fast synaptic currents, per connection
 	float 		*mulSynSlow;	//!< scaling factor for slow synaptic currents, per connection
 
 	//! Buffer to store spikes
 	SpikeBuffer* spikeBuf;
+	SpikeSink spikeGenSink; //!< re-used by SpikeGenerator::generateSpikes to hand over the spikes of a time slice
 
 	bool sim_with_conductances; //!< flag to inform whether we run in COBA mode (true) or CUBA mode (false)
 	bool sim_with_NMDA_rise;    //!< a flag to inform whether to compute NMDA rise time
@@ -1140,6 +1249,9 @@ private:
 	int numSpikeMonitor;
 	SpikeMonitorCore*  spikeMonCoreList[MAX_GRP_PER_SNN];
 	SpikeMonitor*      spikeMonList[MAX_GRP_PER_SNN];
+	int      spikeTablesFetchedNetId_; //!< local network whose spike tables are in managerRuntimeData (-1: none)
+	long int spikeTablesFetchedTime_;  //!< simulation time at which they were fetched
+	long int spikeCntFetchedTime_[MAX_GRP_PER_SNN]; //!< simulation time at which a group's nSpikeCnt was fetched (-1: stale)
 
 	// neuron monitor variables
 	int numNeuronMonitor;
@@ -1196,6 +1308,12 @@ private:
 	int wtANDwtChangeUpdateIntervalCnt_;
 	float stdpScaleFactor_;
 	float wtChangeDecay_; //!< the wtChange decay
+
+	// delta checkpoints
+	uint64_t checkpointBaseId_; //!< id of the last full checkpoint saved or loaded (0: none)
+	int checkpointDeltaSeq_;    //!< number of the last delta checkpoint saved or loaded since then
+	std::vector<float> checkpointBaseWt_[MAX_NET_PER_SNN];       //!< weights at the time of the base checkpoint
+	std::vector<float> checkpointBaseWtChange_[MAX_NET_PER_SNN]; //!< weight changes at the time of the base checkpoint
 };
 
 #endif
@@ -73,6 +73,23 @@ enum MemType {
 //! connection types, used internally (externally it's a string)
 enum conType_t { CONN_RANDOM, CONN_ONE_TO_ONE, CONN_FULL, CONN_FULL_NO_DIRECT, CONN_GAUSSIAN, CONN_USER_DEFINED, CONN_UNKNOWN};
 
+//! sections of the synapse part of a file written by SNN::saveSimulation (version 0.4 and later)
+/*!
+*	Every section is a bulk array with one element per synapse. The file lists the sections in a table of
+*	{section id, element size, offset, number of elements}, so that readers can skip sections they do not know.
+*/
+enum SimFileSection {
+	SIM_SECTION_GRP_ID_PRE,   //!< int, global id of the pre-synaptic group
+	SIM_SECTION_GRP_ID_POST,  //!< int, global id of the post-synaptic group
+	SIM_SECTION_NEUR_ID_PRE,  //!< int, id of the pre-synaptic neuron within its group
+	SIM_SECTION_NEUR_ID_POST, //!< int, id of the post-synaptic neuron within its group
+	SIM_SECTION_CONN_ID,      //!< int, connection id
+	SIM_SECTION_WEIGHT,       //!< float, current weight
+	SIM_SECTION_MAX_WEIGHT,   //!< float, maximum weight
+	SIM_SECTION_DELAY,        //!< uint8_t, delay in ms
+	NUM_SIM_SECTIONS
+};
+
 //! the state of spiking neural network, used with in kernel.
 enum SNNState {
 	CONFIG_SNN,
@@ -91,22 +108,288 @@ typedef struct SynInfo_s {
 	int nId; //!< neuron id
 } SynInfo;
 
-typedef struct ConnectionInfo_s {
-	int grpSrc;
-	int grpDest;
-	int nSrc;
-	int nDest;
-	int srcGLoffset;
-	float initWt;
-	float maxWt;
-	int preSynId;
-	short int connId;
-	uint8_t delay;
-
-	bool operator== (const struct ConnectionInfo_s& conn) {
-		return (nSrc + srcGLoffset == conn.nSrc);
+//! counter-based random number generator
+/*!
+*	The n-th number of a stream is a hash of n and the key of the stream, which is derived from the random seed and
+*	two stream ids. Numbers therefore depend neither on other streams nor on the order in which streams are used,
+*	which makes work that is split among threads reproducible for any number of threads.
+*/
+class CounterRNG {
+public:
+	CounterRNG(uint64_t seed, uint64_t streamId, uint64_t subStreamId) : counter_(0) {
+		key_ = mix(mix(mix(seed) ^ streamId) ^ subStreamId);
+	}
+
+	//! returns the next 64 random bits of the stream
+	uint64_t next() {
+		counter_++;
+		return mix(key_ ^ mix(counter_));
+	}
+
+	//! returns a double in [0,1)
+	double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+	//! returns an integer in [0,n)
+	int uniformInt(int n) { return (int)(next() % (uint64_t)n); }
+
+	//! returns the n-th 64 random bits of the stream (n >= 1), without advancing the stream
+	uint64_t at(uint64_t n) const { return mix(key_ ^ mix(n)); }
+
+	//! returns the n-th number of the stream as a float in [0,1), without advancing the stream
+	float uniformFloatAt(uint64_t n) const { return (at(n) >> 40) * (1.0f / 16777216.0f); }
+
+private:
+	//! bijective 64-bit finalizer of SplitMix64
+	static uint64_t mix(uint64_t x) {
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	uint64_t key_;
+	uint64_t counter_;
+};
+
+//! timing wheel of the next spike times of event-driven Poisson neurons (one per CPU runtime)
+/*!
+*	Every scheduled spike is kept in the slot of its millisecond (modulo the number of slots), so that a simulation
+*	step only touches the neurons that are due. Spikes that lie more than one revolution ahead stay in their slot
+*	until their time has come. The wheel also records which local groups are event-driven and their refractory period.
+*/
+class PoissonTimingWheel {
+public:
+	PoissonTimingWheel() : numEvents_(0) {}
+
+	//! removes all scheduled spikes and (re)sizes the wheel for numGroups local groups, all of them not event-driven
+	void reset(int numGroups) {
+		if (slots_.size() != NUM_SLOTS)
+			slots_.resize(NUM_SLOTS);
+		clearEvents();
+		eventDriven_.assign(numGroups, false);
+		refPeriod_.assign(numGroups, 1);
+	}
+
+	//! removes all scheduled spikes
+	void clearEvents() {
+		for (unsigned int i = 0; i < slots_.size(); i++)
+			slots_[i].clear();
+		numEvents_ = 0;
+	}
+
+	//! removes the scheduled spikes of the neurons [lStartN, lEndN]
+	void clearEvents(int lStartN, int lEndN) {
+		for (unsigned int s = 0; s < slots_.size(); s++) {
+			std::vector<Event>& slot = slots_[s];
+			unsigned int keep = 0;
+			for (unsigned int i = 0; i < slot.size(); i++) {
+				if (slot[i].lNId < lStartN || slot[i].lNId > lEndN)
+					slot[keep++] = slot[i];
+			}
+			numEvents_ -= slot.size() - keep;
+			slot.resize(keep);
+		}
+	}
+
+	//! appends all scheduled spikes to events as pairs of neuron id and spike time, in an order that schedule() restores
+	void getEvents(std::vector<int>& events) const {
+		for (unsigned int s = 0; s < slots_.size(); s++) {
+			for (unsigned int i = 0; i < slots_[s].size(); i++) {
+				events.push_back(slots_[s][i].lNId);
+				events.push_back(slots_[s][i].time);
+			}
+		}
+	}
+
+	void setGroup(int lGrpId, bool eventDriven, int refPeriod) {
+		eventDriven_[lGrpId] = eventDriven;
+		refPeriod_[lGrpId] = refPeriod;
+	}
+
+	bool isEventDriven(int lGrpId) const { return lGrpId < (int)eventDriven_.size() && eventDriven_[lGrpId]; }
+	int getRefPeriod(int lGrpId) const { return refPeriod_[lGrpId]; }
+	bool hasEvents() const { return numEvents_ > 0; }
+
+	//! schedules a spike of neuron lNId at time t
+	void schedule(int lNId, int t) {
+		Event e = { lNId, t };
+		slots_[t & (NUM_SLOTS - 1)].push_back(e);
+		numEvents_++;
+	}
+
+	//! appends the neurons due at time t to due, and removes them from the wheel
+	void popDue(int t, std::vector<int>& due) {
+		std::vector<Event>& slot = slots_[t & (NUM_SLOTS - 1)];
+		unsigned int keep = 0;
+		for (unsigned int i = 0; i < slot.size(); i++) {
+			if (slot[i].time == t)
+				due.push_back(slot[i].lNId);
+			else
+				slot[keep++] = slot[i];
+		}
+		numEvents_ -= slot.size() - keep;
+		slot.resize(keep);
+	}
+
+private:
+	static const unsigned int NUM_SLOTS = 1024; //!< must be a power of 2
+
+	struct Event {
+		int lNId;
+		int time;
+	};
+
+	std::vector< std::vector<Event> > slots_;
+	std::vector<bool> eventDriven_;
+	std::vector<int> refPeriod_;
+	size_t numEvents_;
+};
+
+//! staging store of the synapses generated by SNN::connect*, consumed by SNN::generateConnectionRuntime()
+/*!
+*	Synapses are stored as struct of arrays in fixed-size chunks, using narrow types: global pre- and post-synaptic
+*	neuron ids (32 bit), connection id (16 bit) and delay (8 bit). The source and destination groups of a synapse
+*	are properties of its connection and are stored once per connection. So are the weights, as long as all synapses
+*	of a connection have the same weights (connect with RangeWeight); per-synapse weights (user-defined connections,
+*	loadSimulation) are only allocated for the chunks that hold such synapses.
+*	The synapses keep the order in which they were added.
+*/
+class SynapseStagingBuffer {
+public:
+	SynapseStagingBuffer() : numSynapses_(0) {}
+
+	//! registers the groups and, if uniform is true, the weights shared by all synapses of a connection
+	void setConnection(short int connId, int grpSrc, int grpDest, bool uniform, float initWt, float maxWt) {
+		if (connId >= (int)conns_.size())
+			conns_.resize(connId + 1);
+		ConnInfo& conn = conns_[connId];
+		conn.grpSrc = grpSrc;
+		conn.grpDest = grpDest;
+		conn.uniform = uniform;
+		conn.initWt = initWt;
+		conn.maxWt = maxWt;
+	}
+
+	//! returns true if the connection has been registered with setConnection()
+	bool hasConnection(short int connId) const { return connId < (int)conns_.size() && conns_[connId].grpSrc >= 0; }
+
+	//! returns one past the largest connection id that may have been registered
+	int getConnectionIdBound() const { return conns_.size(); }
+
+	//! returns the groups and shared weights of a registered connection
+	void getConnection(short int connId, int& grpSrc, int& grpDest, bool& uniform, float& initWt, float& maxWt) const {
+		assert(hasConnection(connId));
+		const ConnInfo& conn = conns_[connId];
+		grpSrc = conn.grpSrc;
+		grpDest = conn.grpDest;
+		uniform = conn.uniform;
+		initWt = conn.initWt;
+		maxWt = conn.maxWt;
+	}
+
+	//! appends a synapse of a connection with uniform weights
+	void push(int nSrc, int nDest, short int connId, uint8_t delay) {
+		assert(hasConnection(connId) && conns_[connId].uniform);
+		Chunk& chunk = nextSlot();
+		chunk.nSrc.push_back(nSrc);
+		chunk.nDest.push_back(nDest);
+		chunk.connId.push_back(connId);
+		chunk.delay.push_back(delay);
+		numSynapses_++;
+	}
+
+	//! appends a synapse with its own weights
+	void push(int nSrc, int nDest, short int connId, uint8_t delay, float initWt, float maxWt) {
+		assert(hasConnection(connId) && !conns_[connId].uniform);
+		Chunk& chunk = nextSlot();
+		if (chunk.initWt.empty()) {
+			chunk.initWt.resize(CHUNK_SIZE, 0.0f);
+			chunk.maxWt.resize(CHUNK_SIZE, 0.0f);
+		}
+		chunk.initWt[chunk.nSrc.size()] = initWt;
+		chunk.maxWt[chunk.nSrc.size()] = maxWt;
+		chunk.nSrc.push_back(nSrc);
+		chunk.nDest.push_back(nDest);
+		chunk.connId.push_back(connId);
+		chunk.delay.push_back(delay);
+		numSynapses_++;
+	}
+
+	int size() const { return numSynapses_; }
+	bool empty() const { return numSynapses_ == 0; }
+
+	int nSrc(int i) const { return chunks_[i >> CHUNK_BITS]->nSrc[i & CHUNK_MASK]; }
+	int nDest(int i) const { return chunks_[i >> CHUNK_BITS]->nDest[i & CHUNK_MASK]; }
+	short int connId(int i) const { return chunks_[i >> CHUNK_BITS]->connId[i & CHUNK_MASK]; }
+	uint8_t delay(int i) const { return chunks_[i >> CHUNK_BITS]->delay[i & CHUNK_MASK]; }
+	int grpSrc(int i) const { return conns_[connId(i)].grpSrc; }
+	int grpDest(int i) const { return conns_[connId(i)].grpDest; }
+
+	float initWt(int i) const {
+		const ConnInfo& conn = conns_[connId(i)];
+		return conn.uniform ? conn.initWt : chunks_[i >> CHUNK_BITS]->initWt[i & CHUNK_MASK];
 	}
-} ConnectionInfo;
+
+	float maxWt(int i) const {
+		const ConnInfo& conn = conns_[connId(i)];
+		return conn.uniform ? conn.maxWt : chunks_[i >> CHUNK_BITS]->maxWt[i & CHUNK_MASK];
+	}
+
+	//! releases all synapses and connections
+	void clear() {
+		for (size_t c = 0; c < chunks_.size(); c++)
+			delete chunks_[c];
+		chunks_.clear();
+		conns_.clear();
+		numSynapses_ = 0;
+	}
+
+	~SynapseStagingBuffer() { clear(); }
+
+private:
+	enum { CHUNK_BITS = 16, CHUNK_SIZE = 1 << CHUNK_BITS, CHUNK_MASK = CHUNK_SIZE - 1 };
+
+	struct Chunk {
+		Chunk() {
+			nSrc.reserve(CHUNK_SIZE);
+			nDest.reserve(CHUNK_SIZE);
+			connId.reserve(CHUNK_SIZE);
+			delay.reserve(CHUNK_SIZE);
+		}
+
+		std::vector<int> nSrc;
+		std::vector<int> nDest;
+		std::vector<short int> connId;
+		std::vector<uint8_t> delay;
+		std::vector<float> initWt; //!< empty unless the chunk holds synapses with their own weights
+		std::vector<float> maxWt;
+	};
+
+	struct ConnInfo {
+		ConnInfo() : grpSrc(-1), grpDest(-1), uniform(true), initWt(0.0f), maxWt(0.0f) {}
+
+		int grpSrc;
+		int grpDest;
+		bool uniform;
+		float initWt;
+		float maxWt;
+	};
+
+	//! returns the chunk that receives the next synapse
+	Chunk& nextSlot() {
+		if ((numSynapses_ & CHUNK_MASK) == 0)
+			chunks_.push_back(new Chunk());
+		return *chunks_.back();
+	}
+
+	// chunks are owned by the buffer, copying would double-free them
+	SynapseStagingBuffer(const SynapseStagingBuffer&);
+	SynapseStagingBuffer& operator=(const SynapseStagingBuffer&);
+
+	std::vector<Chunk*> chunks_;
+	std::vector<ConnInfo> conns_; //!< indexed by connection id
+	int numSynapses_;
+};
 
 /*!
  * \brief The configuration of a connection
@@ -136,6 +419,28 @@ typedef struct ConnectConfig_s {
 	int                      numberOfConnections; // ToDo: move to ConnectConfigMD
 } ConnectConfig;
 
+//! the synapses of a block of pre-synaptic neurons of a connection, generated by SNN::connectNetwork()
+/*!
+*	Every block draws its random numbers from its own CounterRNG stream keyed by (random seed, connection id, block id),
+*	so blocks can be generated in parallel and still give the same network for any number of threads.
+*/
+typedef struct ConnectionBlock_s {
+	ConnectConfig* connConfig;
+	int blockId;
+	int gPreStart; //!< first pre-synaptic neuron of the block
+	int gPreEnd;   //!< last pre-synaptic neuron of the block
+	// copies of the group configs, so that the builder threads never touch the (non-thread-safe) group maps
+	int gPreGrpStart;  //!< first neuron of the pre-synaptic group
+	int gPostGrpStart; //!< first neuron of the post-synaptic group
+	int gPostGrpEnd;   //!< last neuron of the post-synaptic group
+	Grid3D gridPre;    //!< Grid3D of the pre-synaptic group
+	Grid3D gridPost;   //!< Grid3D of the post-synaptic group
+	std::vector<int> nSrc;
+	std::vector<int> nDest;
+	std::vector<uint8_t> delay;
+	std::vector<float> initWt; //!< only used by connections whose synapses have their own weights (gaussian)
+} ConnectionBlock;
+
 /*!
  * \brief the intermediate data of connect config
  *
@@ -330,7 +635,8 @@ typedef struct GroupConfigMD_s {
 						lGrpId(-1), lStartN(-1), lEndN(-1),
 					    netId(-1), maxOutgoingDelay(1), fixedInputWts(true), hasExternalConnect(false),
 						LtoGOffset(0), GtoLOffset(0), numPostSynapses(0), numPreSynapses(0), Noffset(0),
-						spikeMonitorId(-1), neuronMonitorId(-1), groupMonitorId(-1), currTimeSlice(1000), sliceUpdateTime(0), homeoId(-1), ratePtr(NULL)
+						spikeMonitorId(-1), neuronMonitorId(-1), groupMonitorId(-1), currTimeSlice(1000), sliceUpdateTime(0), homeoId(-1), ratePtr(NULL),
+						isPoissonEventDriven(false), isPoissonRateUpdated(false)
 	{}
 
 	int gGrpId;
@@ -356,6 +662,8 @@ typedef struct GroupConfigMD_s {
 	int homeoId;
 	int Noffset; //!< the offset of spike generator (poisson) neurons [0, numNPois)
 	PoissonRate* ratePtr;
+	bool isPoissonEventDriven; //!< whether Poisson spikes are drawn as inter-spike intervals (CPU only) \sa PoissonTimingWheel
+	bool isPoissonRateUpdated; //!< whether setSpikeRate was called since the rates were last assigned to the runtime
 
 	bool operator== (const struct GroupConfigMD_s& grp) {
 		return (gGrpId == grp.gGrpId);
@@ -711,13 +1019,27 @@ typedef struct RoutingTableEntry_s {
 	}
 } RoutingTableEntry;
 
+//! spike route from a local network to another local network, precomputed from spikeRoutingTable
+/*!
+*	Lists the groups of the source network whose spikes are sent to the destination network, together with
+*	the offset that converts their global neuron ids to local neuron ids of the destination network.
+*	\sa SNN::generateSpikeRoutes() SNN::routeSpikes()
+*/
+typedef struct SpikeRoute_s {
+	explicit SpikeRoute_s(int destNetId_) : destNetId(destNetId_) {}
+
+	int destNetId;
+	std::vector<int> lGrpIds;     //!< local group ids in the source network
+	std::vector<int> GtoLOffsets; //!< GtoLOffset of the same groups in the destination network
+} SpikeRoute;
+
 
 //! CPU multithreading subroutine (that takes single argument) struct argument
 /*!
 *	This sturcture contains the snn object (because the 
 *	multithreading routing is a static method and does not recognize this object), 
 *	netID runtime used by the CPU runtime methods, local group ID, startIdx, 
-*	endIdx, GtoLOffset
+*	endIdx, GtoLOffset, and the chunk of the runtime a pooled worker owns
 */
 typedef struct ThreadStruct_s {
 	void* snn_pointer;
@@ -726,6 +1048,8 @@ typedef struct ThreadStruct_s {
 	int startIdx;
 	int endIdx;
 	int GtoLOffset;
+	int chunkId;   //!< index of the worker within its CPU runtime, chunk 0 runs the non-chunked phases
+	int numChunks; //!< number of workers sharing the CPU runtime
 } ThreadStruct;
 
 #endif
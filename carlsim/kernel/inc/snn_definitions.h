@@ -126,6 +126,12 @@
 #define MAX_NUM_PRE_SYN 200000
 #define MAX_SYN_DELAY 20
 
+#define SIM_FILE_SIGNATURE 294338571 // identifies files written by SNN::saveSimulation
+#define SIM_FILE_VERSION 0.4f        // 0.4: synapses are stored as aligned bulk arrays, see SimFileSection
+#define CHECKPOINT_FILE_SIGNATURE 294338572 // identifies files written by SNN::saveCheckpoint
+#define CHECKPOINT_DELTA_FILE_SIGNATURE 294338573 // identifies files written by SNN::saveCheckpointDelta
+#define CHECKPOINT_FILE_VERSION 0.3f        // 0.3: checkpoints store the schedule of event-driven Poisson groups
+
 // increasing the following numbers will increase the load on constant memory
 // until a hard limit is reached, which is given by the datatype of the variable
 #define MAX_CONN_PER_SNN 256	// hard limit: 2^16
@@ -139,6 +145,8 @@
 #endif
 
 #define NUM_CPU_CORES sysconf(_SC_NPROCESSORS_ONLN)
+#define MIN_NEURONS_PER_CPU_THREAD 2048 // smaller chunks of a CPU runtime are not worth the synchronization
+#define CONN_BLOCK_SIZE 256 // number of pre-neurons per independently generated block of a connection
 
 #define GPU_RUNTIME_BASE 0
 
@@ -51,14 +51,18 @@
 
 
 #include <stdlib.h> // size_t
+#include <vector>
 
 
 /*!
  * \brief Circular buffer for delivering spikes
  *
  * This class implements a ring buffer for spike delivery.
- * Spikes are scheduled to be delivered at a time t + delay using SpikeBuffer::schedule. All scheduled spikes can
- * then be retrieved by iterating over the list, from first element SpikeIterator::front until SpikeIterator::back.
+ * Spikes are scheduled to be delivered at a time t + delay using SpikeBuffer::schedule. Each slot of the ring
+ * keeps one contiguous array per partition (local network), so that the spikes scheduled for the current time step
+ * of a partition can be retrieved with SpikeBuffer::getSpikes and processed in a tight loop.
+ * Arrays are cleared but not deallocated when the buffer advances, so that scheduling does not allocate memory
+ * once the buffer has warmed up.
  *
  * \since v4.0
  */
@@ -68,8 +72,8 @@ public:
      * \brief SpikeBuffer Constructor
      *
      * A SpikeBuffer is used to schedule and deliver spikes after a certain delay t + delay.
-     * Spikes are scheduled to be delivered at a time t + delay using SpikeBuffer::schedule. All scheduled spikes can
-     * then be retrieved by iterating over the list, from first element SpikeIterator::front until SpikeIterator::back.
+     * Spikes are scheduled to be delivered at a time t + delay using SpikeBuffer::schedule. The spikes of a
+     * partition can then be retrieved with SpikeBuffer::getSpikes.
      * \param[in] minDelay Minimum delay (in number of time steps) the buffer can handle
      * \param[in] maxDelay Maximum delay (in number of time steps) the buffer can handle
     */
@@ -83,56 +87,16 @@ public:
     ~SpikeBuffer();
 
 
-    // +++++ PUBLIC DATA STRUCTURES +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-
-    //! linked list to hold the corresponding neuron Id and delivery delay for each spike
-    struct SpikeNode {
-        int neurId; //!< corresponding global neuron Id
-		int grpId; //!< corresponding global group Id
-        unsigned short int delay; //!< scheduling delay (in number of time steps)
-        SpikeNode* next; //!< pointer to the next element in the list
-    };
-
-    //! Iterator to loop over the scheduled spikes at a certain delay
-    class SpikeIterator {
-    public:
-        SpikeIterator() : _node(NULL) {}
-        SpikeIterator(SpikeNode* n) : _node(n) {}
-
-        SpikeNode* operator->() {
-            return _node;
-        }
-
-        int operator*() {
-            return _node->neurId;
-        }
-
-        bool operator==(const SpikeIterator& other) {
-            return (_node == other._node);
-        }
-
-        bool operator!=(const SpikeIterator& other) {
-            return (_node != other._node);
-        }
-
-        inline SpikeIterator* operator++() {
-            _node = _node->next;
-            return this;
-        }
-
-    private:
-        SpikeNode* _node;
-    };
-
-
     /*!
      * \brief Schedule a spike
      *
-     * This method schedules a spike to be delivered to neuron with ID neurID, after a delay of t + delay time steps.
-     * \param[in] neurId corresponding neuron ID
+     * This method schedules a spike of a neuron in partition netId to be delivered after a delay of t + delay
+     * time steps.
+     * \param[in] netId corresponding partition (local network) ID
+     * \param[in] neurId neuron ID, in whatever local numbering the consumer of the partition expects
      * \param[in] delay scheduling delay (in number of time steps)
      */
-    void schedule(int neurId, int grpId, unsigned short int delay);
+    void schedule(int netId, int neurId, unsigned short int delay);
 
     //! advance to next time step
     void step();
@@ -149,11 +113,13 @@ public:
     //! retrieve actual length of the buffer
     size_t length();
 
-    //! pointer to the front of the spike buffer
-    SpikeIterator front(int stepOffset=0);
-
-    //! pointer to the back of the spike buffer
-    SpikeIterator back();
+    /*!
+     * \brief Retrieve scheduled spikes
+     *
+     * Returns the neuron IDs of all spikes of partition netId that are scheduled for the current time step (plus
+     * stepOffset), in the order in which they were scheduled.
+     */
+    const std::vector<int>& getSpikes(int netId, int stepOffset=0);
 
 
 private:
@@ -2855,7 +2855,7 @@ void SNN::spikeGeneratorUpdate_GPU(int netId) {
 		memset(managerRuntimeData.spikeGenBits, 0, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1));
 
 		// fill spikeGenBits from SpikeBuffer
-		fillSpikeGenBits(netId);
+		fillSpikeGenBits(netId, managerRuntimeData.spikeGenBits);
 
 		// copy the spikeGenBits from the manager to the GPU..
 		CUDA_CHECK_ERRORS(cudaMemcpy(runtimeData[netId].spikeGenBits, managerRuntimeData.spikeGenBits, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1), cudaMemcpyHostToDevice));
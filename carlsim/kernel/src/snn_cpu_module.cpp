@@ -50,34 +50,48 @@
 
 #include <spike_buffer.h>
 
+#include <algorithm>	// std::sort, std::lower_bound
+
 // spikeGeneratorUpdate_CPU on CPUs
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::spikeGeneratorUpdate_CPU(int netId) {
-#else // POSIX
-	void* SNN::spikeGeneratorUpdate_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].allocated);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	// FIXME: skip this step if all spike gen neuron are possion neuron (generated by rate)
 	// update the random number for poisson spike generator (spikes generated by rate)
-	for (int poisN = 0; poisN < networkConfigs[netId].numNPois; poisN++) {
-		// set CPU_MODE Random Gen, store random number to g(c)puRandNums
-		runtimeData[netId].randNum[poisN] = drand48();
+	// Every group and millisecond gets its own CounterRNG stream, keyed by (random seed, global group id, simTime),
+	// and the n-th neuron of the group uses the n-th number of that stream. Random numbers therefore neither depend
+	// on the partitioning of the network nor on the number of threads. Neurons with zero rate cannot fire, so no
+	// random number is drawn for them. Spike generator groups (isSpikeGenFunc) and event-driven Poisson groups (see
+	// schedulePoissonSpike_CPU) do not use randNum at all.
+	const int numNReg = networkConfigs[netId].numNReg;
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (!(groupConfigs[netId][lGrpId].Type & POISSON_NEURON) || groupConfigs[netId][lGrpId].isSpikeGenFunc
+			|| poissonWheels_[netId].isEventDriven(lGrpId))
+			continue;
+
+		// invert the group id to keep these streams apart from the streams of SNN::connect (keyed by connId)
+		const CounterRNG rng(randSeed_, ~(uint64_t)groupConfigs[netId][lGrpId].gGrpId, simTime);
+		const int poisStart = groupConfigs[netId][lGrpId].lStartN - numNReg;
+		const int poisEnd = groupConfigs[netId][lGrpId].lEndN - numNReg;
+		float* randNum = runtimeData[netId].randNum;
+		const float* rate = runtimeData[netId].poissonFireRate;
+		for (int poisN = poisStart; poisN <= poisEnd; poisN++) {
+			if (rate[poisN] == 0.0f)
+				continue;
+			randNum[poisN] = rng.uniformFloatAt(poisN - poisStart + 1);
+		}
 	}
 
 	// Use spike generators (user-defined callback function)
 	if (networkConfigs[netId].numNSpikeGen > 0) {
-		assert(managerRuntimeData.spikeGenBits != NULL);
+		assert(runtimeData[netId].spikeGenBits != NULL);
 
 		// reset the bit status of the spikeGenBits...
-		memset(managerRuntimeData.spikeGenBits, 0, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1));
-
-		// fill spikeGenBits from SpikeBuffer
-		fillSpikeGenBits(netId);
+		memset(runtimeData[netId].spikeGenBits, 0, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1));
 
-		// copy the spikeGenBits from the manager to the CPU runtime
-		memcpy(runtimeData[netId].spikeGenBits, managerRuntimeData.spikeGenBits, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1));
+		// fill spikeGenBits of the CPU runtime directly from SpikeBuffer (no staging in the manager, which is shared
+		// by all partitions)
+		fillSpikeGenBits(netId, runtimeData[netId].spikeGenBits);
 	}
 }
 
@@ -87,15 +101,11 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> spikeGeneratorUpdate_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::updateTimingTable_CPU(int netId) {
-#else // POSIX
-	void* SNN::updateTimingTable_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	runtimeData[netId].timeTableD2[simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
@@ -108,7 +118,7 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> updateTimingTable_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -227,11 +237,7 @@
 //
 //}
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#else // POSIX
-	void* SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#endif
 	int spikeCountExtRx = endIdx - startIdx; // received external spike count
 
 	runtimeData[netId].spikeCountD2Sec += spikeCountExtRx;
@@ -244,21 +250,7 @@
 		runtimeData[netId].firingTableD2[extIdx] += GtoLOffset;
 }
 
-#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-	// Static multithreading subroutine method - helper for the above method
-	void* SNN::helperConvertExtSpikesD2_CPU(void* arguments) {
-		ThreadStruct* args = (ThreadStruct*) arguments;
-		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> convertExtSpikesD2_CPU(args->netId, args->startIdx, args->endIdx, args->GtoLOffset);
-		pthread_exit(0);
-	}
-#endif
-
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#else // POSIX
-	void* SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#endif
 	int spikeCountExtRx = endIdx - startIdx; // received external spike count
 
 	runtimeData[netId].spikeCountD1Sec += spikeCountExtRx;
@@ -270,21 +262,42 @@
 		runtimeData[netId].firingTableD1[extIdx] += GtoLOffset;
 }
 
-#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-	// Static multithreading subroutine method - helper for the above method
-	void* SNN::helperConvertExtSpikesD1_CPU(void* arguments) {
-		ThreadStruct* args = (ThreadStruct*) arguments;
-		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> convertExtSpikesD1_CPU(args->netId, args->startIdx, args->endIdx, args->GtoLOffset);
-		pthread_exit(0);
+void SNN::routeSpikes_CPU(int srcNetId, const SpikeRoute& route) {
+	int destNetId = route.destNetId;
+	int timeSlot = simTimeMs + glbNetworkConfig.maxDelay + 1;
+	assert(srcNetId >= CPU_RUNTIME_BASE && destNetId >= CPU_RUNTIME_BASE);
+
+	unsigned int firingTableIdxD2 = runtimeData[destNetId].timeTableD2[timeSlot];
+	unsigned int firingTableIdxD1 = runtimeData[destNetId].timeTableD1[timeSlot];
+	unsigned int spikeCountExtRxD2 = 0, spikeCountExtRxD1 = 0;
+
+	for (int i = 0; i < route.lGrpIds.size(); i++) {
+		int lGrpId = route.lGrpIds[i];
+		int GtoLOffset = route.GtoLOffsets[i];
+
+		int* extFiringTableD2 = runtimeData[srcNetId].extFiringTableD2[lGrpId];
+		for (int extIdx = 0; extIdx < runtimeData[srcNetId].extFiringTableEndIdxD2[lGrpId]; extIdx++)
+			runtimeData[destNetId].firingTableD2[firingTableIdxD2++] = extFiringTableD2[extIdx] + GtoLOffset;
+		spikeCountExtRxD2 += runtimeData[srcNetId].extFiringTableEndIdxD2[lGrpId];
+
+		int* extFiringTableD1 = runtimeData[srcNetId].extFiringTableD1[lGrpId];
+		for (int extIdx = 0; extIdx < runtimeData[srcNetId].extFiringTableEndIdxD1[lGrpId]; extIdx++)
+			runtimeData[destNetId].firingTableD1[firingTableIdxD1++] = extFiringTableD1[extIdx] + GtoLOffset;
+		spikeCountExtRxD1 += runtimeData[srcNetId].extFiringTableEndIdxD1[lGrpId];
 	}
-#endif
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
+	runtimeData[destNetId].spikeCountD2Sec += spikeCountExtRxD2;
+	runtimeData[destNetId].spikeCountExtRxD2 += spikeCountExtRxD2;
+	runtimeData[destNetId].spikeCountExtRxD2Sec += spikeCountExtRxD2;
+	runtimeData[destNetId].spikeCountD1Sec += spikeCountExtRxD1;
+	runtimeData[destNetId].spikeCountExtRxD1 += spikeCountExtRxD1;
+	runtimeData[destNetId].spikeCountExtRxD1Sec += spikeCountExtRxD1;
+
+	runtimeData[destNetId].timeTableD2[timeSlot] = firingTableIdxD2;
+	runtimeData[destNetId].timeTableD1[timeSlot] = firingTableIdxD1;
+}
+
 	void SNN::clearExtFiringTable_CPU(int netId) {
-#else // POSIX
-	void* SNN::clearExtFiringTable_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	memset(runtimeData[netId].extFiringTableEndIdxD1, 0, sizeof(int) * networkConfigs[netId].numGroups);
@@ -297,7 +310,7 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> clearExtFiringTable_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -327,11 +340,7 @@ void SNN::copyExtFiringTable(int netId) {
 // used for management of manager runtime data
 // FIXME: make sure this is right when separating cpu_module to a standalone class
 // FIXME: currently this function clear nSpikeCnt of manager runtime data
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
-#else // POSIX
-	void* SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	if (lGrpId == ALL) {
@@ -349,19 +358,40 @@ void SNN::copyExtFiringTable(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> resetSpikeCnt_CPU(args->netId, args->lGrpId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
 // This method loops through all spikes that are generated by neurons with a delay of 1ms
 // and delivers the spikes to the appropriate post-synaptic neuron
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::doCurrentUpdateD1_CPU(int netId) {
-#else // POSIX
-	void* SNN::doCurrentUpdateD1_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 
+	deliverSpikesD1_CPU(netId, 0, networkConfigs[netId].numN);
+}
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperDoCurrentUpdateD1_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> doCurrentUpdateD1_CPU(args->netId);
+		return NULL;
+	}
+
+	// Static multithreading subroutine method - every worker of a CPU runtime delivers the spikes to the
+	// post-synaptic neurons it owns
+	void* SNN::helperDoCurrentUpdateD1Chunk_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> deliverSpikesD1_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
+	}
+#endif
+
+// delivers the spikes with a delay of 1ms to the post-synaptic neurons in [startPostN, endPostN). All spikes are
+// visited in the same order for any range, so that every post-synaptic neuron accumulates its input in the same
+// order no matter how many workers share the CPU runtime.
+void SNN::deliverSpikesD1_CPU(int netId, int startPostN, int endPostN) {
 	int k     = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay + 1] - 1;
 	int k_end = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay];
 
@@ -373,43 +403,43 @@ void SNN::copyExtFiringTable(int netId) {
 
 		unsigned int offset = runtimeData[netId].cumulativePost[lNId];
 
-		for(int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
-			// get synaptic info...
-			SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
-
-			int postNId = GET_CONN_NEURON_ID(postInfo);
-			assert(postNId < networkConfigs[netId].numNAssigned);
-
-			int synId = GET_CONN_SYN_ID(postInfo);
-			assert(synId < (runtimeData[netId].Npre[postNId]));
-
-			if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
-				generatePostSynapticSpike(lNId /* preNId */, postNId, synId, 0, netId);
-		}
+		// deliver the spike with the kernel specialized for the pre-synaptic group
+		short int pre_grpId = runtimeData[netId].grpIds[lNId];
+		(this->*deliveryKernels_CPU[netId][pre_grpId])(netId, lNId, 0, offset + dPar.delay_index_start,
+			offset + dPar.delay_index_start + dPar.delay_length, startPostN, endPostN);
 
 		k = k - 1;
 	}
 }
 
+// This method loops through all spikes that are generated by neurons with a delay of 2+ms
+// and delivers the spikes to the appropriate post-synaptic neuron
+	void SNN::doCurrentUpdateD2_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	deliverSpikesD2_CPU(netId, 0, networkConfigs[netId].numN);
+}
+
 #if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method
-	void* SNN::helperDoCurrentUpdateD1_CPU(void* arguments) {
+	void* SNN::helperDoCurrentUpdateD2_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doCurrentUpdateD1_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> doCurrentUpdateD2_CPU(args->netId);
+		return NULL;
 	}
-#endif
 
-// This method loops through all spikes that are generated by neurons with a delay of 2+ms
-// and delivers the spikes to the appropriate post-synaptic neuron
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
-	void SNN::doCurrentUpdateD2_CPU(int netId) {
-#else // POSIX
-	void* SNN::doCurrentUpdateD2_CPU(int netId) {
+	// Static multithreading subroutine method - every worker of a CPU runtime delivers the spikes to the
+	// post-synaptic neurons it owns
+	void* SNN::helperDoCurrentUpdateD2Chunk_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> deliverSpikesD2_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
+	}
 #endif
-	assert(runtimeData[netId].memType == CPU_MEM);
 
+// delivers the spikes with a delay of 2+ms to the post-synaptic neurons in [startPostN, endPostN), see deliverSpikesD1_CPU
+void SNN::deliverSpikesD2_CPU(int netId, int startPostN, int endPostN) {
 	if (networkConfigs[netId].maxDelay > 1) {
 		int k = runtimeData[netId].timeTableD2[simTimeMs + 1 + networkConfigs[netId].maxDelay] - 1;
 		int k_end = runtimeData[netId].timeTableD2[simTimeMs + 1];
@@ -436,41 +466,17 @@ void SNN::copyExtFiringTable(int netId) {
 
 			unsigned int offset = runtimeData[netId].cumulativePost[lNId];
 
-			// for each delay variables
-			for (int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
-				// get synaptic info...
-				SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
-
-				int postNId = GET_CONN_NEURON_ID(postInfo);
-				assert(postNId < networkConfigs[netId].numNAssigned);
-
-				int synId = GET_CONN_SYN_ID(postInfo);
-				assert(synId < (runtimeData[netId].Npre[postNId]));
-
-				if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
-					generatePostSynapticSpike(lNId /* preNId */, postNId, synId, tD, netId);
-			}
+			// deliver the spike with the kernel specialized for the pre-synaptic group
+			short int pre_grpId = runtimeData[netId].grpIds[lNId];
+			(this->*deliveryKernels_CPU[netId][pre_grpId])(netId, lNId, tD, offset + dPar.delay_index_start,
+				offset + dPar.delay_index_start + dPar.delay_length, startPostN, endPostN);
 
 			k = k - 1;
 		}
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-	// Static multithreading subroutine method - helper for the above method
-	void* SNN::helperDoCurrentUpdateD2_CPU(void* arguments) {
-		ThreadStruct* args = (ThreadStruct*) arguments;
-		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doCurrentUpdateD2_CPU(args->netId);
-		pthread_exit(0);
-	}
-#endif
-
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
-#else // POSIX
-	void* SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
 	//decay the STP variables before adding new spikes.
@@ -511,18 +517,36 @@ void SNN::copyExtFiringTable(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> doSTPUpdateAndDecayCond_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::findFiring_CPU(int netId) {
-#else // POSIX
-	void* SNN::findFiring_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
+
+	// event-driven Poisson groups only touch the neurons whose scheduled spike is due now (in ascending order, so that
+	// the firing table has the same order as for the per-neuron loop below)
+	std::vector<int>& due = poissonDue_[netId];
+	due.clear();
+	if (poissonWheels_[netId].hasEvents()) {
+		poissonWheels_[netId].popDue(simTime, due);
+		std::sort(due.begin(), due.end());
+	}
+
 	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
 	for(int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (poissonWheels_[netId].isEventDriven(lGrpId)) {
+			int refPeriod = poissonWheels_[netId].getRefPeriod(lGrpId);
+			std::vector<int>::iterator it = std::lower_bound(due.begin(), due.end(), groupConfigs[netId][lGrpId].lStartN);
+			for (; it != due.end() && *it <= groupConfigs[netId][lGrpId].lEndN; it++) {
+				int lNId = *it;
+				runtimeData[netId].lastSpikeTime[lNId] = simTime;
+				schedulePoissonSpike_CPU(lNId, lGrpId, netId, simTime + refPeriod - 1);
+				recordSpike_CPU(lNId, lGrpId, netId);
+			}
+			continue;
+		}
+
 		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
 			bool needToWrite = false;
 			// given group of neurons belong to the poisson group....
@@ -552,63 +576,8 @@ void SNN::copyExtFiringTable(int netId) {
 			}
 
 			// his flag is set if with_stdp is set and also grpType is set to have GROUP_SYN_FIXED
-			if (needToWrite) {
-				bool hasSpace = false;
-				int fireId = -1;
-
-				// update spike count: spikeCountD2Sec(W), spikeCountD1Sec(W), spikeCountLastSecLeftD2(R)
-				if (groupConfigs[netId][lGrpId].MaxDelay == 1)
-				{
-					if (runtimeData[netId].spikeCountD1Sec + 1 < networkConfigs[netId].maxSpikesD1) {
-						fireId = runtimeData[netId].spikeCountD1Sec;
-						runtimeData[netId].spikeCountD1Sec++;
-					}
-				} else { // MaxDelay > 1
-					if (runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2 + 1 < networkConfigs[netId].maxSpikesD2) {
-						fireId = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
-						runtimeData[netId].spikeCountD2Sec++;
-					}
-				}
-
-				if (fireId == -1) // no space availabe in firing table, drop the spike
-					continue;
-
-				// update firing table: firingTableD1(W), firingTableD2(W)
-				if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
-					runtimeData[netId].firingTableD1[fireId] = lNId;
-				} else { // MaxDelay > 1
-					runtimeData[netId].firingTableD2[fireId] = lNId;
-				}
-
-				// update external firing table: extFiringTableEndIdxD1(W), extFiringTableEndIdxD2(W), extFiringTableD1(W), extFiringTableD2(W)
-				if (groupConfigs[netId][lGrpId].hasExternalConnect)     {
-					int extFireId = -1;
-					if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
-						extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
-						runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
-					} else { // MaxDelay > 1
-						extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
-						runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
-					}
-					assert(extFireId != -1);
-				}
-
-				// update STP for neurons that fire
-				if (groupConfigs[netId][lGrpId].WithSTP) {
-					firingUpdateSTP(lNId, lGrpId, netId);
-				}
-
-				// keep track of number spikes per neuron
-				runtimeData[netId].nSpikeCnt[lNId]++;
-
-				if (IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois))
-					resetFiredNeuron(lNId, lGrpId, netId);
-
-				// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
-				if (!sim_in_testing && groupConfigs[netId][lGrpId].WithSTDP) {
-					updateLTP(lNId, lGrpId, netId);
-				}
-			}
+			if (needToWrite)
+				recordSpike_CPU(lNId, lGrpId, netId);
 		}
 	}
 }
@@ -619,10 +588,68 @@ void SNN::copyExtFiringTable(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> findFiring_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
+// writes a spike of neuron lNId to the firing tables and updates spike counts, STP, and STDP accordingly
+void SNN::recordSpike_CPU(int lNId, int lGrpId, int netId) {
+	int fireId = -1;
+
+	// update spike count: spikeCountD2Sec(W), spikeCountD1Sec(W), spikeCountLastSecLeftD2(R)
+	if (groupConfigs[netId][lGrpId].MaxDelay == 1)
+	{
+		if (runtimeData[netId].spikeCountD1Sec + 1 < networkConfigs[netId].maxSpikesD1) {
+			fireId = runtimeData[netId].spikeCountD1Sec;
+			runtimeData[netId].spikeCountD1Sec++;
+		}
+	} else { // MaxDelay > 1
+		if (runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2 + 1 < networkConfigs[netId].maxSpikesD2) {
+			fireId = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
+			runtimeData[netId].spikeCountD2Sec++;
+		}
+	}
+
+	if (fireId == -1) // no space availabe in firing table, drop the spike
+		return;
+
+	// update firing table: firingTableD1(W), firingTableD2(W)
+	if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
+		runtimeData[netId].firingTableD1[fireId] = lNId;
+	} else { // MaxDelay > 1
+		runtimeData[netId].firingTableD2[fireId] = lNId;
+	}
+
+	// update external firing table: extFiringTableEndIdxD1(W), extFiringTableEndIdxD2(W), extFiringTableD1(W), extFiringTableD2(W)
+	if (groupConfigs[netId][lGrpId].hasExternalConnect)     {
+		int extFireId = -1;
+		if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
+			extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
+			runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
+		} else { // MaxDelay > 1
+			extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
+			runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
+		}
+		assert(extFireId != -1);
+	}
+
+	// update STP for neurons that fire
+	if (groupConfigs[netId][lGrpId].WithSTP) {
+		firingUpdateSTP(lNId, lGrpId, netId);
+	}
+
+	// keep track of number spikes per neuron
+	runtimeData[netId].nSpikeCnt[lNId]++;
+
+	if (IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois))
+		resetFiredNeuron(lNId, lGrpId, netId);
+
+	// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
+	if (!sim_in_testing && groupConfigs[netId][lGrpId].WithSTDP) {
+		updateLTP(lNId, lGrpId, netId);
+	}
+}
+
 
 void SNN::updateLTP(int lNId, int lGrpId, int netId) {
 	unsigned int pos_ij = runtimeData[netId].cumulativePre[lNId]; // the index of pre-synaptic neuron
@@ -708,6 +735,34 @@ bool SNN::getPoissonSpike(int lNId, int netId) {
 			< runtimeData[netId].poissonFireRate[lNId - networkConfigs[netId].numNReg];
 }
 
+// Event-driven Poisson neurons: instead of testing randNum against the rate every millisecond, the time until the next
+// spike is drawn directly. The number of 1ms-steps until a Bernoulli trial with p = rate/1000 succeeds is geometrically
+// distributed, k = ceil(log(U) / log(1-p)), so the spike train has the same statistics as getPoissonSpike. After a spike,
+// the neuron is silent for refPeriod-1 ms (tBase = time of spike + refPeriod - 1), so that ISIs are >= refPeriod.
+// Random numbers are drawn from a CounterRNG stream per neuron, indexed by tBase, which keeps them independent of the
+// partitioning and of the number of threads.
+void SNN::schedulePoissonSpike_CPU(int lNId, int lGrpId, int netId, int tBase) {
+	float rate = runtimeData[netId].poissonFireRate[lNId - networkConfigs[netId].numNReg];
+	if (rate <= 0.0f)
+		return; // never fires
+
+	double p = rate / 1000.0;
+	double isi = 1.0;
+	if (p < 1.0) {
+		// offset the group id to keep these streams apart from those of SNN::connect and spikeGeneratorUpdate_CPU
+		const CounterRNG rng(randSeed_, ((uint64_t)1 << 32) + groupConfigs[netId][lGrpId].gGrpId,
+			lNId - groupConfigs[netId][lGrpId].lStartN);
+		double u = 1.0 - (rng.at((uint64_t)tBase + 1) >> 11) * (1.0 / 9007199254740992.0); // in (0,1]
+		isi = std::max(1.0, ceil(log(u) / log(1.0 - p)));
+	}
+
+	// spikes beyond the maximum simulation time never happen
+	if (tBase + isi >= (double)MAX_SIMULATION_TIME)
+		return;
+
+	poissonWheels_[netId].schedule(lNId, tBase + (int)isi);
+}
+
 bool SNN::getSpikeGenBit(unsigned int nIdPos, int netId) {
 	const int nIdBitPos = nIdPos % 32;
 	const int nIdIndex  = nIdPos / 32;
@@ -726,131 +781,214 @@ bool SNN::getSpikeGenBit(unsigned int nIdPos, int netId) {
 * P7. Update v(voltage), u(recovery)
 * P8. Update homeostasis
 * P9. Decay and log DA,5HT,ACh,NE
+*
+* P1-P6 are carried out by deliverPreSynapticSpike_CPU(), which delivers a spike of preNId to the synapses
+* [synStart, synEnd) of its post-synaptic list. Everything that only depends on the pre-synaptic group (the
+* receptors it targets, STP, and the NMDA/GABAb rise flags) is a template parameter, so that the loop over
+* the synapses does not re-evaluate it for every synapse. assignDeliveryKernels_CPU() picks the instantiation
+* of each group at setupNetwork() time.
 */
-void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD, int netId) {
-	// get the cumulative position for quick access
-	unsigned int pos = runtimeData[netId].cumulativePre[postNId] + synId;
-	assert(postNId < networkConfigs[netId].numNReg); // \FIXME is this assert supposed to be for pos?
-
-	// get group id of pre- / post-neuron
-	short int post_grpId = runtimeData[netId].grpIds[postNId];
+template<int target, bool withSTP, bool withRise>
+void SNN::deliverPreSynapticSpike_CPU(int netId, int preNId, int tD, int synStart, int synEnd, int startPostN, int endPostN) {
 	short int pre_grpId = runtimeData[netId].grpIds[preNId];
-
 	unsigned int pre_type = groupConfigs[netId][pre_grpId].Type;
 
-	// get connect info from the cumulative synapse index for mulSynFast/mulSynSlow (requires less memory than storing
-	// mulSynFast/Slow per synapse or storing a pointer to grpConnectInfo_s)
-	// mulSynFast will be applied to fast currents (either AMPA or GABAa)
-	// mulSynSlow will be applied to slow currents (either NMDA or GABAb)
-	short int mulIndex = runtimeData[netId].connIdsPreIdx[pos];
-	assert(mulIndex >= 0 && mulIndex < numConnections);
-
-	// P1
-	// for each presynaptic spike, postsynaptic (synaptic) current is going to increase by some amplitude (change)
-	// generally speaking, this amplitude is the weight; but it can be modulated by STP
-	float change = runtimeData[netId].wt[pos];
-
 	// P2
-	if (groupConfigs[netId][pre_grpId].WithSTP) {
-		// if pre-group has STP enabled, we need to modulate the weight
-		// NOTE: Order is important! (Tsodyks & Markram, 1998; Mongillo, Barak, & Tsodyks, 2008)
-		// use u^+ (value right after spike-update) but x^- (value right before spike-update)
-
-		// dI/dt = -I/tau_S + A * u^+ * x^- * \delta(t-t_{spk})
-		// I noticed that for connect(.., RangeDelay(1), ..) tD will be 0
+	// STP modulates all synapses of the pre-synaptic neuron by the same factor
+	// NOTE: Order is important! (Tsodyks & Markram, 1998; Mongillo, Barak, & Tsodyks, 2008)
+	// use u^+ (value right after spike-update) but x^- (value right before spike-update)
+	// dI/dt = -I/tau_S + A * u^+ * x^- * \delta(t-t_{spk})
+	// I noticed that for connect(.., RangeDelay(1), ..) tD will be 0
+	float stpScale = 1.0f;
+	if (withSTP) {
 		int ind_minus = STP_BUF_POS(preNId, (simTime-tD-1), networkConfigs[netId].maxDelay);
 		int ind_plus  = STP_BUF_POS(preNId, (simTime-tD), networkConfigs[netId].maxDelay);
+		stpScale = groupConfigs[netId][pre_grpId].STP_A * runtimeData[netId].stpu[ind_plus] * runtimeData[netId].stpx[ind_minus];
+	}
 
-		change *= groupConfigs[netId][pre_grpId].STP_A * runtimeData[netId].stpu[ind_plus] * runtimeData[netId].stpx[ind_minus];
+	for (int idx = synStart; idx < synEnd; idx++) {
+		// get synaptic info...
+		SynInfo postInfo = runtimeData[netId].postSynapticIds[idx];
 
-		//printf("%d: %d[%d], numN=%d, td=%d, maxDelay_=%d, ind-=%d, ind+=%d, stpu=[%f,%f], stpx=[%f,%f], change=%f, wt=%f\n",
-		//	simTime, pre_grpId, preNId,
-		//	groupConfigs[netId][pre_grpId].numN, tD, networkConfigs[netId].maxDelay, ind_minus, ind_plus,
-		//	runtimeData[netId].stpu[ind_minus], runtimeData[netId].stpu[ind_plus],
-		//	runtimeData[netId].stpx[ind_minus], runtimeData[netId].stpx[ind_plus],
-		//	change, runtimeData[netId].wt[pos]);
-	}
+		int postNId = GET_CONN_NEURON_ID(postInfo);
+		assert(postNId < networkConfigs[netId].numNAssigned);
 
-	// P3-1, P3-2
-	// update currents
-	// NOTE: it's faster to += 0.0 rather than checking for zero and not updating
-	if (sim_with_conductances) {
-		if (pre_type & TARGET_AMPA) // if postNId expresses AMPAR
+		if (postNId < startPostN || postNId >= endPostN) // test if post-neuron is a local neuron owned by the caller
+			continue;
+
+		int synId = GET_CONN_SYN_ID(postInfo);
+		assert(synId < (runtimeData[netId].Npre[postNId]));
+		assert(postNId < networkConfigs[netId].numNReg);
+
+		// get the cumulative position for quick access
+		unsigned int pos = runtimeData[netId].cumulativePre[postNId] + synId;
+
+		// get connect info from the cumulative synapse index for mulSynFast/mulSynSlow (requires less memory than storing
+		// mulSynFast/Slow per synapse or storing a pointer to grpConnectInfo_s)
+		// mulSynFast will be applied to fast currents (either AMPA or GABAa)
+		// mulSynSlow will be applied to slow currents (either NMDA or GABAb)
+		short int mulIndex = runtimeData[netId].connIdsPreIdx[pos];
+		assert(mulIndex >= 0 && mulIndex < numConnections);
+
+		// P1
+		// for each presynaptic spike, postsynaptic (synaptic) current is going to increase by some amplitude (change)
+		// generally speaking, this amplitude is the weight; but it can be modulated by STP
+		float change = runtimeData[netId].wt[pos];
+
+		// P2
+		if (withSTP)
+			change *= stpScale;
+
+		// P3-1, P3-2
+		// update currents
+		// NOTE: it's faster to += 0.0 rather than checking for zero and not updating
+		switch (target) {
+		case CUBA_DELIVERY:
+			runtimeData[netId].current[postNId] += change;
+			break;
+		case COBA_EXC_DELIVERY: // pre-group targets AMPA and NMDA
 			runtimeData[netId].gAMPA [postNId] += change * mulSynFast[mulIndex]; // scale by some factor
-		if (pre_type & TARGET_NMDA) {
-			if (sim_with_NMDA_rise) {
+			if (withRise) {
 				runtimeData[netId].gNMDA_r[postNId] += change * sNMDA * mulSynSlow[mulIndex];
 				runtimeData[netId].gNMDA_d[postNId] += change * sNMDA * mulSynSlow[mulIndex];
 			} else {
 				runtimeData[netId].gNMDA [postNId] += change * mulSynSlow[mulIndex];
 			}
-		}
-		if (pre_type & TARGET_GABAa)
+			break;
+		case COBA_INH_DELIVERY: // pre-group targets GABAa and GABAb
 			runtimeData[netId].gGABAa[postNId] -= change * mulSynFast[mulIndex]; // wt should be negative for GABAa and GABAb
-		if (pre_type & TARGET_GABAb) {
-			if (sim_with_GABAb_rise) {
+			if (withRise) {
 				runtimeData[netId].gGABAb_r[postNId] -= change * sGABAb * mulSynSlow[mulIndex];
 				runtimeData[netId].gGABAb_d[postNId] -= change * sGABAb * mulSynSlow[mulIndex];
 			} else {
 				runtimeData[netId].gGABAb[postNId] -= change * mulSynSlow[mulIndex];
 			}
+			break;
+		default: // COBA_ANY_DELIVERY: any other combination of receptors
+			if (pre_type & TARGET_AMPA) // if postNId expresses AMPAR
+				runtimeData[netId].gAMPA [postNId] += change * mulSynFast[mulIndex]; // scale by some factor
+			if (pre_type & TARGET_NMDA) {
+				if (sim_with_NMDA_rise) {
+					runtimeData[netId].gNMDA_r[postNId] += change * sNMDA * mulSynSlow[mulIndex];
+					runtimeData[netId].gNMDA_d[postNId] += change * sNMDA * mulSynSlow[mulIndex];
+				} else {
+					runtimeData[netId].gNMDA [postNId] += change * mulSynSlow[mulIndex];
+				}
+			}
+			if (pre_type & TARGET_GABAa)
+				runtimeData[netId].gGABAa[postNId] -= change * mulSynFast[mulIndex]; // wt should be negative for GABAa and GABAb
+			if (pre_type & TARGET_GABAb) {
+				if (sim_with_GABAb_rise) {
+					runtimeData[netId].gGABAb_r[postNId] -= change * sGABAb * mulSynSlow[mulIndex];
+					runtimeData[netId].gGABAb_d[postNId] -= change * sGABAb * mulSynSlow[mulIndex];
+				} else {
+					runtimeData[netId].gGABAb[postNId] -= change * mulSynSlow[mulIndex];
+				}
+			}
+			break;
 		}
-	} else {
-		runtimeData[netId].current[postNId] += change;
-	}
 
-	// P4
-	runtimeData[netId].synSpikeTime[pos] = simTime;
+		// P4
+		runtimeData[netId].synSpikeTime[pos] = simTime;
+
+		short int post_grpId = runtimeData[netId].grpIds[postNId];
+
+		// P5
+		// Got one spike from dopaminergic neuron, increase dopamine concentration in the target area
+		if (pre_type & TARGET_DA) {
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+			// the post-synaptic group may be shared by several workers; every increment is the same, so the result
+			// does not depend on the order in which the workers take the lock
+			if (numCPUThreadsPerRuntime[netId] > 1) {
+				pthread_mutex_lock(&cpuDAMutex);
+				runtimeData[netId].grpDA[post_grpId] += 0.04;
+				pthread_mutex_unlock(&cpuDAMutex);
+			} else
+#endif
+			runtimeData[netId].grpDA[post_grpId] += 0.04;
+		}
 
-	// P5
-	// Got one spike from dopaminergic neuron, increase dopamine concentration in the target area
-	if (pre_type & TARGET_DA) {
-		runtimeData[netId].grpDA[post_grpId] += 0.04;
+		// P6
+		if (!sim_in_testing && groupConfigs[netId][post_grpId].WithSTDP)
+			updateLTD(postNId, post_grpId, pos, pre_type, netId);
 	}
+}
 
-	// P6
-	// STDP calculation: the post-synaptic neuron fires before the arrival of a pre-synaptic spike
-	if (!sim_in_testing && groupConfigs[netId][post_grpId].WithSTDP) {
-		int stdp_tDiff = (simTime - runtimeData[netId].lastSpikeTime[postNId]);
+// selects the delivery kernel of every (local and external) group of a CPU runtime according to the receptors
+// its neurons target, STP, and the NMDA/GABAb rise flags
+void SNN::assignDeliveryKernels_CPU(int netId) {
+	// table of instantiations, indexed by [target][withSTP][withRise]
+	static const DeliveryKernel_CPU kernels[4][2][2] = {
+		{ { &SNN::deliverPreSynapticSpike_CPU<CUBA_DELIVERY, false, false>, &SNN::deliverPreSynapticSpike_CPU<CUBA_DELIVERY, false, true> },
+		  { &SNN::deliverPreSynapticSpike_CPU<CUBA_DELIVERY, true, false>, &SNN::deliverPreSynapticSpike_CPU<CUBA_DELIVERY, true, true> } },
+		{ { &SNN::deliverPreSynapticSpike_CPU<COBA_EXC_DELIVERY, false, false>, &SNN::deliverPreSynapticSpike_CPU<COBA_EXC_DELIVERY, false, true> },
+		  { &SNN::deliverPreSynapticSpike_CPU<COBA_EXC_DELIVERY, true, false>, &SNN::deliverPreSynapticSpike_CPU<COBA_EXC_DELIVERY, true, true> } },
+		{ { &SNN::deliverPreSynapticSpike_CPU<COBA_INH_DELIVERY, false, false>, &SNN::deliverPreSynapticSpike_CPU<COBA_INH_DELIVERY, false, true> },
+		  { &SNN::deliverPreSynapticSpike_CPU<COBA_INH_DELIVERY, true, false>, &SNN::deliverPreSynapticSpike_CPU<COBA_INH_DELIVERY, true, true> } },
+		{ { &SNN::deliverPreSynapticSpike_CPU<COBA_ANY_DELIVERY, false, false>, &SNN::deliverPreSynapticSpike_CPU<COBA_ANY_DELIVERY, false, true> },
+		  { &SNN::deliverPreSynapticSpike_CPU<COBA_ANY_DELIVERY, true, false>, &SNN::deliverPreSynapticSpike_CPU<COBA_ANY_DELIVERY, true, true> } }
+	};
 
-		if (stdp_tDiff >= 0) {
-			if (groupConfigs[netId][post_grpId].WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) { // inhibitory syanpse
-				// Handle I-STDP curve
-				switch (groupConfigs[netId][post_grpId].WithISTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB < 25) { // LTD of inhibitory syanpse, which increase synapse weight
-						runtimeData[netId].wtChange[pos] -= STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_INB, groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB);
-					}
-					break;
-				case PULSE_CURVE: // pulse curve
-					if (stdp_tDiff <= groupConfigs[netId][post_grpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTP;
-					} else if (stdp_tDiff <= groupConfigs[netId][post_grpId].DELTA) { // LTD of inhibitory syanpse, which increase synapse weight
-						runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTD;
-					} else { /*do nothing*/ }
-					break;
-				default:
-					KERNEL_ERROR("Invalid I-STDP curve");
-					break;
-				}
-			} else if (groupConfigs[netId][post_grpId].WithESTDP && ((pre_type & TARGET_AMPA) || (pre_type & TARGET_NMDA))) { // excitatory synapse
-				// Handle E-STDP curve
-				switch (groupConfigs[netId][post_grpId].WithESTDPcurve) {
-				case EXP_CURVE: // exponential curve
-				case TIMING_BASED_CURVE: // sc curve
-					if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC < 25)
-						runtimeData[netId].wtChange[pos] += STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_EXC, groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC);
-					break;
-				default:
-					KERNEL_ERROR("Invalid E-STDP curve");
-					break;
-				}
-			} else { /*do nothing*/ }
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroupsAssigned; lGrpId++) {
+		unsigned int receptors = groupConfigs[netId][lGrpId].Type & (TARGET_AMPA | TARGET_NMDA | TARGET_GABAa | TARGET_GABAb);
+		int target = COBA_ANY_DELIVERY;
+		bool withRise = false;
+
+		if (!sim_with_conductances) {
+			target = CUBA_DELIVERY;
+		} else if (receptors == (TARGET_AMPA | TARGET_NMDA)) {
+			target = COBA_EXC_DELIVERY;
+			withRise = sim_with_NMDA_rise;
+		} else if (receptors == (TARGET_GABAa | TARGET_GABAb)) {
+			target = COBA_INH_DELIVERY;
+			withRise = sim_with_GABAb_rise;
 		}
-		assert(!((stdp_tDiff < 0) && (runtimeData[netId].lastSpikeTime[postNId] != MAX_SIMULATION_TIME)));
+
+		deliveryKernels_CPU[netId][lGrpId] = kernels[target][groupConfigs[netId][lGrpId].WithSTP ? 1 : 0][withRise ? 1 : 0];
 	}
 }
 
+// STDP calculation: the post-synaptic neuron fires before the arrival of a pre-synaptic spike
+void SNN::updateLTD(int postNId, short int post_grpId, unsigned int pos, unsigned int pre_type, int netId) {
+	int stdp_tDiff = (simTime - runtimeData[netId].lastSpikeTime[postNId]);
+
+	if (stdp_tDiff >= 0) {
+		if (groupConfigs[netId][post_grpId].WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) { // inhibitory syanpse
+			// Handle I-STDP curve
+			switch (groupConfigs[netId][post_grpId].WithISTDPcurve) {
+			case EXP_CURVE: // exponential curve
+				if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB < 25) { // LTD of inhibitory syanpse, which increase synapse weight
+					runtimeData[netId].wtChange[pos] -= STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_INB, groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB);
+				}
+				break;
+			case PULSE_CURVE: // pulse curve
+				if (stdp_tDiff <= groupConfigs[netId][post_grpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
+					runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTP;
+				} else if (stdp_tDiff <= groupConfigs[netId][post_grpId].DELTA) { // LTD of inhibitory syanpse, which increase synapse weight
+					runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTD;
+				} else { /*do nothing*/ }
+				break;
+			default:
+				KERNEL_ERROR("Invalid I-STDP curve");
+				break;
+			}
+		} else if (groupConfigs[netId][post_grpId].WithESTDP && ((pre_type & TARGET_AMPA) || (pre_type & TARGET_NMDA))) { // excitatory synapse
+			// Handle E-STDP curve
+			switch (groupConfigs[netId][post_grpId].WithESTDPcurve) {
+			case EXP_CURVE: // exponential curve
+			case TIMING_BASED_CURVE: // sc curve
+				if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC < 25)
+					runtimeData[netId].wtChange[pos] += STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_EXC, groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC);
+				break;
+			default:
+				KERNEL_ERROR("Invalid E-STDP curve");
+				break;
+			}
+		} else { /*do nothing*/ }
+	}
+	assert(!((stdp_tDiff < 0) && (runtimeData[netId].lastSpikeTime[postNId] != MAX_SIMULATION_TIME)));
+}
+
 // single integration step for voltage equation of 4-param Izhikevich
 inline
 float dvdtIzhikevich4(float volt, float recov, float totalCurrent, float timeStep = 1.0f) {
@@ -897,298 +1035,349 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	return compCurrent;
 }
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
-	void  SNN::globalStateUpdate_CPU(int netId) {
-#else // POSIX
-	void*  SNN::globalStateUpdate_CPU(int netId) {
-#endif
+	void SNN::globalStateUpdate_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	float timeStep = networkConfigs[netId].timeStep;
-
 	// loop that allows smaller integration time step for v's and u's
 	for (int j = 1; j <= networkConfigs[netId].simNumStepsPerMs; j++) {
 		bool lastIter = (j == networkConfigs[netId].simNumStepsPerMs);
-		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
-			if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
-				if (groupConfigs[netId][lGrpId].WithHomeostasis & (lastIter)) {
-					for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
-						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
-				}
-				continue;
-			}
 
-			for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
-				assert(lNId < networkConfigs[netId].numNReg);
-
-				// P7
-				// update conductances
-				float v = runtimeData[netId].voltage[lNId];
-				float v_next = runtimeData[netId].nextVoltage[lNId];
-				float u = runtimeData[netId].recovery[lNId];
-				float I_sum, NMDAtmp;
-				float gNMDA, gGABAb;
-
-				// pre-load izhikevich variables to avoid unnecessary memory accesses & unclutter the code.
-				float k = runtimeData[netId].Izh_k[lNId];
-				float vr = runtimeData[netId].Izh_vr[lNId];
-				float vt = runtimeData[netId].Izh_vt[lNId];
-				float inverse_C = 1.0f / runtimeData[netId].Izh_C[lNId];
-				float vpeak = runtimeData[netId].Izh_vpeak[lNId];
-				float a = runtimeData[netId].Izh_a[lNId];
-				float b = runtimeData[netId].Izh_b[lNId];
-
-				// pre-load LIF parameters
-				int lif_tau_m = runtimeData[netId].lif_tau_m[lNId];
-				int lif_tau_ref = runtimeData[netId].lif_tau_ref[lNId];
-				int lif_tau_ref_c = runtimeData[netId].lif_tau_ref_c[lNId];
-				float lif_vTh = runtimeData[netId].lif_vTh[lNId];
-				float lif_vReset = runtimeData[netId].lif_vReset[lNId];
-				float lif_gain = runtimeData[netId].lif_gain[lNId];
-				float lif_bias = runtimeData[netId].lif_bias[lNId];
-
-				float totalCurrent = runtimeData[netId].extCurrent[lNId];
+		updateNeuronStates_CPU(netId, 0, networkConfigs[netId].numNReg, lastIter);
 
-				if (networkConfigs[netId].sim_with_conductances) {
-					NMDAtmp = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
-					gNMDA = (networkConfigs[netId].sim_with_NMDA_rise) ? (runtimeData[netId].gNMDA_d[lNId] - runtimeData[netId].gNMDA_r[lNId]) : runtimeData[netId].gNMDA[lNId];
-					gGABAb = (networkConfigs[netId].sim_with_GABAb_rise) ? (runtimeData[netId].gGABAb_d[lNId] - runtimeData[netId].gGABAb_r[lNId]) : runtimeData[netId].gGABAb[lNId];
+		// Only after we are done computing nextVoltage for all neurons do we copy the new values to the voltage array.
+		// This is crucial for GPU (asynchronous kernel launch) and for the chunked multi-threaded version below.
+		memcpy(runtimeData[netId].voltage, runtimeData[netId].nextVoltage, sizeof(float)*networkConfigs[netId].numNReg);
+	}
 
-					I_sum = -(runtimeData[netId].gAMPA[lNId] * (v - 0.0f)
-						+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (v - 0.0f)
-						+ runtimeData[netId].gGABAa[lNId] * (v + 70.0f)
-						+ gGABAb * (v + 90.0f));
+	updateGroupStates_CPU(netId);
+}
 
-					totalCurrent += I_sum;
-				}
-				else {
-					totalCurrent += runtimeData[netId].current[lNId];
-				}
-				if (groupConfigs[netId][lGrpId].withCompartments) {
-					totalCurrent += getCompCurrent(netId, lGrpId, lNId);
-				}
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperGlobalStateUpdate_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> globalStateUpdate_CPU(args->netId);
+		return NULL;
+	}
 
-				switch (networkConfigs[netId].simIntegrationMethod) {
-				case FORWARD_EULER:
-					if (!groupConfigs[netId][lGrpId].withParamModel_9 && !groupConfigs[netId][lGrpId].isLIF)
-					{
-						// update vpos and upos for the current neuron
-						v_next = v + dvdtIzhikevich4(v, u, totalCurrent, timeStep);
-						if (v_next > 30.0f) {
-							v_next = 30.0f; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-					}
-					else if (!groupConfigs[netId][lGrpId].isLIF)
-					{
-						// update vpos and upos for the current neuron
-						v_next = v + dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
-						if (v_next > vpeak) {
-							v_next = vpeak; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-					}
+	// globalStateUpdate_CPU() for one of the workers that share a CPU runtime: every worker integrates its
+	// own range [startN, endN) of regular neurons, chunk 0 additionally updates the group states
+	void SNN::globalStateUpdateChunk_CPU(int netId, int chunkId, int numChunks, int startN, int endN) {
+		assert(runtimeData[netId].memType == CPU_MEM);
 
-					else{
-						if (lif_tau_ref_c > 0){
-							if(lastIter){
-								runtimeData[netId].lif_tau_ref_c[lNId] -= 1;
-								v_next = lif_vReset;
-							}
-						}
-						else{
-							if (v_next > lif_vTh) {
-								runtimeData[netId].curSpike[lNId] = true;
-								v_next = lif_vReset;
+		if (numChunks == 1) {
+			globalStateUpdate_CPU(netId);
+			return;
+		}
 
-								if(lastIter){
-                                        				runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref;
-								}
-								else{
-									runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref + 1;
-								}
-							}
-							else{
-								v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
-							}
-						}
-					}
+		// compartmental neurons read the voltage of their neighbors, which may belong to another chunk
+		bool syncVoltage = networkConfigs[netId].sim_with_compartments;
 
-					if (groupConfigs[netId][lGrpId].isLIF){
-						if (v_next < lif_vReset) v_next = lif_vReset;
-					}
-					else{
-						if (v_next < -90.0f) v_next = -90.0f;
+		for (int j = 1; j <= networkConfigs[netId].simNumStepsPerMs; j++) {
+			bool lastIter = (j == networkConfigs[netId].simNumStepsPerMs);
 
-						if (!groupConfigs[netId][lGrpId].withParamModel_9)
-						{
-							u += dudtIzhikevich4(v_next, u, a, b, timeStep);
-						}
-						else
-						{
-							u += dudtIzhikevich9(v_next, u, vr, a, b, timeStep);
-						}
-					}
-					break;
+			updateNeuronStates_CPU(netId, startN, endN, lastIter);
 
-				case RUNGE_KUTTA4:
+			if (syncVoltage)
+				pthread_barrier_wait(&cpuRuntimeBarrier[netId]);
 
-					if (!groupConfigs[netId][lGrpId].withParamModel_9 && !groupConfigs[netId][lGrpId].isLIF) {
-						// 4-param Izhikevich
-						float k1 = dvdtIzhikevich4(v, u, totalCurrent, timeStep);
-						float l1 = dudtIzhikevich4(v, u, a, b, timeStep);
+			memcpy(runtimeData[netId].voltage + startN, runtimeData[netId].nextVoltage + startN, sizeof(float) * (endN - startN));
 
-						float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent,
-							timeStep);
-						float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
+			if (syncVoltage && !lastIter)
+				pthread_barrier_wait(&cpuRuntimeBarrier[netId]);
+		}
 
-						float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent,
-							timeStep);
-						float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
+		if (chunkId == 0)
+			updateGroupStates_CPU(netId);
+	}
 
-						float k4 = dvdtIzhikevich4(v + k3, u + l3, totalCurrent, timeStep);
-						float l4 = dudtIzhikevich4(v + k3, u + l3, a, b, timeStep);
-						v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
-						if (v_next > 30.0f) {
-							v_next = 30.0f;
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-						if (v_next < -90.0f) v_next = -90.0f;
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperGlobalStateUpdateChunk_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> globalStateUpdateChunk_CPU(args->netId, args->chunkId, args->numChunks, args->startIdx, args->endIdx);
+		return NULL;
+	}
+#endif
 
-						u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
-					}
-					else if(!groupConfigs[netId][lGrpId].isLIF){
-						// 9-param Izhikevich
-						float k1 = dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent,
-							timeStep);
-						float l1 = dudtIzhikevich9(v, u, vr, a, b, timeStep);
+// integrates the regular neurons in [startN, endN) by one integration time step, writing nextVoltage
+void SNN::updateNeuronStates_CPU(int netId, int startN, int endN, bool lastIter) {
+	float timeStep = networkConfigs[netId].timeStep;
 
-						float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON)
+			continue;
 
-						float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
+		// intersect the group with the neuron range
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startN);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endN - 1);
 
-						float k4 = dvdtIzhikevich9(v + k3, u + l3, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l4 = dudtIzhikevich9(v + k3, u + l3, vr, a, b, timeStep);
+		// the vectorized kernels cover single-compartment Izhikevich and LIF groups, the scalar loop below does the rest
+		int lNId = lStartN;
+		if (simdWidth_CPU > 1 && !groupConfigs[netId][lGrpId].withCompartments
+			&& (networkConfigs[netId].simIntegrationMethod == FORWARD_EULER
+			|| networkConfigs[netId].simIntegrationMethod == RUNGE_KUTTA4))
+			lNId = updateNeuronStates_SIMD(netId, lGrpId, lStartN, lEndN, lastIter);
 
-						v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+		for (; lNId <= lEndN; lNId++) {
+			assert(lNId < networkConfigs[netId].numNReg);
 
-						if (v_next > vpeak) {
-							v_next = vpeak; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
+			// P7
+			// update conductances
+			float v = runtimeData[netId].voltage[lNId];
+			float v_next = runtimeData[netId].nextVoltage[lNId];
+			float u = runtimeData[netId].recovery[lNId];
+			float I_sum, NMDAtmp;
+			float gNMDA, gGABAb;
+
+			// pre-load izhikevich variables to avoid unnecessary memory accesses & unclutter the code.
+			float k = runtimeData[netId].Izh_k[lNId];
+			float vr = runtimeData[netId].Izh_vr[lNId];
+			float vt = runtimeData[netId].Izh_vt[lNId];
+			float inverse_C = 1.0f / runtimeData[netId].Izh_C[lNId];
+			float vpeak = runtimeData[netId].Izh_vpeak[lNId];
+			float a = runtimeData[netId].Izh_a[lNId];
+			float b = runtimeData[netId].Izh_b[lNId];
+
+			// pre-load LIF parameters
+			int lif_tau_m = runtimeData[netId].lif_tau_m[lNId];
+			int lif_tau_ref = runtimeData[netId].lif_tau_ref[lNId];
+			int lif_tau_ref_c = runtimeData[netId].lif_tau_ref_c[lNId];
+			float lif_vTh = runtimeData[netId].lif_vTh[lNId];
+			float lif_vReset = runtimeData[netId].lif_vReset[lNId];
+			float lif_gain = runtimeData[netId].lif_gain[lNId];
+			float lif_bias = runtimeData[netId].lif_bias[lNId];
+
+			float totalCurrent = runtimeData[netId].extCurrent[lNId];
+
+			if (networkConfigs[netId].sim_with_conductances) {
+				NMDAtmp = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
+				gNMDA = (networkConfigs[netId].sim_with_NMDA_rise) ? (runtimeData[netId].gNMDA_d[lNId] - runtimeData[netId].gNMDA_r[lNId]) : runtimeData[netId].gNMDA[lNId];
+				gGABAb = (networkConfigs[netId].sim_with_GABAb_rise) ? (runtimeData[netId].gGABAb_d[lNId] - runtimeData[netId].gGABAb_r[lNId]) : runtimeData[netId].gGABAb[lNId];
+
+				I_sum = -(runtimeData[netId].gAMPA[lNId] * (v - 0.0f)
+					+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (v - 0.0f)
+					+ runtimeData[netId].gGABAa[lNId] * (v + 70.0f)
+					+ gGABAb * (v + 90.0f));
+
+				totalCurrent += I_sum;
+			}
+			else {
+				totalCurrent += runtimeData[netId].current[lNId];
+			}
+			if (groupConfigs[netId][lGrpId].withCompartments) {
+				totalCurrent += getCompCurrent(netId, lGrpId, lNId);
+			}
 
-						if (v_next < -90.0f) v_next = -90.0f;
+			switch (networkConfigs[netId].simIntegrationMethod) {
+			case FORWARD_EULER:
+				if (!groupConfigs[netId][lGrpId].withParamModel_9 && !groupConfigs[netId][lGrpId].isLIF)
+				{
+					// update vpos and upos for the current neuron
+					v_next = v + dvdtIzhikevich4(v, u, totalCurrent, timeStep);
+					if (v_next > 30.0f) {
+						v_next = 30.0f; // break the loop but evaluate u[i]
+						runtimeData[netId].curSpike[lNId] = true;
+						v_next = runtimeData[netId].Izh_c[lNId];
+						u += runtimeData[netId].Izh_d[lNId];
+					}
+				}
+				else if (!groupConfigs[netId][lGrpId].isLIF)
+				{
+					// update vpos and upos for the current neuron
+					v_next = v + dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
+					if (v_next > vpeak) {
+						v_next = vpeak; // break the loop but evaluate u[i]
+						runtimeData[netId].curSpike[lNId] = true;
+						v_next = runtimeData[netId].Izh_c[lNId];
+						u += runtimeData[netId].Izh_d[lNId];
+					}
+				}
 
-						u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+				else{
+					if (lif_tau_ref_c > 0){
+						if(lastIter){
+							runtimeData[netId].lif_tau_ref_c[lNId] -= 1;
+							v_next = lif_vReset;
+						}
 					}
 					else{
-						//LIF integration is always FORWARD_EULER
-						if (lif_tau_ref_c > 0){
-							if(lastIter){
-								runtimeData[netId].lif_tau_ref_c[lNId] -= 1;
-								v_next = lif_vReset;
-							}
-						}
-						else{
-							if (v_next > lif_vTh) {
-								runtimeData[netId].curSpike[lNId] = true;
-								v_next = lif_vReset;
+						if (v_next > lif_vTh) {
+							runtimeData[netId].curSpike[lNId] = true;
+							v_next = lif_vReset;
 
-								if(lastIter){
+							if(lastIter){
                                         				runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref;
-								}
-								else{
-									runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref + 1;
-								}
 							}
 							else{
-								v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
+								runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref + 1;
 							}
 						}
-						if (v_next < lif_vReset) v_next = lif_vReset;
+						else{
+							v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
+						}
 					}
-					break;
-				case UNKNOWN_INTEGRATION:
-				default:
-					exitSimulation(1);
 				}
 
-				runtimeData[netId].nextVoltage[lNId] = v_next;
-				runtimeData[netId].recovery[lNId] = u;
+				if (groupConfigs[netId][lGrpId].isLIF){
+					if (v_next < lif_vReset) v_next = lif_vReset;
+				}
+				else{
+					if (v_next < -90.0f) v_next = -90.0f;
 
-				// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
-				if (lastIter)
-				{
-					if (networkConfigs[netId].sim_with_conductances) {
-						runtimeData[netId].current[lNId] = I_sum;
+					if (!groupConfigs[netId][lGrpId].withParamModel_9)
+					{
+						u += dudtIzhikevich4(v_next, u, a, b, timeStep);
 					}
-					else {
-						// current must be reset here for CUBA and not STPUpdateAndDecayConductances
-						runtimeData[netId].current[lNId] = 0.0f;
+					else
+					{
+						u += dudtIzhikevich9(v_next, u, vr, a, b, timeStep);
+					}
+				}
+				break;
+
+			case RUNGE_KUTTA4:
+
+				if (!groupConfigs[netId][lGrpId].withParamModel_9 && !groupConfigs[netId][lGrpId].isLIF) {
+					// 4-param Izhikevich
+					float k1 = dvdtIzhikevich4(v, u, totalCurrent, timeStep);
+					float l1 = dudtIzhikevich4(v, u, a, b, timeStep);
+
+					float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent,
+						timeStep);
+					float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
+
+					float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent,
+						timeStep);
+					float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
+
+					float k4 = dvdtIzhikevich4(v + k3, u + l3, totalCurrent, timeStep);
+					float l4 = dudtIzhikevich4(v + k3, u + l3, a, b, timeStep);
+					v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+					if (v_next > 30.0f) {
+						v_next = 30.0f;
+						runtimeData[netId].curSpike[lNId] = true;
+						v_next = runtimeData[netId].Izh_c[lNId];
+						u += runtimeData[netId].Izh_d[lNId];
 					}
+					if (v_next < -90.0f) v_next = -90.0f;
 
-					// P8
-					// update average firing rate for homeostasis
-					if (groupConfigs[netId][lGrpId].WithHomeostasis)
-						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
+					u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+				}
+				else if(!groupConfigs[netId][lGrpId].isLIF){
+					// 9-param Izhikevich
+					float k1 = dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent,
+						timeStep);
+					float l1 = dudtIzhikevich9(v, u, vr, a, b, timeStep);
+
+					float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt,
+						totalCurrent, timeStep);
+					float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
+
+					float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt,
+						totalCurrent, timeStep);
+					float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
+
+					float k4 = dvdtIzhikevich9(v + k3, u + l3, inverse_C, k, vr, vt,
+						totalCurrent, timeStep);
+					float l4 = dudtIzhikevich9(v + k3, u + l3, vr, a, b, timeStep);
+
+					v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+
+					if (v_next > vpeak) {
+						v_next = vpeak; // break the loop but evaluate u[i]
+						runtimeData[netId].curSpike[lNId] = true;
+						v_next = runtimeData[netId].Izh_c[lNId];
+						u += runtimeData[netId].Izh_d[lNId];
+					}
+
+					if (v_next < -90.0f) v_next = -90.0f;
+
+					u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+				}
+				else{
+					//LIF integration is always FORWARD_EULER
+					if (lif_tau_ref_c > 0){
+						if(lastIter){
+							runtimeData[netId].lif_tau_ref_c[lNId] -= 1;
+							v_next = lif_vReset;
+						}
+					}
+					else{
+						if (v_next > lif_vTh) {
+							runtimeData[netId].curSpike[lNId] = true;
+							v_next = lif_vReset;
 
-					// log i value if any active neuron monitor is presented
-					if (networkConfigs[netId].sim_with_nm && lNId - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
-						int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
-						runtimeData[netId].nIBuffer[idxBase + lNId - groupConfigs[netId][lGrpId].lStartN] = totalCurrent;
+							if(lastIter){
+                                        				runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref;
+							}
+							else{
+								runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref + 1;
+							}
+						}
+						else{
+							v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
+						}
 					}
+					if (v_next < lif_vReset) v_next = lif_vReset;
 				}
-			} // end StartN...EndN
+				break;
+			case UNKNOWN_INTEGRATION:
+			default:
+				exitSimulation(1);
+			}
+
+			runtimeData[netId].nextVoltage[lNId] = v_next;
+			runtimeData[netId].recovery[lNId] = u;
 
-			  // decay dopamine concentration once per globalStateUpdate_CPU call
+			// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
 			if (lastIter)
 			{
-				// P9
-				// decay dopamine concentration
-				if ((groupConfigs[netId][lGrpId].WithESTDPtype == DA_MOD || groupConfigs[netId][lGrpId].WithISTDP == DA_MOD) && runtimeData[netId].grpDA[lGrpId] > groupConfigs[netId][lGrpId].baseDP) {
-					runtimeData[netId].grpDA[lGrpId] *= groupConfigs[netId][lGrpId].decayDP;
+				if (networkConfigs[netId].sim_with_conductances) {
+					runtimeData[netId].current[lNId] = I_sum;
+				}
+				else {
+					// current must be reset here for CUBA and not STPUpdateAndDecayConductances
+					runtimeData[netId].current[lNId] = 0.0f;
 				}
-				runtimeData[netId].grpDABuffer[lGrpId * 1000 + simTimeMs] = runtimeData[netId].grpDA[lGrpId];
-			}
-		} // end numGroups
-
-		  // Only after we are done computing nextVoltage for all neurons do we copy the new values to the voltage array.
-		  // This is crucial for GPU (asynchronous kernel launch) and in the future for a multi-threaded CARLsim version.
 
-		memcpy(runtimeData[netId].voltage, runtimeData[netId].nextVoltage, sizeof(float)*networkConfigs[netId].numNReg);
+				// P8
+				// update average firing rate for homeostasis
+				if (groupConfigs[netId][lGrpId].WithHomeostasis)
+					runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
 
-	} // end simNumStepsPerMs loop
+				// log i value if any active neuron monitor is presented
+				if (networkConfigs[netId].sim_with_nm && lNId - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
+					int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
+					runtimeData[netId].nIBuffer[idxBase + lNId - groupConfigs[netId][lGrpId].lStartN] = totalCurrent;
+				}
+			}
+		} // end StartN...EndN
+	} // end numGroups
 }
 
-#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-	// Static multithreading subroutine method - helper for the above method
-	void* SNN::helperGlobalStateUpdate_CPU(void* arguments) {
-		ThreadStruct* args = (ThreadStruct*) arguments;
-		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> globalStateUpdate_CPU(args->netId);
-		pthread_exit(0);
+// updates the per-group states once per globalStateUpdate_CPU call, after the last integration step
+void SNN::updateGroupStates_CPU(int netId) {
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
+			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+				for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
+					runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
+			}
+			continue;
+		}
+
+		// P9
+		// decay dopamine concentration
+		if ((groupConfigs[netId][lGrpId].WithESTDPtype == DA_MOD || groupConfigs[netId][lGrpId].WithISTDP == DA_MOD) && runtimeData[netId].grpDA[lGrpId] > groupConfigs[netId][lGrpId].baseDP) {
+			runtimeData[netId].grpDA[lGrpId] *= groupConfigs[netId][lGrpId].decayDP;
+		}
+		runtimeData[netId].grpDABuffer[lGrpId * 1000 + simTimeMs] = runtimeData[netId].grpDA[lGrpId];
 	}
-#endif
+}
 
 // This function updates the synaptic weights from its derivatives..
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::updateWeights_CPU(int netId) {
-#else // POSIX
-	void* SNN::updateWeights_CPU(int netId) {
-#endif
 	// at this point we have already checked for sim_in_testing and sim_with_fixedwts
 	assert(sim_in_testing==false);
 	assert(sim_with_fixedwts==false);
@@ -1298,7 +1487,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> updateWeights_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -1306,11 +1495,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
  * \brief This function is called every second by SNN::runNetwork(). It updates the firingTableD1(D2) and
  * timeTableD1(D2) by removing older firing information.
  */
- #if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
-	void SNN::shiftSpikeTables_CPU(int netId) {
-#else // POSIX
-	void* SNN::shiftSpikeTables_CPU(int netId) {
-#endif
+ 	void SNN::shiftSpikeTables_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// Read the neuron ids that fired in the last glbNetworkConfig.maxDelay seconds
 	// and put it to the beginning of the firing table...
@@ -1342,7 +1527,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> shiftSpikeTables_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -1359,7 +1544,12 @@ void SNN::allocateSNN_CPU(int netId) {
 	//previous=avail;
 
 	// allocate SNN::runtimeData[0].randNum for random number generators
+	// zero-rate neurons never draw a random number, so start from a value that cannot trigger a spike
 	runtimeData[netId].randNum = new float[networkConfigs[netId].numNPois];
+	memset(runtimeData[netId].randNum, 0, sizeof(float) * networkConfigs[netId].numNPois);
+
+	// no group is event-driven until its rates are assigned
+	poissonWheels_[netId].reset(networkConfigs[netId].numGroups);
 	//KERNEL_INFO("Random Gen:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB",(float)(previous-avail)/toMB, (float)((total-avail)/toMB),(float)(avail/toMB));
 	//previous=avail;
 
@@ -1450,6 +1640,9 @@ void SNN::allocateSNN_CPU(int netId) {
 		KERNEL_DEBUG("\tspikeGen: %s", groupConfigs[netId][lGrpId].isSpikeGenFunc? "is Set" : "is not set ");
 	}
 
+	// specialize spike delivery per pre-synaptic group
+	assignDeliveryKernels_CPU(netId);
+
 	// allocation of CPU runtime data is done
 	runtimeData[netId].allocated = true;
 }
@@ -2402,11 +2595,7 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 }
 
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::assignPoissonFiringRate_CPU(int netId) {
-#else // POSIX
-	void* SNN::assignPoissonFiringRate_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
@@ -2425,6 +2614,25 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 			// rates allocated on CPU
 			memcpy(&runtimeData[netId].poissonFireRate[lNId - networkConfigs[netId].numNReg], rate->getRatePtrCPU(),
 					sizeof(float) * rate->getNumNeurons());
+
+			// the schedule of an event-driven group is rebuilt from its new rates (Poisson processes are memoryless),
+			// the schedule of the other groups is kept
+			bool eventDriven = groupConfigMDMap[gGrpId].isPoissonEventDriven;
+			int refPeriod = (int)groupConfigMDMap[gGrpId].refractPeriod;
+			if (groupConfigMDMap[gGrpId].isPoissonRateUpdated)
+				poissonWheels_[netId].clearEvents(groupConfigs[netId][lGrpId].lStartN, groupConfigs[netId][lGrpId].lEndN);
+			poissonWheels_[netId].setGroup(lGrpId, eventDriven, refPeriod);
+
+			if (eventDriven && groupConfigMDMap[gGrpId].isPoissonRateUpdated) {
+				// the next spike can happen in the current step, unless the neuron is still refractory
+				for (; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
+					int tBase = simTime - 1;
+					int lastSpikeTime = runtimeData[netId].lastSpikeTime[lNId];
+					if (lastSpikeTime <= simTime && lastSpikeTime + refPeriod - 1 > tBase)
+						tBase = lastSpikeTime + refPeriod - 1;
+					schedulePoissonSpike_CPU(lNId, lGrpId, netId, tBase);
+				}
+			}
 		}
 	}
 }
@@ -2435,7 +2643,7 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> assignPoissonFiringRate_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -2531,11 +2739,7 @@ void SNN::copySpikeTables(int netId) {
 	memcpy(managerRuntimeData.timeTableD1, runtimeData[netId].timeTableD1, sizeof(int) * (1000 + networkConfigs[netId].maxDelay + 1));
 }
 
-#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::deleteRuntimeData_CPU(int netId) {
-#else // POSIX
-	void* SNN::deleteRuntimeData_CPU(int netId) {
-#endif
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// free all pointers
 	delete [] runtimeData[netId].voltage;
@@ -2661,6 +2865,163 @@ void SNN::copySpikeTables(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> deleteRuntimeData_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
+	}
+#endif
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	// spawns the workers of every CPU runtime and pins them to the cores round-robin, the same way the
+	// per-phase threads used to be pinned. The cores are shared evenly among the CPU runtimes, and each
+	// worker of a runtime owns a contiguous range of its regular neurons (see MIN_NEURONS_PER_CPU_THREAD).
+	// setNumCPUCores overrides the number of cores, setNumCPUThreads the number of workers per runtime.
+	void SNN::startCPUWorkerPool() {
+		assert(!cpuWorkerPoolRunning);
+
+		int numCPURuntimes = 0;
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++)
+			if (!groupPartitionLists[netId].empty())
+				numCPURuntimes++;
+
+		if (numCPURuntimes == 0)
+			return;
+
+		int numAvailableCores = (numCPUCoresUser > 0) ? numCPUCoresUser : (int)NUM_CPU_CORES;
+		int coresPerRuntime = std::max(1, numAvailableCores / numCPURuntimes);
+
+		cpuWorkerArgs.clear();
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+			numCPUThreadsPerRuntime[netId] = 0;
+			if (groupPartitionLists[netId].empty())
+				continue;
+
+			int numNReg = networkConfigs[netId].numNReg;
+			int numChunks = std::max(1, std::min(coresPerRuntime, numNReg / MIN_NEURONS_PER_CPU_THREAD));
+			if (numCPUThreadsUser > 0)
+				numChunks = std::max(1, std::min(numCPUThreadsUser, numNReg));
+			numCPUThreadsPerRuntime[netId] = numChunks;
+			if (numChunks > 1)
+				pthread_barrier_init(&cpuRuntimeBarrier[netId], NULL, numChunks);
+
+			for (int chunkId = 0; chunkId < numChunks; chunkId++) {
+				ThreadStruct args;
+				args.snn_pointer = this;
+				args.netId = netId;
+				args.lGrpId = 0;
+				args.startIdx = (int)((long long)numNReg * chunkId / numChunks);
+				args.endIdx = (int)((long long)numNReg * (chunkId + 1) / numChunks);
+				args.GtoLOffset = 0;
+				args.chunkId = chunkId;
+				args.numChunks = numChunks;
+				cpuWorkerArgs.push_back(args);
+			}
+
+			if (numChunks > 1)
+				KERNEL_INFO("CPU %d Runtime: %d neurons are integrated by %d threads", netId - CPU_RUNTIME_BASE, numNReg, numChunks);
+		}
+
+		numCPUWorkers = cpuWorkerArgs.size();
+		cpuWorkerThreads.resize(numCPUWorkers);
+
+		pthread_mutex_init(&cpuDAMutex, NULL);
+
+		// the manager thread takes part in both barriers
+		pthread_barrier_init(&cpuWorkerBarrierStart, NULL, numCPUWorkers + 1);
+		pthread_barrier_init(&cpuWorkerBarrierDone, NULL, numCPUWorkers + 1);
+		cpuWorkerJob = NULL;
+		cpuWorkerJobChunked = false;
+
+		cpu_set_t cpus;
+		for (int i = 0; i < numCPUWorkers; i++) {
+			pthread_attr_t attr;
+			pthread_attr_init(&attr);
+			CPU_ZERO(&cpus);
+			CPU_SET(i%NUM_CPU_CORES, &cpus);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+
+			int err = pthread_create(&cpuWorkerThreads[i], &attr, &SNN::helperCPUWorker, (void*)&cpuWorkerArgs[i]);
+			pthread_attr_destroy(&attr);
+			if (err != 0) {
+				KERNEL_ERROR("Could not create CPU worker %d (error %d)", i, err);
+				exitSimulation(1);
+			}
+		}
+
+		cpuWorkerPoolRunning = true;
+		KERNEL_DEBUG("Started %d CPU worker(s)", numCPUWorkers);
+	}
+
+	// releases the workers with an empty job so that they leave their loop, then joins them
+	void SNN::stopCPUWorkerPool() {
+		if (!cpuWorkerPoolRunning)
+			return;
+
+		cpuWorkerJob = NULL;
+		pthread_barrier_wait(&cpuWorkerBarrierStart);
+		for (int i = 0; i < numCPUWorkers; i++)
+			pthread_join(cpuWorkerThreads[i], NULL);
+
+		pthread_barrier_destroy(&cpuWorkerBarrierStart);
+		pthread_barrier_destroy(&cpuWorkerBarrierDone);
+		pthread_mutex_destroy(&cpuDAMutex);
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+			if (numCPUThreadsPerRuntime[netId] > 1)
+				pthread_barrier_destroy(&cpuRuntimeBarrier[netId]);
+			numCPUThreadsPerRuntime[netId] = 0;
+		}
+
+		cpuWorkerThreads.clear();
+		cpuWorkerArgs.clear();
+		numCPUWorkers = 0;
+		cpuWorkerPoolRunning = false;
+	}
+
+	// runs helper on every CPU runtime and returns once all of them are done. A chunked helper is run by
+	// all workers of a runtime, any other helper only by the first one.
+	void SNN::runCPUWorkerPool(void* (*helper)(void*), int lGrpId, bool chunked) {
+		if (!cpuWorkerPoolRunning) {
+			// no pool yet (e.g., before setupNetwork()) or no longer (e.g., during tear-down): run on the calling thread
+			for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+				if (!groupPartitionLists[netId].empty()) {
+					ThreadStruct args;
+					args.snn_pointer = this;
+					args.netId = netId;
+					args.lGrpId = lGrpId;
+					args.startIdx = 0;
+					args.endIdx = chunked ? networkConfigs[netId].numNReg : 0;
+					args.GtoLOffset = 0;
+					args.chunkId = 0;
+					args.numChunks = 1;
+					helper((void*)&args);
+				}
+			}
+			return;
+		}
+
+		for (int i = 0; i < numCPUWorkers; i++)
+			cpuWorkerArgs[i].lGrpId = lGrpId;
+		cpuWorkerJob = helper;
+		cpuWorkerJobChunked = chunked;
+
+		// the barriers order the writes above before the workers read them, and the workers' results
+		// before the manager continues
+		pthread_barrier_wait(&cpuWorkerBarrierStart);
+		pthread_barrier_wait(&cpuWorkerBarrierDone);
+	}
+
+	// Static multithreading subroutine method - main loop of a pooled CPU worker
+	void* SNN::helperCPUWorker(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		SNN* snn = (SNN *)args->snn_pointer;
+
+		while (true) {
+			pthread_barrier_wait(&snn->cpuWorkerBarrierStart);
+			if (snn->cpuWorkerJob == NULL)
+				break;
+			if (snn->cpuWorkerJobChunked || args->chunkId == 0)
+				snn->cpuWorkerJob(arguments);
+			pthread_barrier_wait(&snn->cpuWorkerBarrierDone);
+		}
+
+		return NULL;
 	}
 #endif
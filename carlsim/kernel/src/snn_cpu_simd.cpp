@@ -0,0 +1,366 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim v3.0: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+// Vectorized (AVX2 / AVX-512) integration of Izhikevich and LIF neurons for the CPU runtime.
+//
+// The kernels below evaluate exactly the same floating-point operations, in the same order, as the scalar
+// forward-Euler and Runge-Kutta paths in SNN::updateNeuronStates_CPU(). This file is compiled without floating-point
+// contraction (no FMA, see CMakeLists.txt), so every lane computes the same IEEE result as the scalar code: the
+// documented tolerance between the scalar and the vectorized path is zero. Multi-compartment groups (whose current
+// depends on the voltages of neighboring compartments) and the remainder of a group that does not fill a vector use
+// the scalar path. CARLsim::setCPUVectorization(false) forces the scalar path everywhere.
+
+#include <snn.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(WIN32) && !defined(WIN64)
+	#define CPU_SIMD_X86
+#endif
+
+#ifdef CPU_SIMD_X86
+
+// 8 lanes for AVX2, 16 lanes for AVX-512
+struct VecAVX2 {
+	typedef float V __attribute__((vector_size(32)));
+	typedef float VU __attribute__((vector_size(32), aligned(4))); // unaligned access
+	typedef int VI __attribute__((vector_size(32)));
+	typedef int VIU __attribute__((vector_size(32), aligned(4)));
+	enum { W = 8 };
+};
+
+struct VecAVX512 {
+	typedef float V __attribute__((vector_size(64)));
+	typedef float VU __attribute__((vector_size(64), aligned(4))); // unaligned access
+	typedef int VI __attribute__((vector_size(64)));
+	typedef int VIU __attribute__((vector_size(64), aligned(4)));
+	enum { W = 16 };
+};
+
+#define LOADV(ptr) (*(const typename Vec::VU*)(ptr))
+#define STOREV(ptr, val) (*(typename Vec::VU*)(ptr) = (val))
+#define LOADVI(ptr) (*(const typename Vec::VIU*)(ptr))
+#define STOREVI(ptr, val) (*(typename Vec::VIU*)(ptr) = (val))
+
+// vector versions of dvdtIzhikevich4, dudtIzhikevich4, dvdtIzhikevich9, and dudtIzhikevich9
+#define DVDT_IZH4(v, u, totalCurrent, timeStep) \
+	(((0.04f * (v) + 5.0f) * (v) + 140.0f - (u) + (totalCurrent)) * (timeStep))
+#define DUDT_IZH4(v, u, a, b, timeStep) \
+	((a) * ((b) * (v) - (u)) * (timeStep))
+#define DVDT_IZH9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep) \
+	(((k) * ((v) - (vr)) * ((v) - (vt)) - (u) + (totalCurrent)) * (inverse_C) * (timeStep))
+#define DUDT_IZH9(v, u, vr, a, b, timeStep) \
+	((a) * ((b) * ((v) - (vr)) - (u)) * (timeStep))
+
+// computes the input current of W neurons (I_sum is the conductance-based part, zero in CUBA mode)
+template<typename Vec>
+static inline __attribute__((always_inline))
+void inputCurrent(RuntimeData& rtd, const NetworkConfigRT& net, int lNId, const typename Vec::V& v,
+	typename Vec::V& I_sum, typename Vec::V& totalCurrent)
+{
+	typedef typename Vec::V V;
+
+	totalCurrent = LOADV(rtd.extCurrent + lNId);
+	if (net.sim_with_conductances) {
+		V NMDAtmp = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
+		V gNMDA = net.sim_with_NMDA_rise ? (LOADV(rtd.gNMDA_d + lNId) - LOADV(rtd.gNMDA_r + lNId)) : LOADV(rtd.gNMDA + lNId);
+		V gGABAb = net.sim_with_GABAb_rise ? (LOADV(rtd.gGABAb_d + lNId) - LOADV(rtd.gGABAb_r + lNId)) : LOADV(rtd.gGABAb + lNId);
+
+		I_sum = -(LOADV(rtd.gAMPA + lNId) * (v - 0.0f)
+			+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (v - 0.0f)
+			+ LOADV(rtd.gGABAa + lNId) * (v + 70.0f)
+			+ gGABAb * (v + 90.0f));
+
+		totalCurrent += I_sum;
+	} else {
+		totalCurrent += LOADV(rtd.current + lNId);
+	}
+}
+
+// stores the state of W neurons at the end of an integration step
+template<typename Vec>
+static inline __attribute__((always_inline))
+void storeState(RuntimeData& rtd, const GroupConfigRT& grp, const NetworkConfigRT& net, int lGrpId, int lNId,
+	const typename Vec::V& v_next, const typename Vec::V& u, const typename Vec::VI& spiked,
+	const typename Vec::V& I_sum, const typename Vec::V& totalCurrent, bool lastIter, int simTimeMs)
+{
+	typedef typename Vec::V V;
+	const int W = Vec::W;
+	const V zero = {};
+
+	STOREV(rtd.nextVoltage + lNId, v_next);
+	STOREV(rtd.recovery + lNId, u);
+
+	for (int i = 0; i < W; i++) {
+		if (spiked[i])
+			rtd.curSpike[lNId + i] = true;
+	}
+
+	// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
+	if (lastIter) {
+		// current must be reset here for CUBA and not STPUpdateAndDecayConductances
+		STOREV(rtd.current + lNId, net.sim_with_conductances ? I_sum : zero);
+
+		// P8
+		if (grp.WithHomeostasis)
+			STOREV(rtd.avgFiring + lNId, LOADV(rtd.avgFiring + lNId) * (grp.avgTimeScale_decay - zero));
+
+		// log i value if any active neuron monitor is presented
+		if (net.sim_with_nm) {
+			int idxBase = net.numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
+			for (int i = 0; i < W; i++) {
+				if (lNId + i - grp.lStartN < MAX_NEURON_MON_GRP_SZIE)
+					rtd.nIBuffer[idxBase + lNId + i - grp.lStartN] = totalCurrent[i];
+			}
+		}
+	}
+}
+
+// integrates the neurons [startN, endN] of an Izhikevich group by one forward-Euler or Runge-Kutta step, W neurons
+// at a time, and returns the id of the first neuron that is left to the scalar path
+template<typename Vec, bool izh9, bool rk4>
+static inline __attribute__((always_inline))
+int integrateIzhikevich(RuntimeData& rtd, const GroupConfigRT& grp, const NetworkConfigRT& net, int lGrpId,
+	int startN, int endN, bool lastIter, int simTimeMs)
+{
+	typedef typename Vec::V V;
+	typedef typename Vec::VI VI;
+	const int W = Vec::W;
+
+	// broadcasts keep the sign of zero (s - 0 == s for s = +0 and s = -0)
+	const V zero = {};
+	const V timeStep = net.timeStep - zero;
+	const V vSpike = 30.0f - zero;
+	const V vMin = -90.0f - zero;
+
+	int lNId = startN;
+	for (; lNId + W - 1 <= endN; lNId += W) {
+		V v = LOADV(rtd.voltage + lNId);
+		V u = LOADV(rtd.recovery + lNId);
+		V I_sum = zero;
+		V totalCurrent;
+		inputCurrent<Vec>(rtd, net, lNId, v, I_sum, totalCurrent);
+
+		V a = LOADV(rtd.Izh_a + lNId);
+		V b = LOADV(rtd.Izh_b + lNId);
+		V k, vr, vt, inverse_C, vThresh;
+		if (izh9) {
+			k = LOADV(rtd.Izh_k + lNId);
+			vr = LOADV(rtd.Izh_vr + lNId);
+			vt = LOADV(rtd.Izh_vt + lNId);
+			inverse_C = 1.0f / LOADV(rtd.Izh_C + lNId);
+			vThresh = LOADV(rtd.Izh_vpeak + lNId);
+		} else {
+			vThresh = vSpike;
+		}
+
+		V v_next, uStep;
+		if (rk4) {
+			V k1, l1, k2, l2, k3, l3, k4, l4;
+			if (izh9) {
+				k1 = DVDT_IZH9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
+				l1 = DUDT_IZH9(v, u, vr, a, b, timeStep);
+				k2 = DVDT_IZH9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt, totalCurrent, timeStep);
+				l2 = DUDT_IZH9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
+				k3 = DVDT_IZH9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt, totalCurrent, timeStep);
+				l3 = DUDT_IZH9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
+				k4 = DVDT_IZH9(v + k3, u + l3, inverse_C, k, vr, vt, totalCurrent, timeStep);
+				l4 = DUDT_IZH9(v + k3, u + l3, vr, a, b, timeStep);
+			} else {
+				k1 = DVDT_IZH4(v, u, totalCurrent, timeStep);
+				l1 = DUDT_IZH4(v, u, a, b, timeStep);
+				k2 = DVDT_IZH4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent, timeStep);
+				l2 = DUDT_IZH4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
+				k3 = DVDT_IZH4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent, timeStep);
+				l3 = DUDT_IZH4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
+				k4 = DVDT_IZH4(v + k3, u + l3, totalCurrent, timeStep);
+				l4 = DUDT_IZH4(v + k3, u + l3, a, b, timeStep);
+			}
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			uStep = (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		} else {
+			v_next = v + (izh9 ? DVDT_IZH9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep)
+				: DVDT_IZH4(v, u, totalCurrent, timeStep));
+		}
+
+		// masked spike detection and reset
+		VI spiked = v_next > vThresh;
+		v_next = spiked ? LOADV(rtd.Izh_c + lNId) : v_next;
+		u = spiked ? u + LOADV(rtd.Izh_d + lNId) : u;
+		v_next = (v_next < vMin) ? vMin : v_next;
+
+		// forward Euler evaluates the recovery at the new voltage, Runge-Kutta adds the step computed above
+		if (rk4)
+			u += uStep;
+		else
+			u += izh9 ? DUDT_IZH9(v_next, u, vr, a, b, timeStep) : DUDT_IZH4(v_next, u, a, b, timeStep);
+
+		storeState<Vec>(rtd, grp, net, lGrpId, lNId, v_next, u, spiked, I_sum, totalCurrent, lastIter, simTimeMs);
+	}
+
+	return lNId;
+}
+
+// integrates the neurons [startN, endN] of a LIF group by one forward-Euler step (for both integration methods),
+// W neurons at a time, and returns the id of the first neuron that is left to the scalar path
+template<typename Vec>
+static inline __attribute__((always_inline))
+int integrateLIF(RuntimeData& rtd, const GroupConfigRT& grp, const NetworkConfigRT& net, int lGrpId,
+	int startN, int endN, bool lastIter, int simTimeMs)
+{
+	typedef typename Vec::V V;
+	typedef typename Vec::VI VI;
+	const int W = Vec::W;
+
+	const V zero = {};
+	const VI zeroI = {};
+	const V timeStep = net.timeStep - zero;
+
+	int lNId = startN;
+	for (; lNId + W - 1 <= endN; lNId += W) {
+		V v = LOADV(rtd.voltage + lNId);
+		V v_next = LOADV(rtd.nextVoltage + lNId);
+		V u = LOADV(rtd.recovery + lNId);
+		V I_sum = zero;
+		V totalCurrent;
+		inputCurrent<Vec>(rtd, net, lNId, v, I_sum, totalCurrent);
+
+		V vTh = LOADV(rtd.lif_vTh + lNId);
+		V vReset = LOADV(rtd.lif_vReset + lNId);
+		V tau_m = __builtin_convertvector(LOADVI(rtd.lif_tau_m + lNId), V);
+		VI tau_ref = LOADVI(rtd.lif_tau_ref + lNId);
+		VI tau_ref_c = LOADVI(rtd.lif_tau_ref_c + lNId);
+
+		// refractory neurons are clamped to vReset (in the last step only), the others either spike or integrate
+		VI refractory = tau_ref_c > zeroI;
+		VI spiked = ~refractory & (v_next > vTh);
+		V v_int = v + ((vReset - v + ((totalCurrent * LOADV(rtd.lif_gain + lNId)) + LOADV(rtd.lif_bias + lNId)))
+			/ tau_m) * timeStep; // dvdtLIF
+
+		V v_refr = lastIter ? vReset : v_next;
+		v_next = refractory ? v_refr : (spiked ? vReset : v_int);
+		v_next = (v_next < vReset) ? vReset : v_next;
+
+		if (lastIter)
+			tau_ref_c = refractory ? tau_ref_c - 1 : tau_ref_c;
+		tau_ref_c = spiked ? (lastIter ? tau_ref : tau_ref + 1) : tau_ref_c;
+		STOREVI(rtd.lif_tau_ref_c + lNId, tau_ref_c);
+
+		storeState<Vec>(rtd, grp, net, lGrpId, lNId, v_next, u, spiked, I_sum, totalCurrent, lastIter, simTimeMs);
+	}
+
+	return lNId;
+}
+
+// dispatches a group to the kernel of its neuron model and integration method
+template<typename Vec>
+static inline __attribute__((always_inline))
+int integrateGroup(RuntimeData& rtd, const GroupConfigRT& grp, const NetworkConfigRT& net, int lGrpId,
+	int startN, int endN, bool lastIter, int simTimeMs)
+{
+	if (grp.isLIF)
+		return integrateLIF<Vec>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+
+	if (net.simIntegrationMethod == RUNGE_KUTTA4) {
+		if (grp.withParamModel_9)
+			return integrateIzhikevich<Vec, true, true>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+		else
+			return integrateIzhikevich<Vec, false, true>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+	} else {
+		if (grp.withParamModel_9)
+			return integrateIzhikevich<Vec, true, false>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+		else
+			return integrateIzhikevich<Vec, false, false>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+	}
+}
+
+__attribute__((target("avx2")))
+static int integrateGroupAVX2(RuntimeData& rtd, const GroupConfigRT& grp, const NetworkConfigRT& net, int lGrpId,
+	int startN, int endN, bool lastIter, int simTimeMs)
+{
+	return integrateGroup<VecAVX2>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+}
+
+__attribute__((target("avx512f")))
+static int integrateGroupAVX512(RuntimeData& rtd, const GroupConfigRT& grp, const NetworkConfigRT& net, int lGrpId,
+	int startN, int endN, bool lastIter, int simTimeMs)
+{
+	return integrateGroup<VecAVX512>(rtd, grp, net, lGrpId, startN, endN, lastIter, simTimeMs);
+}
+
+#endif // CPU_SIMD_X86
+
+int SNN::detectSIMDWidth_CPU() {
+#ifdef CPU_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return 16;
+	if (__builtin_cpu_supports("avx2"))
+		return 8;
+#endif
+	return 1;
+}
+
+int SNN::updateNeuronStates_SIMD(int netId, int lGrpId, int startN, int endN, bool lastIter) {
+	assert(!groupConfigs[netId][lGrpId].withCompartments);
+	assert(networkConfigs[netId].simIntegrationMethod == FORWARD_EULER
+		|| networkConfigs[netId].simIntegrationMethod == RUNGE_KUTTA4);
+
+#ifdef CPU_SIMD_X86
+	switch (simdWidth_CPU) {
+	case 16:
+		return integrateGroupAVX512(runtimeData[netId], groupConfigs[netId][lGrpId], networkConfigs[netId], lGrpId,
+			startN, endN, lastIter, simTimeMs);
+	case 8:
+		return integrateGroupAVX2(runtimeData[netId], groupConfigs[netId][lGrpId], networkConfigs[netId], lGrpId,
+			startN, endN, lastIter, simTimeMs);
+	default:
+		break;
+	}
+#endif
+
+	return startN;
+}
@@ -62,6 +62,13 @@
 #include <spike_buffer.h>
 #include <error_code.h>
 
+#if !defined(WIN32) && !defined(WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // \FIXME what are the following for? why were they all the way at the bottom of this file?
 
 #define COMPACTION_ALIGNMENT_PRE  16
@@ -868,8 +875,6 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 
 			shiftSpikeTables();
 		}
-
-		fetchNeuronSpikeCount(ALL);
 	}
 
 	//KERNEL_INFO("Updated monitors!");
@@ -896,6 +901,10 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 	updateSpikeMonitor();
 	updateGroupMonitor();
 
+	// spike files are written in the background while the network runs, but must be complete when we return
+	for (int monitorId = 0; monitorId < numSpikeMonitor; monitorId++)
+		spikeMonCoreList[monitorId]->waitForSpikeFileWriter();
+
 	// keep track of simulation time...
 #ifndef __NO_CUDA__
 	CUDA_STOP_TIMER(timer);
@@ -1001,6 +1010,10 @@ void SNN::loadSimulation(FILE* fid) {
 	loadSimFID = fid;
 }
 
+void SNN::setConnectionCache(const std::string& dirName) {
+	connCacheDir_ = dirName;
+}
+
 // multiplies every weight with a scaling factor
 void SNN::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	assert(connId>=0 && connId<numConnections);
@@ -1267,7 +1280,7 @@ NeuronMonitor* SNN::setNeuronMonitor(int gGrpId, FILE* fid) {
 // FIXME: distinguish the function call at CONFIG_STATE and RUN_STATE, where groupConfigs[0][] might not be available
 // or groupConfigMap is not sync with groupConfigs[0][]
 // assigns spike rate to group
-void SNN::setSpikeRate(int gGrpId, PoissonRate* ratePtr, int refPeriod) {
+void SNN::setSpikeRate(int gGrpId, PoissonRate* ratePtr, int refPeriod, bool eventDriven) {
 	int netId = groupConfigMDMap[gGrpId].netId;
 	int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
 
@@ -1277,8 +1290,16 @@ void SNN::setSpikeRate(int gGrpId, PoissonRate* ratePtr, int refPeriod) {
 	assert(ratePtr->getNumNeurons() == groupConfigMap[gGrpId].numN);
 	assert(refPeriod >= 1);
 
+	if (eventDriven && netId < CPU_RUNTIME_BASE) {
+		KERNEL_ERROR("setSpikeRate: event-driven Poisson spikes are only supported on CPU cores (group %d(%s))",
+			gGrpId, groupConfigMap[gGrpId].grpName.c_str());
+		exitSimulation(1);
+	}
+
 	groupConfigMDMap[gGrpId].ratePtr = ratePtr;
 	groupConfigMDMap[gGrpId].refractPeriod = refPeriod;
+	groupConfigMDMap[gGrpId].isPoissonEventDriven = eventDriven;
+	groupConfigMDMap[gGrpId].isPoissonRateUpdated = true;
 	spikeRateUpdated = true;
 }
 
@@ -1404,6 +1425,26 @@ void SNN::setExternalCurrent(int grpId, const std::vector<float>& current) {
 	}
 }
 
+// FNV-1a
+static inline void hashBytes(uint64_t& hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+// pads a simulation file with zeros to a multiple of 8 bytes and returns the new position
+static long long alignSimFile(FILE* fid) {
+	const char zeros[8] = {0};
+	long long pos = ftell(fid);
+	if (pos % 8 != 0) {
+		fwrite(zeros, 1, 8 - pos % 8, fid);
+		pos += 8 - pos % 8;
+	}
+	return pos;
+}
+
 // writes network state to file
 // handling of file pointer should be handled externally: as far as this function is concerned, it is simply
 // trying to write to file
@@ -1414,11 +1455,11 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 	//// +++++ WRITE HEADER SECTION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
 	//// write file signature
-	tmpInt = 294338571; // some int used to identify saveSimulation files
+	tmpInt = SIM_FILE_SIGNATURE; // some int used to identify saveSimulation files
 	if (!fwrite(&tmpInt,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 
 	//// write version number
-	tmpFloat = 0.3f;
+	tmpFloat = SIM_FILE_VERSION;
 	if (!fwrite(&tmpFloat,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 
 	//// write simulation time so far (in seconds)
@@ -1457,16 +1498,10 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 
 	if (!saveSynapseInfo) return;
 
-	// Save number of local networks
-	int net_count = 0;
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		if (!groupPartitionLists[netId].empty()) {
-			net_count++;
-		}
-	}
-	if (!fwrite(&net_count, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	// Save weights for each local network
+	// collect the synapses of all local networks as one bulk array per field, see SimFileSection
+	std::vector<int> grpIdPreArr, grpIdPostArr, nIdPreArr, nIdPostArr, connIdArr;
+	std::vector<float> wtArr, maxWtArr;
+	std::vector<uint8_t> delayArr;
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			// copy from runtimeData to managerRuntimeData
@@ -1482,8 +1517,6 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 					numSynToSave += grpIt->numPostSynapses;
 				}
 			}
-			if (!fwrite(&numSynToSave, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-			// read synapse info from managerRuntimData
 			int numSynSaved = 0;
 			for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) {
 				unsigned int offset = managerRuntimeData.cumulativePost[lNId];
@@ -1499,33 +1532,25 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 						int preSynId = GET_CONN_SYN_ID(post_info);
 						int pre_pos = managerRuntimeData.cumulativePre[lNIdPost] + preSynId;
 						SynInfo pre_info = managerRuntimeData.preSynapticIds[pre_pos];
-						int lNIdPre = GET_CONN_NEURON_ID(pre_info);
 						int lGrpIdPre = GET_CONN_GRP_ID(pre_info);
-						float weight = managerRuntimeData.wt[pre_pos];
-						float maxWeight = managerRuntimeData.maxSynWt[pre_pos];
-						int connId = managerRuntimeData.connIdsPreIdx[pre_pos];
-						int delay = t+1;
 
 						// convert local group id to global group id
 						// convert local neuron id to neuron order in group
 						int gGrpIdPre = groupConfigs[netId][lGrpIdPre].gGrpId;
 						int gGrpIdPost = groupConfigs[netId][lGrpIdPost].gGrpId;
-						int grpNIdPre = lNId - groupConfigs[netId][lGrpIdPre].lStartN;
-						int grpNIdPost = lNIdPost - groupConfigs[netId][lGrpIdPost].lStartN;
 
-						// we only save synapses starting from local groups since otherwise we will save external synapses twice 
-						// write order is based on function connectNeurons (no NetId & external_NetId)
-						// inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId) 
+						// we only save synapses starting from local groups since otherwise we will save external synapses twice
+						// the fields are the arguments of connectNeurons (no NetId & external_NetId)
 						if (groupConfigMDMap[gGrpIdPre].netId == netId) {
 							numSynSaved++;
-							if (!fwrite(&gGrpIdPre, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&gGrpIdPost, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&grpNIdPre, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&grpNIdPost, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&connId, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&weight, sizeof(float), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&maxWeight, sizeof(float), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
-							if (!fwrite(&delay, sizeof(int), 1, fid)) KERNEL_ERROR("saveSimulation fwrite error");
+							grpIdPreArr.push_back(gGrpIdPre);
+							grpIdPostArr.push_back(gGrpIdPost);
+							nIdPreArr.push_back(lNId - groupConfigs[netId][lGrpIdPre].lStartN);
+							nIdPostArr.push_back(lNIdPost - groupConfigs[netId][lGrpIdPost].lStartN);
+							connIdArr.push_back(managerRuntimeData.connIdsPreIdx[pre_pos]);
+							wtArr.push_back(managerRuntimeData.wt[pre_pos]);
+							maxWtArr.push_back(managerRuntimeData.maxSynWt[pre_pos]);
+							delayArr.push_back(t + 1);
 						}
 					}
 				}
@@ -1534,6 +1559,42 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 		}
 	}
 
+	// section table: one entry {section id, element size, offset from start of file, number of elements} per
+	// section, followed by the sections, each aligned to 8 bytes so that the file can be mapped and read in place
+	int numSynapses = grpIdPreArr.size();
+	const void* sectionData[NUM_SIM_SECTIONS] = {NULL};
+	if (numSynapses > 0) {
+		sectionData[SIM_SECTION_GRP_ID_PRE] = &grpIdPreArr[0];
+		sectionData[SIM_SECTION_GRP_ID_POST] = &grpIdPostArr[0];
+		sectionData[SIM_SECTION_NEUR_ID_PRE] = &nIdPreArr[0];
+		sectionData[SIM_SECTION_NEUR_ID_POST] = &nIdPostArr[0];
+		sectionData[SIM_SECTION_CONN_ID] = &connIdArr[0];
+		sectionData[SIM_SECTION_WEIGHT] = &wtArr[0];
+		sectionData[SIM_SECTION_MAX_WEIGHT] = &maxWtArr[0];
+		sectionData[SIM_SECTION_DELAY] = &delayArr[0];
+	}
+	const int sectionElemSize[NUM_SIM_SECTIONS] = {sizeof(int), sizeof(int), sizeof(int), sizeof(int),
+		sizeof(int), sizeof(float), sizeof(float), sizeof(uint8_t)};
+
+	int sectionHeader[2] = {numSynapses, NUM_SIM_SECTIONS};
+	if (!fwrite(sectionHeader, sizeof(int), 2, fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	long long pos = alignSimFile(fid);
+
+	pos += NUM_SIM_SECTIONS * (2 * sizeof(int) + 2 * sizeof(long long));
+	for (int s = 0; s < NUM_SIM_SECTIONS; s++) {
+		int sectionInfo[2] = {s, sectionElemSize[s]};
+		long long sectionPos[2] = {pos, numSynapses};
+		if (!fwrite(sectionInfo, sizeof(int), 2, fid)) KERNEL_ERROR("saveSimulation fwrite error");
+		if (!fwrite(sectionPos, sizeof(long long), 2, fid)) KERNEL_ERROR("saveSimulation fwrite error");
+		pos += ((long long)numSynapses * sectionElemSize[s] + 7) / 8 * 8;
+	}
+
+	for (int s = 0; s < NUM_SIM_SECTIONS && numSynapses > 0; s++) {
+		if (fwrite(sectionData[s], sectionElemSize[s], numSynapses, fid) != (size_t)numSynapses)
+			KERNEL_ERROR("saveSimulation fwrite error");
+		alignSimFile(fid);
+	}
+
 
 	//// +++++ Fetch WEIGHT DATA (GPU Mode only) ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 	//if (simMode_ == GPU_MODE)
@@ -1661,6 +1722,487 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 //}
 
 
+// adds a runtime array to the list of arrays stored in a checkpoint; arrays that were never allocated have size zero
+static void addCheckpointArray(std::vector<std::pair<void*, size_t> >& arrays, void* ptr, size_t bytes) {
+	arrays.push_back(std::make_pair(ptr, ptr == NULL ? 0 : bytes));
+}
+
+#if !defined(WIN32) && !defined(WIN64)
+// reads the state of the drand48 generator without advancing it
+static void getRand48State(unsigned short state[3]) {
+	unsigned short tmp[3] = {0, 0, 0};
+	unsigned short* old = seed48(tmp);
+	memcpy(state, old, sizeof(unsigned short) * 3);
+	seed48(state);
+}
+#endif
+
+// the spike counters of a local network come first in a checkpoint, because they determine how much of the firing
+// tables is in use
+void SNN::collectCheckpointCounters(int netId, std::vector<std::pair<void*, size_t> >& arrays) {
+	RuntimeData* rtd = &runtimeData[netId];
+	unsigned int* counters[] = {&rtd->spikeCountSec, &rtd->spikeCountD1Sec, &rtd->spikeCountD2Sec,
+		&rtd->spikeCountExtRxD1Sec, &rtd->spikeCountExtRxD2Sec, &rtd->spikeCount, &rtd->spikeCountD1,
+		&rtd->spikeCountD2, &rtd->nPoissonSpikes, &rtd->spikeCountLastSecLeftD2, &rtd->spikeCountExtRxD2,
+		&rtd->spikeCountExtRxD1};
+
+	for (int i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+		addCheckpointArray(arrays, counters[i], sizeof(unsigned int));
+}
+
+// all arrays of a local network that hold state, that is, everything that is not rebuilt identically by
+// setupNetwork(): neuron and synapse state, the in-flight spikes, and the neuron parameters (which may be drawn at
+// random)
+void SNN::collectCheckpointArrays(int netId, std::vector<std::pair<void*, size_t> >& arrays) {
+	RuntimeData* rtd = &runtimeData[netId];
+	size_t numNReg = networkConfigs[netId].numNReg;
+	size_t numNPois = networkConfigs[netId].numNPois;
+	size_t numN = networkConfigs[netId].numN;
+	size_t numPreSynNet = networkConfigs[netId].numPreSynNet;
+	size_t numGroups = networkConfigs[netId].numGroups;
+	size_t lengthSTP = numN * (networkConfigs[netId].maxDelay + 1);
+
+	// neuron state
+	addCheckpointArray(arrays, rtd->voltage, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->nextVoltage, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->recovery, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->current, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->extCurrent, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->curSpike, sizeof(bool) * numNReg);
+	addCheckpointArray(arrays, rtd->lif_tau_ref_c, sizeof(int) * numNReg);
+	addCheckpointArray(arrays, rtd->avgFiring, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->lastSpikeTime, sizeof(int) * networkConfigs[netId].numNAssigned);
+	addCheckpointArray(arrays, rtd->nSpikeCnt, sizeof(int) * numN);
+
+	// conductances
+	addCheckpointArray(arrays, rtd->gAMPA, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gNMDA, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gNMDA_r, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gNMDA_d, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gGABAa, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gGABAb, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gGABAb_r, sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->gGABAb_d, sizeof(float) * numNReg);
+
+	// neuron parameters
+	float* paramsFloat[] = {rtd->Izh_a, rtd->Izh_b, rtd->Izh_c, rtd->Izh_d, rtd->Izh_C, rtd->Izh_k, rtd->Izh_vr,
+		rtd->Izh_vt, rtd->Izh_vpeak, rtd->lif_vTh, rtd->lif_vReset, rtd->lif_gain, rtd->lif_bias,
+		rtd->baseFiring, rtd->baseFiringInv};
+	for (int i = 0; i < sizeof(paramsFloat) / sizeof(paramsFloat[0]); i++)
+		addCheckpointArray(arrays, paramsFloat[i], sizeof(float) * numNReg);
+	addCheckpointArray(arrays, rtd->lif_tau_m, sizeof(int) * numNReg);
+	addCheckpointArray(arrays, rtd->lif_tau_ref, sizeof(int) * numNReg);
+
+	// synapse state and STP
+	addCheckpointArray(arrays, rtd->wt, sizeof(float) * numPreSynNet);
+	addCheckpointArray(arrays, rtd->wtChange, sizeof(float) * numPreSynNet);
+	addCheckpointArray(arrays, rtd->maxSynWt, sizeof(float) * numPreSynNet);
+	addCheckpointArray(arrays, rtd->synSpikeTime, sizeof(int) * numPreSynNet);
+	addCheckpointArray(arrays, rtd->I_set, sizeof(int) * numNReg * networkConfigs[netId].I_setLength);
+	addCheckpointArray(arrays, rtd->stpu, sizeof(float) * lengthSTP);
+	addCheckpointArray(arrays, rtd->stpx, sizeof(float) * lengthSTP);
+
+	// in-flight spikes
+	addCheckpointArray(arrays, rtd->timeTableD1, sizeof(int) * TIMING_COUNT);
+	addCheckpointArray(arrays, rtd->timeTableD2, sizeof(int) * TIMING_COUNT);
+	addCheckpointArray(arrays, rtd->firingTableD1, sizeof(int) * rtd->spikeCountD1Sec);
+	addCheckpointArray(arrays, rtd->firingTableD2, sizeof(int) * (rtd->spikeCountD2Sec + rtd->spikeCountLastSecLeftD2));
+
+	// spike generators
+	addCheckpointArray(arrays, rtd->poissonFireRate, sizeof(float) * numNPois);
+	addCheckpointArray(arrays, rtd->randNum, sizeof(float) * numNPois);
+	addCheckpointArray(arrays, rtd->spikeGenBits, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1));
+
+	// neuromodulators
+	float* neuromodulators[] = {rtd->grpDA, rtd->grp5HT, rtd->grpACh, rtd->grpNE};
+	float* neuromodulatorBuffers[] = {rtd->grpDABuffer, rtd->grp5HTBuffer, rtd->grpAChBuffer, rtd->grpNEBuffer};
+	for (int i = 0; i < 4; i++) {
+		addCheckpointArray(arrays, neuromodulators[i], sizeof(float) * numGroups);
+		addCheckpointArray(arrays, neuromodulatorBuffers[i], sizeof(float) * 1000 * numGroups);
+	}
+}
+
+// writes the complete runtime state of the simulation to file
+void SNN::saveCheckpoint(FILE* fid) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	for (int netId = 0; netId < CPU_RUNTIME_BASE; netId++) {
+		if (!groupPartitionLists[netId].empty()) {
+			KERNEL_ERROR("saveCheckpoint: Checkpoints are only supported for networks that run on CPU cores.");
+			exitSimulation(-1);
+		}
+	}
+
+	// header
+	int tmpInt = CHECKPOINT_FILE_SIGNATURE;
+	if (!fwrite(&tmpInt, sizeof(int), 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+	float tmpFloat = CHECKPOINT_FILE_VERSION;
+	if (!fwrite(&tmpFloat, sizeof(float), 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+
+	// a new base for delta checkpoints, identified by when and where in the simulation it was taken
+	uint64_t checkpointId = 14695981039346656037ULL;
+	time_t wallTime = time(NULL);
+	clock_t cpuTime = clock();
+	hashBytes(checkpointId, &wallTime, sizeof(time_t));
+	hashBytes(checkpointId, &cpuTime, sizeof(clock_t));
+	hashBytes(checkpointId, &simTime, sizeof(int));
+	hashBytes(checkpointId, &randSeed_, sizeof(int));
+	if (!fwrite(&checkpointId, sizeof(uint64_t), 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+
+	// simulation time, weight update schedule and random number generator
+	int simState[4] = {simTime, simTimeSec, simTimeMs, wtANDwtChangeUpdateIntervalCnt_};
+	if (!fwrite(simState, sizeof(int), 4, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+	unsigned short randState[3] = {0, 0, 0};
+#if !defined(WIN32) && !defined(WIN64)
+	getRand48State(randState);
+#endif
+	if (!fwrite(randState, sizeof(unsigned short), 3, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+
+	// local networks: id and sizes (to make sure the checkpoint is loaded into the same network), then the state
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		int netInfo[6] = {netId, networkConfigs[netId].numN, networkConfigs[netId].numNAssigned,
+			networkConfigs[netId].numPreSynNet, networkConfigs[netId].numGroups, networkConfigs[netId].maxDelay};
+		if (!fwrite(netInfo, sizeof(int), 6, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+
+		std::vector<std::pair<void*, size_t> > arrays;
+		collectCheckpointCounters(netId, arrays);
+		collectCheckpointArrays(netId, arrays);
+		for (int i = 0; i < arrays.size(); i++) {
+			long long bytes = arrays[i].second;
+			if (!fwrite(&bytes, sizeof(long long), 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+			if (bytes > 0 && !fwrite(arrays[i].first, bytes, 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+		}
+
+		// the pending spikes of event-driven Poisson groups, as pairs of neuron id and spike time
+		std::vector<int> poissonEvents;
+		poissonWheels_[netId].getEvents(poissonEvents);
+		int numEvents = poissonEvents.size() / 2;
+		if (!fwrite(&numEvents, sizeof(int), 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+		if (numEvents > 0 && !fwrite(&poissonEvents[0], sizeof(int), poissonEvents.size(), fid))
+			KERNEL_ERROR("saveCheckpoint fwrite error");
+	}
+
+	// end of networks
+	tmpInt = -1;
+	if (!fwrite(&tmpInt, sizeof(int), 1, fid)) KERNEL_ERROR("saveCheckpoint fwrite error");
+
+	setCheckpointBase(checkpointId);
+}
+
+// restores a runtime state written by saveCheckpoint into the same network, after setupNetwork()
+void SNN::loadCheckpoint(FILE* fid) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	bool readErr = false;
+	int tmpInt;
+	float tmpFloat;
+
+	readErr |= fread(&tmpInt, sizeof(int), 1, fid) != 1;
+	if (tmpInt != CHECKPOINT_FILE_SIGNATURE) {
+		KERNEL_ERROR("loadCheckpoint: Unknown file signature. This does not seem to be a checkpoint created with "
+			"CARLsim::saveCheckpoint.");
+		exitSimulation(-1);
+	}
+	readErr |= fread(&tmpFloat, sizeof(float), 1, fid) != 1;
+	if (tmpFloat > CHECKPOINT_FILE_VERSION) {
+		KERNEL_ERROR("loadCheckpoint: Unsupported version number (%f)", tmpFloat);
+		exitSimulation(-1);
+	}
+
+	float version = tmpFloat;
+
+	// checkpoints of version 0.1 cannot be the base of delta checkpoints
+	uint64_t checkpointId = 0;
+	if (version > 0.15f)
+		readErr |= fread(&checkpointId, sizeof(uint64_t), 1, fid) != 1;
+
+	int simState[4];
+	unsigned short randState[3];
+	readErr |= fread(simState, sizeof(int), 4, fid) != 4;
+	readErr |= fread(randState, sizeof(unsigned short), 3, fid) != 3;
+
+	// checkpoints before version 0.3 do not store the schedule of event-driven Poisson groups
+	bool hasPoissonEvents = version > 0.25f;
+	std::vector<int> poissonEvents[MAX_NET_PER_SNN];
+
+	int numNetsRead = 0;
+	while (!readErr) {
+		int netInfo[6];
+		readErr |= fread(netInfo, sizeof(int), 1, fid) != 1;
+		if (readErr || netInfo[0] == -1)
+			break;
+		readErr |= fread(&netInfo[1], sizeof(int), 5, fid) != 5;
+
+		int netId = netInfo[0];
+		if (readErr || netId < CPU_RUNTIME_BASE || netId >= MAX_NET_PER_SNN || groupPartitionLists[netId].empty()
+				|| netInfo[1] != networkConfigs[netId].numN || netInfo[2] != networkConfigs[netId].numNAssigned
+				|| netInfo[3] != networkConfigs[netId].numPreSynNet || netInfo[4] != networkConfigs[netId].numGroups
+				|| netInfo[5] != networkConfigs[netId].maxDelay) {
+			KERNEL_ERROR("loadCheckpoint: The checkpoint was created with a different network or partitioning.");
+			exitSimulation(-1);
+		}
+
+		// the counters are read first, because they determine the size of the firing tables
+		for (int pass = 0; pass < 2 && !readErr; pass++) {
+			std::vector<std::pair<void*, size_t> > arrays;
+			if (pass == 0)
+				collectCheckpointCounters(netId, arrays);
+			else
+				collectCheckpointArrays(netId, arrays);
+
+			for (int i = 0; i < arrays.size() && !readErr; i++) {
+				long long bytes;
+				readErr |= fread(&bytes, sizeof(long long), 1, fid) != 1;
+				if (!readErr && bytes != arrays[i].second) {
+					KERNEL_ERROR("loadCheckpoint: The checkpoint was created with a different network configuration.");
+					exitSimulation(-1);
+				}
+				if (bytes > 0)
+					readErr |= fread(arrays[i].first, bytes, 1, fid) != 1;
+			}
+		}
+
+		if (hasPoissonEvents && !readErr) {
+			int numEvents;
+			readErr |= fread(&numEvents, sizeof(int), 1, fid) != 1;
+			// every neuron has at most one pending spike
+			if (!readErr && (numEvents < 0 || numEvents > networkConfigs[netId].numN)) {
+				KERNEL_ERROR("loadCheckpoint: The checkpoint was created with a different network configuration.");
+				exitSimulation(-1);
+			}
+			poissonEvents[netId].resize(2 * numEvents);
+			if (!readErr && numEvents > 0)
+				readErr |= fread(&poissonEvents[netId][0], sizeof(int), 2 * numEvents, fid) != 2 * numEvents;
+			for (int i = 0; i < numEvents && !readErr; i++) {
+				if (poissonEvents[netId][2 * i] < 0 || poissonEvents[netId][2 * i] >= networkConfigs[netId].numN) {
+					KERNEL_ERROR("loadCheckpoint: The checkpoint was created with a different network configuration.");
+					exitSimulation(-1);
+				}
+			}
+		}
+		numNetsRead++;
+	}
+
+	int numNets = 0;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		numNets += groupPartitionLists[netId].empty() ? 0 : 1;
+
+	if (readErr || numNetsRead != numNets) {
+		KERNEL_ERROR("loadCheckpoint: Error while reading the checkpoint, the file is truncated or corrupted.");
+		exitSimulation(-1);
+	}
+
+	simTime = simState[0];
+	simTimeSec = simState[1];
+	simTimeMs = simState[2];
+	wtANDwtChangeUpdateIntervalCnt_ = simState[3];
+	simTimeRunStart = simTimeRunStop = simTimeLastRunSummary = simTime;
+#if !defined(WIN32) && !defined(WIN64)
+	seed48(randState);
+#else
+	KERNEL_WARN("loadCheckpoint: The state of the random number generator cannot be restored on Windows.");
+#endif
+
+	// monitors continue recording from the restored time, and cached copies of the runtime data are stale
+	for (int monId = 0; monId < numSpikeMonitor; monId++)
+		spikeMonCoreList[monId]->setLastUpdated(simTime);
+	for (int monId = 0; monId < numGroupMonitor; monId++)
+		groupMonCoreList[monId]->setLastUpdated(simTime);
+	for (int monId = 0; monId < numNeuronMonitor; monId++)
+		neuronMonCoreList[monId]->setLastUpdated(simTime);
+	spikeTablesFetchedNetId_ = -1;
+	for (int g = 0; g < numGroups; g++)
+		spikeCntFetchedTime_[g] = -1;
+
+	// the schedule of event-driven Poisson groups is restored as well, rates set before loading the checkpoint only
+	// apply to the spikes drawn from now on. Older checkpoints rebuild it from the restored rates and spike times.
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN && hasPoissonEvents; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+		poissonWheels_[netId].clearEvents();
+		for (int i = 0; i < poissonEvents[netId].size(); i += 2)
+			poissonWheels_[netId].schedule(poissonEvents[netId][i], poissonEvents[netId][i + 1]);
+	}
+	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++)
+		grpIt->second.isPoissonRateUpdated = !hasPoissonEvents;
+	spikeRateUpdated = true;
+
+	setCheckpointBase(checkpointId);
+}
+
+// remembers the plastic weights at the time of a full checkpoint, which delta checkpoints are compared against
+void SNN::setCheckpointBase(uint64_t checkpointId) {
+	checkpointBaseId_ = checkpointId;
+	checkpointDeltaSeq_ = 0;
+
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		checkpointBaseWt_[netId].clear();
+		checkpointBaseWtChange_[netId].clear();
+		if (groupPartitionLists[netId].empty() || sim_with_fixedwts || checkpointId == 0)
+			continue;
+
+		int numPreSynNet = networkConfigs[netId].numPreSynNet;
+		checkpointBaseWt_[netId].assign(runtimeData[netId].wt, runtimeData[netId].wt + numPreSynNet);
+		checkpointBaseWtChange_[netId].assign(runtimeData[netId].wtChange, runtimeData[netId].wtChange + numPreSynNet);
+	}
+}
+
+// finds the synapses of a local network whose weights can change, that is, the plastic synapses of all neurons in
+// groups with STDP. They are the first Npre_plastic synapses of each post-synaptic neuron.
+void SNN::findPlasticSynapses(int netId, std::vector<unsigned int>& synIds) {
+	synIds.clear();
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (groupConfigs[netId][lGrpId].FixedInputWts || !groupConfigs[netId][lGrpId].WithSTDP)
+			continue;
+
+		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
+			unsigned int offset = runtimeData[netId].cumulativePre[lNId];
+			for (int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; j++)
+				synIds.push_back(offset + j);
+		}
+	}
+}
+
+// writes the plastic weights that changed since the last full checkpoint
+void SNN::saveCheckpointDelta(FILE* fid, float epsilon) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	if (checkpointBaseId_ == 0) {
+		KERNEL_ERROR("saveCheckpointDelta: A delta checkpoint needs a base, call saveCheckpoint or loadCheckpoint "
+			"first.");
+		exitSimulation(-1);
+	}
+
+	int tmpInt = CHECKPOINT_DELTA_FILE_SIGNATURE;
+	if (!fwrite(&tmpInt, sizeof(int), 1, fid)) KERNEL_ERROR("saveCheckpointDelta fwrite error");
+	float tmpFloat = CHECKPOINT_FILE_VERSION;
+	if (!fwrite(&tmpFloat, sizeof(float), 1, fid)) KERNEL_ERROR("saveCheckpointDelta fwrite error");
+
+	// chain: the base, and the position of this delta after it
+	checkpointDeltaSeq_++;
+	if (!fwrite(&checkpointBaseId_, sizeof(uint64_t), 1, fid)) KERNEL_ERROR("saveCheckpointDelta fwrite error");
+	int deltaInfo[2] = {checkpointDeltaSeq_, simTime};
+	if (!fwrite(deltaInfo, sizeof(int), 2, fid)) KERNEL_ERROR("saveCheckpointDelta fwrite error");
+
+	// with epsilon == 0, synapses whose weight is unchanged but whose pending weight change differs are written, too,
+	// so that base plus delta restore the plastic synapses exactly
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty() || checkpointBaseWt_[netId].empty())
+			continue;
+
+		std::vector<unsigned int> plasticSynIds;
+		findPlasticSynapses(netId, plasticSynIds);
+
+		std::vector<unsigned int> synIds;
+		std::vector<float> wts, wtChanges;
+		for (int i = 0; i < plasticSynIds.size(); i++) {
+			unsigned int synId = plasticSynIds[i];
+			float wt = runtimeData[netId].wt[synId];
+			float wtChange = runtimeData[netId].wtChange[synId];
+			if (fabs(wt - checkpointBaseWt_[netId][synId]) > epsilon
+					|| (epsilon == 0.0f && wtChange != checkpointBaseWtChange_[netId][synId])) {
+				synIds.push_back(synId);
+				wts.push_back(wt);
+				wtChanges.push_back(wtChange);
+			}
+		}
+
+		int netInfo[3] = {netId, networkConfigs[netId].numPreSynNet, (int)synIds.size()};
+		if (!fwrite(netInfo, sizeof(int), 3, fid)) KERNEL_ERROR("saveCheckpointDelta fwrite error");
+		if (synIds.empty())
+			continue;
+		if (fwrite(&synIds[0], sizeof(unsigned int), synIds.size(), fid) != synIds.size()
+				|| fwrite(&wts[0], sizeof(float), wts.size(), fid) != wts.size()
+				|| fwrite(&wtChanges[0], sizeof(float), wtChanges.size(), fid) != wtChanges.size())
+			KERNEL_ERROR("saveCheckpointDelta fwrite error");
+	}
+
+	// end of networks
+	tmpInt = -1;
+	if (!fwrite(&tmpInt, sizeof(int), 1, fid)) KERNEL_ERROR("saveCheckpointDelta fwrite error");
+}
+
+// applies the plastic weights of a delta checkpoint on top of its base
+void SNN::loadCheckpointDelta(FILE* fid) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	bool readErr = false;
+	int tmpInt;
+	float tmpFloat;
+
+	readErr |= fread(&tmpInt, sizeof(int), 1, fid) != 1;
+	if (tmpInt != CHECKPOINT_DELTA_FILE_SIGNATURE) {
+		KERNEL_ERROR("loadCheckpointDelta: Unknown file signature. This does not seem to be a delta checkpoint "
+			"created with CARLsim::saveCheckpointDelta.");
+		exitSimulation(-1);
+	}
+	readErr |= fread(&tmpFloat, sizeof(float), 1, fid) != 1;
+	if (tmpFloat > CHECKPOINT_FILE_VERSION) {
+		KERNEL_ERROR("loadCheckpointDelta: Unsupported version number (%f)", tmpFloat);
+		exitSimulation(-1);
+	}
+
+	uint64_t baseId;
+	int deltaInfo[2];
+	readErr |= fread(&baseId, sizeof(uint64_t), 1, fid) != 1;
+	readErr |= fread(deltaInfo, sizeof(int), 2, fid) != 2;
+	if (!readErr && (baseId != checkpointBaseId_ || checkpointBaseId_ == 0)) {
+		KERNEL_ERROR("loadCheckpointDelta: The delta checkpoint belongs to a different base, load its base with "
+			"loadCheckpoint first.");
+		exitSimulation(-1);
+	}
+	if (!readErr && deltaInfo[0] <= checkpointDeltaSeq_) {
+		KERNEL_ERROR("loadCheckpointDelta: Delta checkpoints must be loaded in the order in which they were saved "
+			"(got #%d after #%d).", deltaInfo[0], checkpointDeltaSeq_);
+		exitSimulation(-1);
+	}
+
+	while (!readErr) {
+		int netInfo[3];
+		readErr |= fread(netInfo, sizeof(int), 1, fid) != 1;
+		if (readErr || netInfo[0] == -1)
+			break;
+		readErr |= fread(&netInfo[1], sizeof(int), 2, fid) != 2;
+
+		int netId = netInfo[0];
+		if (readErr || netId < 0 || netId >= MAX_NET_PER_SNN || groupPartitionLists[netId].empty()
+				|| netInfo[1] != networkConfigs[netId].numPreSynNet || netInfo[2] < 0
+				|| netInfo[2] > networkConfigs[netId].numPreSynNet) {
+			KERNEL_ERROR("loadCheckpointDelta: The delta checkpoint was created with a different network.");
+			exitSimulation(-1);
+		}
+
+		int numEntries = netInfo[2];
+		if (numEntries == 0)
+			continue;
+		std::vector<unsigned int> synIds(numEntries);
+		std::vector<float> wts(numEntries), wtChanges(numEntries);
+		readErr |= fread(&synIds[0], sizeof(unsigned int), numEntries, fid) != numEntries;
+		readErr |= fread(&wts[0], sizeof(float), numEntries, fid) != numEntries;
+		readErr |= fread(&wtChanges[0], sizeof(float), numEntries, fid) != numEntries;
+		for (int i = 0; i < numEntries && !readErr; i++) {
+			if (synIds[i] >= networkConfigs[netId].numPreSynNet) {
+				readErr = true;
+				break;
+			}
+			runtimeData[netId].wt[synIds[i]] = wts[i];
+			runtimeData[netId].wtChange[synIds[i]] = wtChanges[i];
+		}
+	}
+
+	if (readErr) {
+		KERNEL_ERROR("loadCheckpointDelta: Error while reading the delta checkpoint, the file is truncated or "
+			"corrupted.");
+		exitSimulation(-1);
+	}
+
+	checkpointDeltaSeq_ = deltaInfo[0];
+}
+
+
 /// ************************************************************************************************************ ///
 /// PUBLIC METHODS: PLOTTING / LOGGING
 /// ************************************************************************************************************ ///
@@ -1819,7 +2361,7 @@ uint8_t* SNN::getDelays(int gGrpIdPre, int gGrpIdPost, int& numPreN, int& numPos
 
 	fetchPostConnectionInfo(netIdPost);
 
-	for (int lNIdPre = groupConfigs[netIdPost][lGrpIdPre].lStartN; lNIdPre < groupConfigs[netIdPost][lGrpIdPre].lEndN; lNIdPre++) {
+	for (int lNIdPre = groupConfigs[netIdPost][lGrpIdPre].lStartN; lNIdPre <= groupConfigs[netIdPost][lGrpIdPre].lEndN; lNIdPre++) {
 		unsigned int offset = managerRuntimeData.cumulativePost[lNIdPre];
 
 		for (int t = 0; t < glbNetworkConfig.maxDelay; t++) {
@@ -1929,10 +2471,16 @@ Point3D SNN::getNeuronLocation3D(int gNId) {
 }
 
 Point3D SNN::getNeuronLocation3D(int gGrpId, int relNeurId) {
-	Grid3D grid = groupConfigMap[gGrpId].grid;
 	assert(gGrpId >= 0 && gGrpId < numGroups);
 	assert(relNeurId >= 0 && relNeurId < getGroupNumNeurons(gGrpId));
 
+	return getGridLocation3D(groupConfigMap[gGrpId].grid, relNeurId);
+}
+
+// returns the 3D location of neuron relNeurId on a Grid3D, does not access any group config
+Point3D SNN::getGridLocation3D(const Grid3D& grid, int relNeurId) {
+	assert(relNeurId >= 0 && relNeurId < grid.N);
+
 	int intX = relNeurId % grid.numX;
 	int intY = (relNeurId / grid.numX) % grid.numY;
 	int intZ = relNeurId / (grid.numX * grid.numY);
@@ -2124,12 +2672,27 @@ void SNN::SNNinit() {
 	numCompartmentConnections = 0;
 	numSpikeGenGrps = 0;
 	simulatorDeleted = false;
+	simdWidth_CPU = detectSIMDWidth_CPU();
+	numCPUThreadsUser = 0;
+	numCPUCoresUser = 0;
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	numCPUWorkers = 0;
+	cpuWorkerJob = NULL;
+	cpuWorkerJobChunked = false;
+	cpuWorkerPoolRunning = false;
+	memset(numCPUThreadsPerRuntime, 0, sizeof(int) * MAX_NET_PER_SNN);
+#endif
 
 	cumExecutionTime = 0.0;
 	executionTime = 0.0;
 
 	spikeRateUpdated = false;
 	numSpikeMonitor = 0;
+	spikeTablesFetchedNetId_ = -1;
+	spikeTablesFetchedTime_ = -1;
+	for (int g = 0; g < MAX_GRP_PER_SNN; g++)
+		spikeCntFetchedTime_[g] = -1;
 	numNeuronMonitor = 0;
 	numGroupMonitor = 0;
 	numConnectionMonitor = 0;
@@ -2144,6 +2707,10 @@ void SNN::SNNinit() {
 	sim_in_testing = false;
 
 	loadSimFID = NULL;
+	connCacheDir_ = "";
+	connCacheFile_ = "";
+	checkpointBaseId_ = 0;
+	checkpointDeltaSeq_ = 0;
 
 	// conductance info struct for simulation
 	sim_with_NMDA_rise = false;
@@ -2227,13 +2794,6 @@ void SNN::advSimStep() {
 }
 
 void SNN::doSTPUpdateAndDecayCond() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			assert(runtimeData[netId].allocated);
@@ -2242,46 +2802,20 @@ void SNN::doSTPUpdateAndDecayCond() {
 			else{//CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					doSTPUpdateAndDecayCond_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoSTPUpdateAndDecayCond_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperDoSTPUpdateAndDecayCond_CPU);
 	#endif
 }
 
 void SNN::spikeGeneratorUpdate() {
 	// If poisson rate has been updated, assign new poisson rate
 	if (spikeRateUpdated) {
-		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;
-			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-			int threadCount = 0;
-		#endif
-
 		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 			if (!groupPartitionLists[netId].empty()) {
 				if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2289,48 +2823,24 @@ void SNN::spikeGeneratorUpdate() {
 				else{ // CPU runtime
 					#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 						assignPoissonFiringRate_CPU(netId);
-					#else // Linux or MAC
-						pthread_attr_t attr;
-						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-						argsThreadRoutine[threadCount].snn_pointer = this;
-						argsThreadRoutine[threadCount].netId = netId;
-						argsThreadRoutine[threadCount].lGrpId = 0;
-						argsThreadRoutine[threadCount].startIdx = 0;
-						argsThreadRoutine[threadCount].endIdx = 0;
-						argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-						pthread_create(&threads[threadCount], &attr, &SNN::helperAssignPoissonFiringRate_CPU, (void*)&argsThreadRoutine[threadCount]);
-						pthread_attr_destroy(&attr);
-						threadCount++;
 					#endif
 				}
 			}
 		}
 
 		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
+			// run the CPU partitions on the persistent worker pool
+			runCPUWorkerPool(&SNN::helperAssignPoissonFiringRate_CPU);
 		#endif
 
+		for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++)
+			grpIt->second.isPoissonRateUpdated = false;
 		spikeRateUpdated = false;
 	}
 
 	// If time slice has expired, check if new spikes needs to be generated by user-defined spike generators
 	generateUserDefinedSpikes();
 
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2338,33 +2848,14 @@ void SNN::spikeGeneratorUpdate() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					spikeGeneratorUpdate_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperSpikeGeneratorUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperSpikeGeneratorUpdate_CPU);
 	#endif
 
 	// tell the spike buffer to advance to the next time step
@@ -2372,13 +2863,6 @@ void SNN::spikeGeneratorUpdate() {
 }
 
 void SNN::findFiring() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2386,44 +2870,18 @@ void SNN::findFiring() {
 			else {// CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					findFiring_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperFindFiring_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperFindFiring_CPU);
 	#endif
 }
 
 void SNN::doCurrentUpdate() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2431,34 +2889,14 @@ void SNN::doCurrentUpdate() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					doCurrentUpdateD2_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoCurrentUpdateD2_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-		threadCount = 0;
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperDoCurrentUpdateD2Chunk_CPU, 0, true);
 	#endif
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -2468,44 +2906,18 @@ void SNN::doCurrentUpdate() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					doCurrentUpdateD1_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoCurrentUpdateD1_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperDoCurrentUpdateD1Chunk_CPU, 0, true);
 	#endif
 }
 
 void SNN::updateTimingTable() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2513,43 +2925,17 @@ void SNN::updateTimingTable() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					updateTimingTable_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperUpdateTimingTable_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperUpdateTimingTable_CPU);
 	#endif
 }
 
 void SNN::globalStateUpdate() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2557,33 +2943,14 @@ void SNN::globalStateUpdate() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					globalStateUpdate_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperGlobalStateUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperGlobalStateUpdateChunk_CPU, 0, true);
 	#endif
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -2602,13 +2969,6 @@ void SNN::globalStateUpdate() {
 }
 
 void SNN::clearExtFiringTable() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2616,44 +2976,18 @@ void SNN::clearExtFiringTable() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					clearExtFiringTable_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperClearExtFiringTable_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperClearExtFiringTable_CPU);
 	#endif
 }
 
 void SNN::updateWeights() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2661,32 +2995,13 @@ void SNN::updateWeights() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					updateWeights_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperUpdateWeights_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperUpdateWeights_CPU);
 	#endif
 
 }
@@ -2701,13 +3016,6 @@ void SNN::updateNetworkConfig(int netId) {
 }
 
 void SNN::shiftSpikeTables() {
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -2715,33 +3023,14 @@ void SNN::shiftSpikeTables() {
 			else { // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					shiftSpikeTables_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperShiftSpikeTables_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperShiftSpikeTables_CPU);
 	#endif
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -3212,18 +3501,13 @@ void SNN::generateRuntimeNetworkConfigs() {
 	}
 }
 
-bool compareSrcNeuron(const ConnectionInfo& first, const ConnectionInfo& second) {
-	return (first.nSrc + first.srcGLoffset < second.nSrc + second.srcGLoffset);
-}
-
-bool compareDelay(const ConnectionInfo& first, const ConnectionInfo& second) {
-	return (first.delay < second.delay);
-}
-
-// Note: ConnectInfo stored in connectionList use global ids
+// Note: synapses stored in connectionLists use global ids
+// The runtime synapse arrays are generated in CSR layout by counting sorts over the synapse staging buffer,
+// which takes O(#synapses + #neurons * maxDelay) time. Synapses keep the order in which they were added:
+// pre-synaptic ids are ordered by plastic before fixed synapses, post-synaptic ids are ordered by delay.
 void SNN::generateConnectionRuntime(int netId) {
-	std::map<int, int> GLoffset; // global nId to local nId offset
-	std::map<int, int> GLgrpId; // global grpId to local grpId offset
+	std::vector<int> GLoffset(numGroups, 0); // global nId to local nId offset
+	std::vector<int> GLgrpId(numGroups, -1); // global grpId to local grpId offset
 
 	// load offset between global neuron id and local neuron id
 	for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
@@ -3233,182 +3517,119 @@ void SNN::generateConnectionRuntime(int netId) {
 	// FIXME: connId is global connId, use connectConfigs[netId][local connId] instead,
 	// FIXME; but note connectConfigs[netId][] are NOT complete, lack of exeternal incoming connections
 	// generate mulSynFast, mulSynSlow in connection-centric array
+	int maxConnId = -1;
 	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
 		// store scaling factors for synaptic currents in connection-centric array
 		mulSynFast[connIt->second.connId] = connIt->second.mulSynFast;
 		mulSynSlow[connIt->second.connId] = connIt->second.mulSynSlow;
-	}
-
-	// parse ConnectionInfo stored in connectionLists[0]
-	// note: ConnectInfo stored in connectionList use global ids
-	// generate Npost, Npre, Npre_plastic
-	int parsedConnections = 0;
-	memset(managerRuntimeData.Npost, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	memset(managerRuntimeData.Npre, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	memset(managerRuntimeData.Npre_plastic, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		connIt->srcGLoffset = GLoffset[connIt->grpSrc];
-		if (managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]] == SYNAPSE_ID_MASK) {
-			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connIt->nSrc, connIt->grpSrc);
+		maxConnId = std::max(maxConnId, (int)connIt->first);
+	}
+
+	// look up plasticity per connection once, not per synapse
+	std::vector<bool> isPlasticConn(maxConnId + 1, false);
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++)
+		isPlasticConn[connIt->first] = GET_FIXED_PLASTIC(connIt->second.connProp) == SYN_PLASTIC;
+
+	const SynapseStagingBuffer& synapses = connectionLists[netId];
+	const int numConns = synapses.size();
+	const int numNAssigned = networkConfigs[netId].numNAssigned;
+	const int delaySlots = glbNetworkConfig.maxDelay + 1;
+
+	// parse the synapses stored in connectionLists[netId], generate Npost, Npre, Npre_plastic
+	// note: synapses stored in connectionLists use global ids
+	memset(managerRuntimeData.Npost, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npre, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npre_plastic, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (numNAssigned * delaySlots));
+	for (int i = 0; i < numConns; i++) {
+		int grpSrc = synapses.grpSrc(i), grpDest = synapses.grpDest(i);
+		int lNIdSrc = synapses.nSrc(i) + GLoffset[grpSrc];
+		int lNIdDest = synapses.nDest(i) + GLoffset[grpDest];
+		uint8_t delay = synapses.delay(i);
+		if (managerRuntimeData.Npost[lNIdSrc] == SYNAPSE_ID_MASK) {
+			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, synapses.nSrc(i), grpSrc);
 			exitSimulation(ID_OVERFLOW_ERROR);
 		}
-		if (managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]] == SYNAPSE_ID_MASK) {
-			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connIt->nDest, connIt->grpDest);
+		if (managerRuntimeData.Npre[lNIdDest] == SYNAPSE_ID_MASK) {
+			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, synapses.nDest(i), grpDest);
 			exitSimulation(ID_OVERFLOW_ERROR);
 		}
-		managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]]++;
-		managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]++;
+		managerRuntimeData.Npost[lNIdSrc]++;
+		managerRuntimeData.Npre[lNIdDest]++;
 
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_PLASTIC) {
+		// count synapses per (pre-neuron, delay) bucket for the delay look up table
+		assert(delay > 0 && delay <= glbNetworkConfig.maxDelay);
+		managerRuntimeData.postDelayInfo[lNIdSrc * delaySlots + delay - 1].delay_length++;
+
+		if (isPlasticConn[synapses.connId(i)]) {
 			sim_with_fixedwts = false; // if network has any plastic synapses at all, this will be set to true
-			managerRuntimeData.Npre_plastic[connIt->nDest + GLoffset[connIt->grpDest]]++;
+			managerRuntimeData.Npre_plastic[lNIdDest]++;
 
 			// homeostasis
-			if (groupConfigMap[connIt->grpDest].homeoConfig.WithHomeostasis && groupConfigMDMap[connIt->grpDest].homeoId == -1)
-				groupConfigMDMap[connIt->grpDest].homeoId = connIt->nDest + GLoffset[connIt->grpDest]; // this neuron info will be printed
-
-			// old access to homeostasis
-			//if (groupConfigs[netId][GLgrpId[it->grpDest]].WithHomeostasis && groupConfigs[netId][GLgrpId[it->grpDest]].homeoId == -1)
-			//	groupConfigs[netId][GLgrpId[it->grpDest]].homeoId = it->nDest + GLoffset[it->grpDest]; // this neuron info will be printed
+			if (groupConfigMap[grpDest].homeoConfig.WithHomeostasis && groupConfigMDMap[grpDest].homeoId == -1)
+				groupConfigMDMap[grpDest].homeoId = lNIdDest; // this neuron info will be printed
 		}
-
-		// generate the delay vaule
-		//it->delay = connectConfigMap[it->connId].minDelay + rand() % (connectConfigMap[it->connId].maxDelay - connectConfigMap[it->connId].minDelay + 1);
-		//assert((it->delay >= connectConfigMap[it->connId].minDelay) && (it->delay <= connectConfigMap[it->connId].maxDelay));
-		// generate the max weight and initial weight
-		//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
-		//float initWt = connectConfigMap[it->connId].initWt;
-		//float maxWt = connectConfigMap[it->connId].maxWt;
-		// adjust sign of weight based on pre-group (negative if pre is inhibitory)
-		// this access is fine, isExcitatoryGroup() use global grpId
-		//it->maxWt = isExcitatoryGroup(it->grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
-		//it->initWt = isExcitatoryGroup(it->grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
-
-		parsedConnections++;
 	}
-	assert(parsedConnections == networkConfigs[netId].numPostSynNet && parsedConnections == networkConfigs[netId].numPreSynNet);
+	assert(numConns == networkConfigs[netId].numPostSynNet && numConns == networkConfigs[netId].numPreSynNet);
 
 	// generate cumulativePost and cumulativePre
 	managerRuntimeData.cumulativePost[0] = 0;
 	managerRuntimeData.cumulativePre[0] = 0;
-	for (int lNId = 1; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+	for (int lNId = 1; lNId < numNAssigned; lNId++) {
 		managerRuntimeData.cumulativePost[lNId] = managerRuntimeData.cumulativePost[lNId - 1] + managerRuntimeData.Npost[lNId - 1];
 		managerRuntimeData.cumulativePre[lNId] = managerRuntimeData.cumulativePre[lNId - 1] + managerRuntimeData.Npre[lNId - 1];
 	}
 
-	// generate preSynapticIds, parse plastic connections first
-	memset(managerRuntimeData.Npre, 0, sizeof(short) * networkConfigs[netId].numNAssigned); // reset managerRuntimeData.Npre to zero, so that it can be used as synId
-	parsedConnections = 0;
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_PLASTIC) {
-			int pre_pos = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]];
-			assert(pre_pos < networkConfigs[netId].numPreSynNet);
-
-			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), 0, (GLgrpId[connIt->grpSrc])); // managerRuntimeData.Npost[it->nSrc] is not availabe at this parse
-			connIt->preSynId = managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]; // save managerRuntimeData.Npre[it->nDest] as synId
-
-			managerRuntimeData.Npre[connIt->nDest+ GLoffset[connIt->grpDest]]++;
-			parsedConnections++;
-
-			// update the maximum number of and pre-connections of a neuron in a group
-			//if (managerRuntimeData.Npre[it->nDest] > groupInfo[it->grpDest].maxPreConn)
-			//	groupInfo[it->grpDest].maxPreConn = managerRuntimeData.Npre[it->nDest];
-		}
-	}
-	// parse fixed connections
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_FIXED) {
-			int pre_pos = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]];
-			assert(pre_pos < networkConfigs[netId].numPreSynNet);
-
-			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), 0, (GLgrpId[connIt->grpSrc])); // managerRuntimeData.Npost[it->nSrc] is not availabe at this parse
-			connIt->preSynId = managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]; // save managerRuntimeData.Npre[it->nDest] as synId
-
-			managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]++;
-			parsedConnections++;
-
-			// update the maximum number of and pre-connections of a neuron in a group
-			//if (managerRuntimeData.Npre[it->nDest] > groupInfo[it->grpDest].maxPreConn)
-			//	groupInfo[it->grpDest].maxPreConn = managerRuntimeData.Npre[it->nDest];
-		}
-	}
-	assert(parsedConnections == networkConfigs[netId].numPreSynNet);
-	//printf("parsed pre connections %d\n", parsedConnections);
-
-	// generate postSynapticIds
-	connectionLists[netId].sort(compareSrcNeuron); // sort by local nSrc id
-	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (networkConfigs[netId].numNAssigned * (glbNetworkConfig.maxDelay + 1)));
-	for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) { // pre-neuron order, local nId
-		if (managerRuntimeData.Npost[lNId] > 0) {
-			std::list<ConnectionInfo> postConnectionList;
-			ConnectionInfo targetConn;
-			targetConn.nSrc = lNId ; // the other fields does not matter, use local nid to search
-
-			std::list<ConnectionInfo>::iterator firstPostConn = std::find(connectionLists[netId].begin(), connectionLists[netId].end(), targetConn);
-			std::list<ConnectionInfo>::iterator lastPostConn = firstPostConn;
-			std::advance(lastPostConn, managerRuntimeData.Npost[lNId]);
-			managerRuntimeData.Npost[lNId] = 0; // reset managerRuntimeData.Npost[lNId] to zero, so that it can be used as synId
-
-			postConnectionList.splice(postConnectionList.begin(), connectionLists[netId], firstPostConn, lastPostConn);
-			postConnectionList.sort(compareDelay);
-
-			int post_pos, pre_pos, lastDelay = 0;
-			parsedConnections = 0;
-			//memset(&managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1)], 0, sizeof(DelayInfo) * (glbNetworkConfig.maxDelay + 1));
-			for (std::list<ConnectionInfo>::iterator connIt = postConnectionList.begin(); connIt != postConnectionList.end(); connIt++) {
-				assert(connIt->nSrc + GLoffset[connIt->grpSrc] == lNId);
-				post_pos = managerRuntimeData.cumulativePost[connIt->nSrc + GLoffset[connIt->grpSrc]] + managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]];
-				pre_pos  = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + connIt->preSynId;
-
-				assert(post_pos < networkConfigs[netId].numPostSynNet);
-				//assert(pre_pos  < numPreSynNet);
-
-				// generate a post synaptic id for the current connection
-				managerRuntimeData.postSynapticIds[post_pos] = SET_CONN_ID((connIt->nDest + GLoffset[connIt->grpDest]), connIt->preSynId, (GLgrpId[connIt->grpDest]));// used stored managerRuntimeData.Npre[it->nDest] in it->preSynId
-				// generate a delay look up table by the way
-				assert(connIt->delay > 0);
-				if (connIt->delay > lastDelay) {
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_index_start = managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]];
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_length++;
-				} else if (connIt->delay == lastDelay) {
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_length++;
-				} else {
-					KERNEL_ERROR("Post-synaptic delays not sorted correctly... pre_id=%d, delay[%d]=%d, delay[%d]=%d",
-						lNId, managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]], connIt->delay, managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]] - 1, lastDelay);
-				}
-				lastDelay = connIt->delay;
-
-				// update the corresponding pre synaptic id
-				SynInfo preId = managerRuntimeData.preSynapticIds[pre_pos];
-				assert(GET_CONN_NEURON_ID(preId) == connIt->nSrc + GLoffset[connIt->grpSrc]);
-				//assert(GET_CONN_GRP_ID(preId) == it->grpSrc);
-				managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]], (GLgrpId[connIt->grpSrc]));
-				managerRuntimeData.wt[pre_pos] = connIt->initWt;
-				managerRuntimeData.maxSynWt[pre_pos] = connIt->maxWt;
-				managerRuntimeData.connIdsPreIdx[pre_pos] = connIt->connId;
-
-				managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]]++;
-				parsedConnections++;
-
-				// update the maximum number of and post-connections of a neuron in a group
-				//if (managerRuntimeData.Npost[it->nSrc] > groupInfo[it->grpSrc].maxPostConn)
-				//	groupInfo[it->grpSrc].maxPostConn = managerRuntimeData.Npost[it->nSrc];
+	// generate the delay look up table: synapses of a pre-neuron are sorted by delay, so every non-empty delay bucket
+	// starts where the previous one ends. postSlot holds the next free post-synaptic slot (within the pre-neuron) of
+	// every bucket.
+	std::vector<int> postSlot(numNAssigned * delaySlots, 0);
+	for (int lNId = 0; lNId < numNAssigned; lNId++) {
+		int synId = 0;
+		for (int t = 0; t < delaySlots; t++) {
+			DelayInfo& dInfo = managerRuntimeData.postDelayInfo[lNId * delaySlots + t];
+			if (dInfo.delay_length > 0) {
+				dInfo.delay_index_start = synId;
+				postSlot[lNId * delaySlots + t] = synId;
+				synId += dInfo.delay_length;
 			}
-			assert(parsedConnections == managerRuntimeData.Npost[lNId]);
-			//printf("parsed post connections %d\n", parsedConnections);
-			// note: elements in postConnectionList are deallocated automatically with postConnectionList
-			/* for postDelayInfo debugging
-			printf("%d ", lNId);
-			for (int t = 0; t < maxDelay_ + 1; t ++) {
-				printf("[%d,%d]",
-					managerRuntimeData.postDelayInfo[lNId * (maxDelay_ + 1) + t].delay_index_start,
-					managerRuntimeData.postDelayInfo[lNId * (maxDelay_ + 1) + t].delay_length);
+		}
+		assert(synId == managerRuntimeData.Npost[lNId]);
+	}
+
+	// generate pre-synaptic slots, parse plastic connections first, then fixed connections
+	std::vector<short> preSlot(numNAssigned, 0);
+	std::vector<short> preSynIds(numConns);
+	for (int plastic = 1; plastic >= 0; plastic--) {
+		for (int i = 0; i < numConns; i++) {
+			if (isPlasticConn[synapses.connId(i)] == (plastic == 1)) {
+				int lNIdDest = synapses.nDest(i) + GLoffset[synapses.grpDest(i)];
+				preSynIds[i] = preSlot[lNIdDest]++; // save the pre-synaptic slot as synId
 			}
-			printf("\n");
-			*/
 		}
 	}
-	assert(connectionLists[netId].empty());
+
+	// generate postSynapticIds and preSynapticIds
+	// within a (pre-neuron, delay) bucket, synapses are placed in list order
+	for (int i = 0; i < numConns; i++) {
+		int grpSrc = synapses.grpSrc(i), grpDest = synapses.grpDest(i);
+		int lNIdSrc = synapses.nSrc(i) + GLoffset[grpSrc];
+		int lNIdDest = synapses.nDest(i) + GLoffset[grpDest];
+		int postSynId = postSlot[lNIdSrc * delaySlots + synapses.delay(i) - 1]++;
+		int post_pos = managerRuntimeData.cumulativePost[lNIdSrc] + postSynId;
+		int pre_pos  = managerRuntimeData.cumulativePre[lNIdDest] + preSynIds[i];
+		assert(post_pos < networkConfigs[netId].numPostSynNet);
+		assert(pre_pos < networkConfigs[netId].numPreSynNet);
+
+		managerRuntimeData.postSynapticIds[post_pos] = SET_CONN_ID(lNIdDest, preSynIds[i], GLgrpId[grpDest]);
+		managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID(lNIdSrc, postSynId, GLgrpId[grpSrc]);
+		managerRuntimeData.wt[pre_pos] = synapses.initWt(i);
+		managerRuntimeData.maxSynWt[pre_pos] = synapses.maxWt(i);
+		managerRuntimeData.connIdsPreIdx[pre_pos] = synapses.connId(i);
+	}
+
+	// the staging buffer is not needed anymore
+	connectionLists[netId].clear();
 
 	//int p = managerRuntimeData.Npost[src];
 
@@ -3633,153 +3854,168 @@ void SNN::compileGroupConfig() {
 }
 
 void SNN::connectNetwork() {
-	// this parse generates local connections
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		for (std::list<ConnectConfig>::iterator connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++) {
-			switch(connIt->type) {
-				case CONN_RANDOM:
-					connectRandom(netId, connIt, false);
-					break;
-				case CONN_FULL:
-					connectFull(netId, connIt, false);
-					break;
-				case CONN_FULL_NO_DIRECT:
-					connectFull(netId, connIt, false);
-					break;
-				case CONN_ONE_TO_ONE:
-					connectOneToOne(netId, connIt, false);
-					break;
-				case CONN_GAUSSIAN:
-					connectGaussian(netId, connIt, false);
-					break;
-				case CONN_USER_DEFINED:
-					connectUserDefined(netId, connIt, false);
-					break;
-				default:
-					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
-					exitSimulation(-1);
+	// split the connections into blocks of pre-synaptic neurons, local connections first, then external ones. User-
+	// defined connections call back into user code and are therefore generated serially below.
+	connectionBlocks.clear();
+	for (int isExternal = 0; isExternal < 2; isExternal++) {
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			std::list<ConnectConfig>& connectList = isExternal ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+				switch(connIt->type) {
+					case CONN_RANDOM:
+					case CONN_FULL:
+					case CONN_FULL_NO_DIRECT:
+					case CONN_ONE_TO_ONE:
+					case CONN_GAUSSIAN:
+						break;
+					case CONN_USER_DEFINED:
+						continue;
+					default:
+						KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
+						exitSimulation(-1);
+				}
+
+				int gPreEnd = groupConfigMDMap[connIt->grpSrc].gEndN;
+				int blockId = 0;
+				for (int gPreN = groupConfigMDMap[connIt->grpSrc].gStartN; gPreN <= gPreEnd; gPreN += CONN_BLOCK_SIZE) {
+					ConnectionBlock block;
+					block.connConfig = &(*connIt);
+					block.blockId = blockId++;
+					block.gPreStart = gPreN;
+					block.gPreEnd = std::min(gPreN + CONN_BLOCK_SIZE - 1, gPreEnd);
+					block.gPreGrpStart = groupConfigMDMap[connIt->grpSrc].gStartN;
+					block.gPostGrpStart = groupConfigMDMap[connIt->grpDest].gStartN;
+					block.gPostGrpEnd = groupConfigMDMap[connIt->grpDest].gEndN;
+					block.gridPre = groupConfigMap[connIt->grpSrc].grid;
+					block.gridPost = groupConfigMap[connIt->grpDest].grid;
+					connectionBlocks.push_back(block);
+				}
 			}
 		}
 	}
 
-	// this parse generates external connections
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		for (std::list<ConnectConfig>::iterator connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++) {
-			switch(connIt->type) {
-				case CONN_RANDOM:
-					connectRandom(netId, connIt, true);
-					break;
-				case CONN_FULL:
-					connectFull(netId, connIt, true);
-					break;
-				case CONN_FULL_NO_DIRECT:
-					connectFull(netId, connIt, true);
-					break;
-				case CONN_ONE_TO_ONE:
-					connectOneToOne(netId, connIt, true);
-					break;
-				case CONN_GAUSSIAN:
-					connectGaussian(netId, connIt, true);
-					break;
-				case CONN_USER_DEFINED:
-					connectUserDefined(netId, connIt, true);
-					break;
-				default:
-					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
-					exitSimulation(-1);
+	generateConnectionBlocks();
+
+	// move the synapses into the staging buffers, in the same order in which the connections were split
+	int blockIdx = 0;
+	for (int isExternal = 0; isExternal < 2; isExternal++) {
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			std::list<ConnectConfig>& connectList = isExternal ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+				if (connIt->type == CONN_USER_DEFINED) {
+					connectUserDefined(netId, connIt, isExternal);
+					continue;
+				}
+
+				int externalNetId = -1;
+				if (isExternal) {
+					externalNetId = groupConfigMDMap[connIt->grpDest].netId;
+					assert(netId != externalNetId);
+				}
+
+				for (; blockIdx < connectionBlocks.size() && connectionBlocks[blockIdx].connConfig == &(*connIt); blockIdx++)
+					addConnectionBlock(netId, connectionBlocks[blockIdx], externalNetId);
+
+				updateGroupSynapseCounts(netId, connIt, isExternal);
 			}
 		}
 	}
+	assert(blockIdx == connectionBlocks.size());
+
+	connectionBlocks.clear();
 }
 
-//! set one specific connection from neuron id 'src' to neuron id 'dest'
-inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, int externalNetId) {
-	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
-	ConnectionInfo connInfo;
-	connInfo.grpSrc = _grpSrc;
-	connInfo.grpDest = _grpDest;
-	connInfo.nSrc = _nSrc;
-	connInfo.nDest = _nDest;
-	connInfo.srcGLoffset = 0;
-	connInfo.connId = _connId;
-	connInfo.preSynId = -1;
-	connInfo.initWt = 0.0f;
-	connInfo.maxWt = 0.0f;
-	connInfo.delay = 0;
-
-	// generate the delay vaule
-	connInfo.delay = connectConfigMap[_connId].minDelay + rand() % (connectConfigMap[_connId].maxDelay - connectConfigMap[_connId].minDelay + 1);
-	assert((connInfo.delay >= connectConfigMap[_connId].minDelay) && (connInfo.delay <= connectConfigMap[_connId].maxDelay));
-	// generate the max weight and initial weight
-	//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
-	float initWt = connectConfigMap[_connId].initWt;
-	float maxWt = connectConfigMap[_connId].maxWt;
-	// adjust sign of weight based on pre-group (negative if pre is inhibitory)
-	// this access is fine, isExcitatoryGroup() use global grpId
-	connInfo.maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
-	connInfo.initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
-
-	connectionLists[netId].push_back(connInfo);
+// generates all connection blocks, spread round-robin over one thread per core. Every block only reads its connection
+// config and the copies of the group configs it carries (std::map::operator[] on the group maps may insert, so the
+// threads must not use it), and writes to its own synapse vectors, so the threads need no synchronization.
+void SNN::generateConnectionBlocks() {
+	int numThreads = 1;
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	numThreads = std::max(1, std::min((int)NUM_CPU_CORES, (int)connectionBlocks.size()));
+#endif
 
-	// If the connection is external, copy the connection info to the external network
-	if (externalNetId >= 0)
-		connectionLists[externalNetId].push_back(connInfo);
-}
+	if (numThreads == 1) {
+		generateConnectionBlockRange(0, 1);
+		return;
+	}
 
-//! set one specific connection from neuron id 'src' to neuron id 'dest'
-inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId) {
-	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
-	ConnectionInfo connInfo;
-	connInfo.grpSrc = _grpSrc;
-	connInfo.grpDest = _grpDest;
-	connInfo.nSrc = _nSrc;
-	connInfo.nDest = _nDest;
-	connInfo.srcGLoffset = 0;
-	connInfo.connId = _connId;
-	connInfo.preSynId = -1;
-	// adjust the sign of the weight based on inh/exc connection
-	connInfo.initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0*fabs(initWt);
-	connInfo.maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0*fabs(maxWt);
-	connInfo.delay = delay;
+	std::vector<pthread_t> threads(numThreads);
+	std::vector<ThreadStruct> args(numThreads);
+	for (int i = 0; i < numThreads; i++) {
+		args[i].snn_pointer = this;
+		args[i].chunkId = i;
+		args[i].numChunks = numThreads;
+		int err = pthread_create(&threads[i], NULL, &SNN::helperGenerateConnectionBlocks, (void*)&args[i]);
+		if (err != 0) {
+			KERNEL_ERROR("Could not create connection builder thread %d (error %d)", i, err);
+			exitSimulation(1);
+		}
+	}
 
-	connectionLists[netId].push_back(connInfo);
+	for (int i = 0; i < numThreads; i++)
+		pthread_join(threads[i], NULL);
 
-	// If the connection is external, copy the connection info to the external network
-	if (externalNetId >= 0)
-		connectionLists[externalNetId].push_back(connInfo);
+	KERNEL_DEBUG("Generated %d connection block(s) with %d thread(s)", (int)connectionBlocks.size(), numThreads);
 }
 
-// make 'C' full connections from grpSrc to grpDest
-void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	bool noDirect = (connIt->type == CONN_FULL_NO_DIRECT);
-	int externalNetId = -1;
+void* SNN::helperGenerateConnectionBlocks(void* arguments) {
+	ThreadStruct* args = (ThreadStruct*)arguments;
+	((SNN*)args->snn_pointer)->generateConnectionBlockRange(args->chunkId, args->numChunks);
+	return NULL;
+}
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
+void SNN::generateConnectionBlockRange(int chunkId, int numChunks) {
+	for (int blockIdx = chunkId; blockIdx < connectionBlocks.size(); blockIdx += numChunks) {
+		ConnectionBlock& block = connectionBlocks[blockIdx];
 
-	int gPreStart = groupConfigMDMap[grpSrc].gStartN;
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++)  {
-		Point3D locPre = getNeuronLocation3D(grpSrc, gPreN - gPreStart); // 3D coordinates of i
-		int gPostStart = groupConfigMDMap[grpDest].gStartN;
-		for(int gPostN = groupConfigMDMap[grpDest].gStartN; gPostN <= groupConfigMDMap[grpDest].gEndN; gPostN++) { // j: the temp neuron id
-			// if flag is set, don't connect direct connections
-			if(noDirect && gPreN == gPostN)
-				continue;
+		// the stream of a block only depends on the seed, the connection and the position of the block
+		CounterRNG rng(randSeed_, block.connConfig->connId, block.blockId);
+		switch(block.connConfig->type) {
+			case CONN_RANDOM:
+				connectRandom(block, rng);
+				break;
+			case CONN_FULL:
+			case CONN_FULL_NO_DIRECT:
+				connectFull(block, rng);
+				break;
+			case CONN_ONE_TO_ONE:
+				connectOneToOne(block, rng);
+				break;
+			case CONN_GAUSSIAN:
+				connectGaussian(block, rng);
+				break;
+			default:
+				assert(false);
+		}
+	}
+}
 
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D locPost = getNeuronLocation3D(grpDest, gPostN - gPostStart); // 3D coordinates of j
-			if (!isPoint3DinRF(connIt->connRadius, locPre, locPost))
-				continue;
+// appends the synapses of a block to the staging buffer(s) and releases them
+void SNN::addConnectionBlock(int netId, ConnectionBlock& block, int externalNetId) {
+	ConnectConfig* conn = block.connConfig;
+	int numSynapses = block.nSrc.size();
 
-			connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-			connIt->numberOfConnections++;
-		}
+	if (conn->type == CONN_GAUSSIAN) {
+		for (int i = 0; i < numSynapses; i++)
+			connectNeurons(netId, conn->grpSrc, conn->grpDest, block.nSrc[i], block.nDest[i], conn->connId, block.initWt[i],
+				conn->maxWt, block.delay[i], externalNetId);
+	} else {
+		for (int i = 0; i < numSynapses; i++)
+			connectNeurons(netId, conn->grpSrc, conn->grpDest, block.nSrc[i], block.nDest[i], conn->connId, block.delay[i],
+				externalNetId);
 	}
+	conn->numberOfConnections += numSynapses;
 
+	std::vector<int>().swap(block.nSrc);
+	std::vector<int>().swap(block.nDest);
+	std::vector<uint8_t>().swap(block.delay);
+	std::vector<float>().swap(block.initWt);
+}
+
+// adds the synapses of a connection to numPostSynapses and numPreSynapses of its groups
+void SNN::updateGroupSynapseCounts(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
+	int grpSrc = connIt->grpSrc;
+	int grpDest = connIt->grpDest;
 	std::list<GroupConfigMD>::iterator grpIt;
 	GroupConfigMD targetGrp;
 
@@ -3796,6 +4032,9 @@ void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool
 
 	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
 	if (isExternal) {
+		int externalNetId = groupConfigMDMap[grpDest].netId;
+		assert(netId != externalNetId);
+
 		targetGrp.gGrpId = grpSrc; // the other fields does not matter
 		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
 		assert(grpIt != groupPartitionLists[externalNetId].end());
@@ -3808,180 +4047,553 @@ void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool
 	}
 }
 
-void SNN::connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	Grid3D grid_i = getGroupGrid3D(grpSrc);
-	Grid3D grid_j = getGroupGrid3D(grpDest);
-	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
-	int externalNetId = -1;
+// the connection cache holds the synapses generated by connectNetwork() in a file named after the hash of the
+// topology. The file has one section per local network: the registered connections, followed by the synapses as
+// plain arrays (nSrc, nDest, initWt, maxWt, connId, delay), each padded to 8 bytes so that the mapped file can be
+// read in place. A trailer holds the number of synapses of every connection.
+static const char connCacheMagic[8] = {'C', 'A', 'R', 'L', 'C', 'O', 'N', 'N'};
+static const int connCacheVersion = 1;
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
+static inline void writeCachePadding(FILE* fid, size_t numBytes) {
+	const char zeros[8] = {0};
+	if (numBytes % 8 != 0)
+		fwrite(zeros, 1, 8 - numBytes % 8, fid);
+}
+
+// returns a pointer to the next numBytes of the mapped cache and advances the cursor past their padding,
+// or NULL if the file is too short
+static inline const char* readCacheBytes(const char*& cursor, const char* end, size_t numBytes) {
+	size_t paddedBytes = (numBytes + 7) / 8 * 8;
+	if ((size_t)(end - cursor) < paddedBytes)
+		return NULL;
+	const char* data = cursor;
+	cursor += paddedBytes;
+	return data;
+}
+
+// hashes everything that determines the synapses generated by connectNetwork(): random seed, group sizes, types,
+// grids and placement, and the configuration of every connection
+uint64_t SNN::getTopologyHash() {
+	uint64_t hash = 14695981039346656037ULL;
+	int blockSize = CONN_BLOCK_SIZE;
+	hashBytes(hash, &connCacheVersion, sizeof(int));
+	hashBytes(hash, &blockSize, sizeof(int));
+	hashBytes(hash, &randSeed_, sizeof(int));
+
+	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++) {
+		GroupConfigMD& grpMD = grpIt->second;
+		GroupConfig& grp = groupConfigMap[grpMD.gGrpId];
+		hashBytes(hash, &grpMD.gGrpId, sizeof(int));
+		hashBytes(hash, &grpMD.netId, sizeof(int));
+		hashBytes(hash, &grpMD.gStartN, sizeof(int));
+		hashBytes(hash, &grpMD.gEndN, sizeof(int));
+		hashBytes(hash, &grp.type, sizeof(grp.type));
+		hashBytes(hash, &grp.numN, sizeof(int));
+		hashBytes(hash, &grp.grid.numX, sizeof(int));
+		hashBytes(hash, &grp.grid.numY, sizeof(int));
+		hashBytes(hash, &grp.grid.numZ, sizeof(int));
+		hashBytes(hash, &grp.grid.distX, sizeof(float));
+		hashBytes(hash, &grp.grid.distY, sizeof(float));
+		hashBytes(hash, &grp.grid.distZ, sizeof(float));
+		hashBytes(hash, &grp.grid.offsetX, sizeof(float));
+		hashBytes(hash, &grp.grid.offsetY, sizeof(float));
+		hashBytes(hash, &grp.grid.offsetZ, sizeof(float));
 	}
 
-	for(int i = groupConfigMDMap[grpSrc].gStartN; i <= groupConfigMDMap[grpSrc].gEndN; i++)  {
-		Point3D loc_i = getNeuronLocation3D(i)*scalePre; // i: adjusted 3D coordinates
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		ConnectConfig& conn = connIt->second;
+		hashBytes(hash, &conn.connId, sizeof(short int));
+		hashBytes(hash, &conn.grpSrc, sizeof(int));
+		hashBytes(hash, &conn.grpDest, sizeof(int));
+		hashBytes(hash, &conn.type, sizeof(conn.type));
+		hashBytes(hash, &conn.connProbability, sizeof(float));
+		hashBytes(hash, &conn.minDelay, sizeof(uint8_t));
+		hashBytes(hash, &conn.maxDelay, sizeof(uint8_t));
+		hashBytes(hash, &conn.initWt, sizeof(float));
+		hashBytes(hash, &conn.maxWt, sizeof(float));
+		hashBytes(hash, &conn.connRadius.radX, sizeof(double));
+		hashBytes(hash, &conn.connRadius.radY, sizeof(double));
+		hashBytes(hash, &conn.connRadius.radZ, sizeof(double));
+	}
 
-		for(int j = groupConfigMDMap[grpDest].gStartN; j <= groupConfigMDMap[grpDest].gEndN; j++) { // j: the temp neuron id
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
+	return hash;
+}
 
-			// make sure point is in RF
-			double rfDist = getRFDist3D(connIt->connRadius,loc_i,loc_j);
-			if (rfDist < 0.0 || rfDist > 1.0)
-				continue;
+// returns the name of the cache file of the current topology, or an empty string if the network cannot be cached
+std::string SNN::getConnectionCacheFileName() {
+	if (connCacheDir_.empty())
+		return "";
 
-			// if rfDist is valid, it returns a number between 0 and 1
-			// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
-			// and rfDist=1 corresponds to 0.1 times max Gaussian weight
-			// so we're looking at gauss = exp(-a*rfDist), where a such that exp(-a)=0.1
-			// solving for a, we find that a = 2.3026
-			double gauss = exp(-2.3026*rfDist);
-			if (gauss < 0.1)
-				continue;
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		if (connIt->second.type == CONN_USER_DEFINED) {
+			KERNEL_INFO("Connection cache is not used, because the network has user-defined connections");
+			return "";
+		}
+	}
 
-			if (drand48() < connIt->connProbability) {
-				float initWt = gauss * connIt->initWt; // scale weight according to gauss distance
-				float maxWt = connIt->maxWt;
-				uint8_t delay = connIt->minDelay + rand() % (connIt->maxDelay - connIt->minDelay + 1);
-				assert((delay >= connIt->minDelay) && (delay <= connIt->maxDelay));
+	char hashStr[17];
+	snprintf(hashStr, sizeof(hashStr), "%016llx", (unsigned long long)getTopologyHash());
+	return connCacheDir_ + "/conn_" + hashStr + ".dat";
+}
 
-				connectNeurons(netId, grpSrc, grpDest, i, j, connIt->connId, initWt, maxWt, delay, externalNetId);
-				connIt->numberOfConnections++;
+void SNN::saveConnectionCache(const std::string& fileName) {
+	// write to a temporary file with a unique name in the same directory first, then rename it: concurrent runs
+	// never map a partially written cache, and never write into each other's temporary file
+	std::string tmpFileName = fileName + ".XXXXXX";
+	FILE* fid = NULL;
+#if !defined(WIN32) && !defined(WIN64)
+	std::vector<char> tmpName(tmpFileName.begin(), tmpFileName.end());
+	tmpName.push_back('\0');
+	int fd = mkstemp(&tmpName[0]);
+	if (fd != -1) {
+		tmpFileName = &tmpName[0];
+		fchmod(fd, 0644); // mkstemp creates the file readable by the owner only
+		fid = fdopen(fd, "wb");
+		if (fid == NULL)
+			close(fd);
+	}
+#else
+	std::stringstream tmpName;
+	tmpName << fileName << "." << GetCurrentProcessId() << "." << this;
+	tmpFileName = tmpName.str();
+	fid = fopen(tmpFileName.c_str(), "wb");
+#endif
+	if (fid == NULL) {
+		KERNEL_WARN("Could not create connection cache file %s", tmpFileName.c_str());
+		return;
+	}
+
+	uint64_t hash = getTopologyHash();
+	int numNets = MAX_NET_PER_SNN;
+	fwrite(connCacheMagic, 1, sizeof(connCacheMagic), fid);
+	fwrite(&connCacheVersion, sizeof(int), 1, fid);
+	fwrite(&numNets, sizeof(int), 1, fid);
+	fwrite(&hash, sizeof(uint64_t), 1, fid);
+
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		SynapseStagingBuffer& synapses = connectionLists[netId];
+
+		int connIdBound = synapses.getConnectionIdBound();
+		int header[2] = {connIdBound, 0};
+		fwrite(header, sizeof(int), 2, fid);
+		for (int connId = 0; connId < connIdBound; connId++) {
+			int info[4] = {0, -1, -1, 1};
+			float wt[2] = {0.0f, 0.0f};
+			if (synapses.hasConnection(connId)) {
+				bool uniform;
+				synapses.getConnection(connId, info[1], info[2], uniform, wt[0], wt[1]);
+				info[0] = 1;
+				info[3] = uniform ? 1 : 0;
 			}
-		}
+			fwrite(info, sizeof(int), 4, fid);
+			fwrite(wt, sizeof(float), 2, fid);
+		}
+
+		int numSynapses = synapses.size();
+		header[0] = numSynapses;
+		fwrite(header, sizeof(int), 2, fid);
+
+		if (numSynapses == 0)
+			continue;
+
+		std::vector<int> intArr(numSynapses);
+		for (int i = 0; i < numSynapses; i++) intArr[i] = synapses.nSrc(i);
+		fwrite(&intArr[0], sizeof(int), numSynapses, fid);
+		writeCachePadding(fid, numSynapses * sizeof(int));
+		for (int i = 0; i < numSynapses; i++) intArr[i] = synapses.nDest(i);
+		fwrite(&intArr[0], sizeof(int), numSynapses, fid);
+		writeCachePadding(fid, numSynapses * sizeof(int));
+		std::vector<int>().swap(intArr);
+
+		std::vector<float> floatArr(numSynapses);
+		for (int i = 0; i < numSynapses; i++) floatArr[i] = synapses.initWt(i);
+		fwrite(&floatArr[0], sizeof(float), numSynapses, fid);
+		writeCachePadding(fid, numSynapses * sizeof(float));
+		for (int i = 0; i < numSynapses; i++) floatArr[i] = synapses.maxWt(i);
+		fwrite(&floatArr[0], sizeof(float), numSynapses, fid);
+		writeCachePadding(fid, numSynapses * sizeof(float));
+		std::vector<float>().swap(floatArr);
+
+		std::vector<short int> connIdArr(numSynapses);
+		for (int i = 0; i < numSynapses; i++) connIdArr[i] = synapses.connId(i);
+		fwrite(&connIdArr[0], sizeof(short int), numSynapses, fid);
+		writeCachePadding(fid, numSynapses * sizeof(short int));
+		std::vector<short int>().swap(connIdArr);
+
+		std::vector<uint8_t> delayArr(numSynapses);
+		for (int i = 0; i < numSynapses; i++) delayArr[i] = synapses.delay(i);
+		fwrite(&delayArr[0], sizeof(uint8_t), numSynapses, fid);
+		writeCachePadding(fid, numSynapses * sizeof(uint8_t));
+	}
+
+	// trailer: number of synapses of every connection, in the order of the connect lists
+	std::vector<int> numSynPerConn;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		std::list<ConnectConfig>::iterator connIt;
+		for (connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++) {
+			numSynPerConn.push_back(connIt->connId);
+			numSynPerConn.push_back(connIt->numberOfConnections);
+		}
+		for (connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++) {
+			numSynPerConn.push_back(connIt->connId);
+			numSynPerConn.push_back(connIt->numberOfConnections);
+		}
+	}
+	int header[2] = {(int)numSynPerConn.size() / 2, 0};
+	fwrite(header, sizeof(int), 2, fid);
+	if (!numSynPerConn.empty())
+		fwrite(&numSynPerConn[0], sizeof(int), numSynPerConn.size(), fid);
+
+	bool failed = ferror(fid) != 0;
+	fclose(fid);
+	if (failed || rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+		KERNEL_WARN("Could not write connection cache file %s", fileName.c_str());
+		remove(tmpFileName.c_str());
+		return;
 	}
 
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
+	KERNEL_INFO("Saved connectivity to connection cache %s", fileName.c_str());
+}
 
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
+// fills the staging buffers from the cache file and returns true, or returns false if there is no valid cache file
+bool SNN::loadConnectionCache(const std::string& fileName) {
+	const char* data = NULL;
+	size_t fileSize = 0;
 
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
+#if !defined(WIN32) && !defined(WIN64)
+	// map the file, the synapse arrays are read in place
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+		fileSize = fileStat.st_size;
+		void* mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		data = (mapped == MAP_FAILED) ? NULL : (const char*)mapped;
+	}
+	close(fd);
+#else
+	std::vector<char> fileBuffer;
+	FILE* fid = fopen(fileName.c_str(), "rb");
+	if (fid == NULL)
+		return false;
+	fseek(fid, 0, SEEK_END);
+	fileSize = ftell(fid);
+	fseek(fid, 0, SEEK_SET);
+	fileBuffer.resize(fileSize);
+	if (fileSize > 0 && fread(&fileBuffer[0], 1, fileSize, fid) == fileSize)
+		data = &fileBuffer[0];
+	fclose(fid);
+#endif
 
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
+	if (data == NULL) {
+		KERNEL_WARN("Could not read connection cache file %s", fileName.c_str());
+		return false;
+	}
 
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
+	bool valid = parseConnectionCache(data, data + fileSize);
+
+#if !defined(WIN32) && !defined(WIN64)
+	munmap((void*)data, fileSize);
+#endif
+
+	if (!valid) {
+		KERNEL_WARN("Ignoring invalid connection cache file %s", fileName.c_str());
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+			connectionLists[netId].clear();
+		return false;
 	}
+
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		std::list<ConnectConfig>::iterator connIt;
+		for (connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++)
+			updateGroupSynapseCounts(netId, connIt, false);
+		for (connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++)
+			updateGroupSynapseCounts(netId, connIt, true);
+	}
+
+	KERNEL_INFO("Loaded connectivity from connection cache %s", fileName.c_str());
+	return true;
 }
 
-void SNN::connectOneToOne(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
+bool SNN::parseConnectionCache(const char* cursor, const char* end) {
+	const char* header = readCacheBytes(cursor, end, sizeof(connCacheMagic) + 2 * sizeof(int) + sizeof(uint64_t));
+	if (header == NULL || memcmp(header, connCacheMagic, sizeof(connCacheMagic)) != 0)
+		return false;
+	int version, numNets;
+	uint64_t hash;
+	memcpy(&version, header + 8, sizeof(int));
+	memcpy(&numNets, header + 12, sizeof(int));
+	memcpy(&hash, header + 16, sizeof(uint64_t));
+	if (version != connCacheVersion || numNets != MAX_NET_PER_SNN || hash != getTopologyHash())
+		return false;
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		SynapseStagingBuffer& synapses = connectionLists[netId];
+		assert(synapses.empty());
+
+		const int* connIdBound = (const int*)readCacheBytes(cursor, end, 2 * sizeof(int));
+		if (connIdBound == NULL || *connIdBound < 0 || *connIdBound > (int)connectConfigMap.size())
+			return false;
+		for (int connId = 0; connId < *connIdBound; connId++) {
+			const char* entry = readCacheBytes(cursor, end, 4 * sizeof(int) + 2 * sizeof(float));
+			if (entry == NULL)
+				return false;
+			const int* info = (const int*)entry;
+			const float* wt = (const float*)(entry + 4 * sizeof(int));
+			if (info[0])
+				synapses.setConnection(connId, info[1], info[2], info[3] != 0, wt[0], wt[1]);
+		}
+
+		const int* numSynapses = (const int*)readCacheBytes(cursor, end, 2 * sizeof(int));
+		if (numSynapses == NULL || *numSynapses < 0)
+			return false;
+		int n = *numSynapses;
+		const int* nSrc = (const int*)readCacheBytes(cursor, end, n * sizeof(int));
+		const int* nDest = (const int*)readCacheBytes(cursor, end, n * sizeof(int));
+		const float* initWt = (const float*)readCacheBytes(cursor, end, n * sizeof(float));
+		const float* maxWt = (const float*)readCacheBytes(cursor, end, n * sizeof(float));
+		const short int* connId = (const short int*)readCacheBytes(cursor, end, n * sizeof(short int));
+		const uint8_t* delay = (const uint8_t*)readCacheBytes(cursor, end, n * sizeof(uint8_t));
+		if (nSrc == NULL || nDest == NULL || initWt == NULL || maxWt == NULL || connId == NULL || delay == NULL)
+			return false;
+
+		for (int i = 0; i < n; i++) {
+			if (!synapses.hasConnection(connId[i]))
+				return false;
+			int grpSrc, grpDest;
+			bool uniform;
+			float connInitWt, connMaxWt;
+			synapses.getConnection(connId[i], grpSrc, grpDest, uniform, connInitWt, connMaxWt);
+			if (uniform)
+				synapses.push(nSrc[i], nDest[i], connId[i], delay[i]);
+			else
+				synapses.push(nSrc[i], nDest[i], connId[i], delay[i], initWt[i], maxWt[i]);
+		}
+	}
+
+	const int* numConns = (const int*)readCacheBytes(cursor, end, 2 * sizeof(int));
+	if (numConns == NULL || *numConns < 0)
+		return false;
+	const int* numSynPerConn = (const int*)readCacheBytes(cursor, end, 2 * (*numConns) * sizeof(int));
+	if (numSynPerConn == NULL)
+		return false;
+
+	// the connect lists have the same order as when the cache was written
+	std::vector<std::list<ConnectConfig>::iterator> connIts;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		std::list<ConnectConfig>::iterator connIt;
+		for (connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++)
+			connIts.push_back(connIt);
+		for (connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++)
+			connIts.push_back(connIt);
 	}
+	if (*numConns != (int)connIts.size())
+		return false;
+	for (int k = 0; k < connIts.size(); k++)
+		if (numSynPerConn[2 * k] != connIts[k]->connId)
+			return false;
 
-	assert( groupConfigMap[grpDest].numN == groupConfigMap[grpSrc].numN);
+	for (int k = 0; k < connIts.size(); k++)
+		connIts[k]->numberOfConnections = numSynPerConn[2 * k + 1];
 
-	// NOTE: RadiusRF does not make a difference here: ignore
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN, gPostN = groupConfigMDMap[grpDest].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++, gPostN++)  {
-		connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-		connIt->numberOfConnections++;
-	}
+	return true;
+}
 
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
+//! set one specific connection from neuron id 'src' to neuron id 'dest'
+inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, uint8_t delay, int externalNetId) {
+	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
+	assert((delay >= connectConfigMap[_connId].minDelay) && (delay <= connectConfigMap[_connId].maxDelay));
 
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
+	// all synapses of the connection share the max weight and initial weight, store them once
+	if (!connectionLists[netId].hasConnection(_connId)) {
+		//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
+		float initWt = connectConfigMap[_connId].initWt;
+		float maxWt = connectConfigMap[_connId].maxWt;
+		// adjust sign of weight based on pre-group (negative if pre is inhibitory)
+		// this access is fine, isExcitatoryGroup() use global grpId
+		maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
+		initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
 
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
+		connectionLists[netId].setConnection(_connId, _grpSrc, _grpDest, true, initWt, maxWt);
+		if (externalNetId >= 0)
+			connectionLists[externalNetId].setConnection(_connId, _grpSrc, _grpDest, true, initWt, maxWt);
+	}
 
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
+	connectionLists[netId].push(_nSrc, _nDest, _connId, delay);
 
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
+	// If the connection is external, copy the connection info to the external network
+	if (externalNetId >= 0)
+		connectionLists[externalNetId].push(_nSrc, _nDest, _connId, delay);
+}
+
+//! set one specific connection from neuron id 'src' to neuron id 'dest'
+inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId) {
+	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
+	if (!connectionLists[netId].hasConnection(_connId)) {
+		connectionLists[netId].setConnection(_connId, _grpSrc, _grpDest, false, 0.0f, 0.0f);
+		if (externalNetId >= 0)
+			connectionLists[externalNetId].setConnection(_connId, _grpSrc, _grpDest, false, 0.0f, 0.0f);
 	}
+
+	// adjust the sign of the weight based on inh/exc connection
+	initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0*fabs(initWt);
+	maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0*fabs(maxWt);
+
+	connectionLists[netId].push(_nSrc, _nDest, _connId, delay, initWt, maxWt);
+
+	// If the connection is external, copy the connection info to the external network
+	if (externalNetId >= 0)
+		connectionLists[externalNetId].push(_nSrc, _nDest, _connId, delay, initWt, maxWt);
 }
 
-// make 'C' random connections from grpSrc to grpDest
-void SNN::connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
+// appends a synapse to a connection block, drawing its delay from the stream of the block
+inline void SNN::addBlockSynapse(ConnectionBlock& block, CounterRNG& rng, int gPreN, int gPostN) {
+	ConnectConfig* conn = block.connConfig;
+	uint8_t delay = conn->minDelay + rng.uniformInt(conn->maxDelay - conn->minDelay + 1);
+	assert((delay >= conn->minDelay) && (delay <= conn->maxDelay));
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
+	block.nSrc.push_back(gPreN);
+	block.nDest.push_back(gPostN);
+	block.delay.push_back(delay);
+}
+
+// make 'C' full connections from grpSrc to grpDest
+void SNN::connectFull(ConnectionBlock& block, CounterRNG& rng) {
+	ConnectConfig* conn = block.connConfig;
+	bool noDirect = (conn->type == CONN_FULL_NO_DIRECT);
+
+	// without RF restriction, there is no need to look at neuron locations
+	bool checkRF = !isRFUnrestricted(conn->connRadius);
+
+	int gPreStart = block.gPreGrpStart;
+	int gPostStart = block.gPostGrpStart;
+	std::vector<int> postInRF;
+	for(int gPreN = block.gPreStart; gPreN <= block.gPreEnd; gPreN++)  {
+		if (checkRF) {
+			// only visit post-neurons whose RF contains the pre-neuron
+			postInRF.clear();
+			findNeuronsInRF(block.gridPost, conn->connRadius, getGridLocation3D(block.gridPre, gPreN - gPreStart), postInRF);
+			for (int k = 0; k < postInRF.size(); k++) {
+				int gPostN = gPostStart + postInRF[k];
+				if (noDirect && gPreN == gPostN)
+					continue;
+
+				addBlockSynapse(block, rng, gPreN, gPostN);
+			}
+		} else {
+			for(int gPostN = block.gPostGrpStart; gPostN <= block.gPostGrpEnd; gPostN++) { // j: the temp neuron id
+				// if flag is set, don't connect direct connections
+				if(noDirect && gPreN == gPostN)
+					continue;
+
+				addBlockSynapse(block, rng, gPreN, gPostN);
+			}
+		}
 	}
+}
+
+void SNN::connectGaussian(ConnectionBlock& block, CounterRNG& rng) {
+	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
+	ConnectConfig* conn = block.connConfig;
+	const Grid3D& grid_i = block.gridPre;
+	const Grid3D& grid_j = block.gridPost;
+	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
+
+	int gPreStart = block.gPreGrpStart;
+	int gPostStart = block.gPostGrpStart;
+	std::vector<int> postInRF;
+	for(int i = block.gPreStart; i <= block.gPreEnd; i++)  {
+		Point3D loc_i = getGridLocation3D(grid_i, i - gPreStart)*scalePre; // i: adjusted 3D coordinates
 
-	int gPreStart = groupConfigMDMap[grpSrc].gStartN;
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++) {
-		Point3D locPre = getNeuronLocation3D(grpSrc, gPreN - gPreStart); // 3D coordinates of i
-		int gPostStart = groupConfigMDMap[grpDest].gStartN;
-		for(int gPostN = groupConfigMDMap[grpDest].gStartN; gPostN <= groupConfigMDMap[grpDest].gEndN; gPostN++) {
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D locPost = getNeuronLocation3D(grpDest, gPostN - gPostStart); // 3D coordinates of j
-			if (!isPoint3DinRF(connIt->connRadius, locPre, locPost))
+		// only visit post-neurons whose RF contains the pre-neuron
+		postInRF.clear();
+		findNeuronsInRF(grid_j, conn->connRadius, loc_i, postInRF);
+		for (int k = 0; k < postInRF.size(); k++) {
+			int j = gPostStart + postInRF[k]; // j: the temp neuron id
+			Point3D loc_j = getGridLocation3D(grid_j, postInRF[k]); // 3D coordinates of j
+
+			// make sure point is in RF
+			double rfDist = getRFDist3D(conn->connRadius,loc_i,loc_j);
+			if (rfDist < 0.0 || rfDist > 1.0)
 				continue;
 
-			if (drand48() < connIt->connProbability) {
-				connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-				connIt->numberOfConnections++;
+			// if rfDist is valid, it returns a number between 0 and 1
+			// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
+			// and rfDist=1 corresponds to 0.1 times max Gaussian weight
+			// so we're looking at gauss = exp(-a*rfDist), where a such that exp(-a)=0.1
+			// solving for a, we find that a = 2.3026
+			double gauss = exp(-2.3026*rfDist);
+			if (gauss < 0.1)
+				continue;
+
+			if (rng.uniform() < conn->connProbability) {
+				addBlockSynapse(block, rng, i, j);
+				block.initWt.push_back(gauss * conn->initWt); // scale weight according to gauss distance
 			}
 		}
 	}
+}
 
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
+void SNN::connectOneToOne(ConnectionBlock& block, CounterRNG& rng) {
+	assert(block.gridPost.N == block.gridPre.N);
 
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
+	// NOTE: RadiusRF does not make a difference here: ignore
+	int gPostOffset = block.gPostGrpStart - block.gPreGrpStart;
+	for(int gPreN = block.gPreStart; gPreN <= block.gPreEnd; gPreN++)
+		addBlockSynapse(block, rng, gPreN, gPreN + gPostOffset);
+}
 
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
+// returns the next candidate after lastCandidate (or -1) that is connected with probability connProb (geometric skip)
+long long SNN::nextRandomCandidate(long long lastCandidate, double connProb, CounterRNG& rng) {
+	if (connProb >= 1.0)
+		return lastCandidate + 1;
+	if (connProb <= 0.0)
+		return LLONG_MAX;
 
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
+	// P(skip >= k) = (1-p)^k; 1-uniform() lies in (0,1], so the log is finite
+	double skip = floor(log(1.0 - rng.uniform()) / log1p(-connProb));
+	if (skip >= (double)(LLONG_MAX / 2))
+		return LLONG_MAX;
+	return lastCandidate + 1 + (long long)skip;
+}
 
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
+// returns true if the RF does not restrict which pre-neurons are connected to a post-neuron
+bool SNN::isRFUnrestricted(const RadiusRF& radius) {
+	return radius.radX < 0 && radius.radY < 0 && radius.radZ < 0;
+}
+
+// make 'C' random connections from grpSrc to grpDest
+void SNN::connectRandom(ConnectionBlock& block, CounterRNG& rng) {
+	ConnectConfig* conn = block.connConfig;
+
+	// Instead of drawing a random number for every (pre, post) pair, draw the number of candidate pairs that are
+	// skipped until the next synapse (geometric skip-sampling), which makes the cost proportional to the number of
+	// synapses created. Candidates are enumerated in (pre, post) order, so synapses are created in the same order as
+	// by visiting every pair.
+	double connProb = conn->connProbability;
+	int gPreStart = block.gPreGrpStart;
+	int gPostStart = block.gPostGrpStart;
+	int numPre = block.gPreEnd - block.gPreStart + 1;
+	int numPost = block.gPostGrpEnd - gPostStart + 1;
+
+	if (isRFUnrestricted(conn->connRadius)) {
+		// every post-neuron is a candidate: skip through the pre x post pairs of the block directly
+		long long numPairs = (long long)numPre * numPost;
+		for (long long pair = nextRandomCandidate(-1, connProb, rng); pair < numPairs; pair = nextRandomCandidate(pair, connProb, rng))
+			addBlockSynapse(block, rng, block.gPreStart + (int)(pair / numPost), gPostStart + (int)(pair % numPost));
+	} else {
+		std::vector<int> candidates; // group-relative ids of post-neurons
+		for (int gPreN = block.gPreStart; gPreN <= block.gPreEnd; gPreN++) {
+			Point3D locPre = getGridLocation3D(block.gridPre, gPreN - gPreStart); // 3D coordinates of i
+
+			// collect the post-neurons whose RF contains the pre-neuron
+			candidates.clear();
+			findNeuronsInRF(block.gridPost, conn->connRadius, locPre, candidates);
+
+			for (long long c = nextRandomCandidate(-1, connProb, rng); c < (long long)candidates.size(); c = nextRandomCandidate(c, connProb, rng))
+				addBlockSynapse(block, rng, gPreN, gPostStart + candidates[c]);
+		}
 	}
 }
 
@@ -4028,32 +4640,7 @@ void SNN::connectUserDefined(int netId, std::list<ConnectConfig>::iterator connI
 		}
 	}
 
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
+	updateGroupSynapseCounts(netId, connIt, isExternal);
 }
 
 //// make 'C' full connections from grpSrc to grpDest
@@ -4235,13 +4822,6 @@ void SNN::deleteRuntimeData() {
 	CUDA_CHECK_ERRORS(cudaThreadSynchronize());
 #endif
 
-	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
-
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -4249,33 +4829,15 @@ void SNN::deleteRuntimeData() {
 			else{ // CPU runtime
 				#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 					deleteRuntimeData_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDeleteRuntimeData_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// run the CPU partitions on the persistent worker pool
+		runCPUWorkerPool(&SNN::helperDeleteRuntimeData_CPU);
+		stopCPUWorkerPool();
 	#endif
 
 #ifndef __NO_CUDA__
@@ -4347,9 +4909,10 @@ void SNN::findMaxNumSynapsesNeurons(int _netId, int& _maxNumPostSynN, int& _maxN
 	}
 
 	// calculate number of pre- and post- connections of each neuron
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[_netId].begin(); connIt != connectionLists[_netId].end(); connIt++) {
-		nSrc = connIt->nSrc + globalToLocalOffset[connIt->grpSrc];
-		nDest = connIt->nDest + globalToLocalOffset[connIt->grpDest];
+	const SynapseStagingBuffer& synapses = connectionLists[_netId];
+	for (int i = 0; i < synapses.size(); i++) {
+		nSrc = synapses.nSrc(i) + globalToLocalOffset[synapses.grpSrc(i)];
+		nDest = synapses.nDest(i) + globalToLocalOffset[synapses.grpDest(i)];
 		assert(nSrc < numNeurons); assert(nDest < numNeurons);
 		tempNpost[nSrc]++;
 		tempNpre[nDest]++;
@@ -4453,6 +5016,10 @@ void SNN::fetchWeightState(int netId, int lGrpId) {
 /*!
  * \brief This function copies spike count of each neuron from device (GPU) memory to main (CPU) memory
  *
+ * Spike counts are only accumulated in the runtime; the copy in managerRuntimeData is brought up-to-date on demand.
+ * A group is skipped if its counts have already been fetched at the current simulation time and have not been
+ * reset since.
+ *
  * \param[in] gGrpId the group id of the global network of which the spike count of each neuron with in the group are copied to manager runtime data
  */
 void SNN::fetchNeuronSpikeCount (int gGrpId) {
@@ -4461,6 +5028,10 @@ void SNN::fetchNeuronSpikeCount (int gGrpId) {
 			fetchNeuronSpikeCount(gGrpId);
 		}
 	} else {
+		// manager copy is still valid
+		if (spikeCntFetchedTime_[gGrpId] == (long int)getSimTime())
+			return;
+
 		int netId = groupConfigMDMap[gGrpId].netId;
 		int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
 		int LtoGOffset = groupConfigMDMap[gGrpId].LtoGOffset;
@@ -4469,6 +5040,8 @@ void SNN::fetchNeuronSpikeCount (int gGrpId) {
 			copyNeuronSpikeCount(netId, lGrpId, &managerRuntimeData, &runtimeData[netId], cudaMemcpyDeviceToHost, false, LtoGOffset);
 		else
 			copyNeuronSpikeCount(netId, lGrpId, &managerRuntimeData, &runtimeData[netId], false, LtoGOffset);
+
+		spikeCntFetchedTime_[gGrpId] = (long int)getSimTime();
 	}
 }
 
@@ -4669,6 +5242,9 @@ void SNN::fetchExtFiringTable(int netId) {
 void SNN::fetchTimeTable(int netId) {
 	assert(netId < MAX_NET_PER_SNN);
 
+	// the manager copy of the spike tables no longer matches any local network
+	spikeTablesFetchedNetId_ = -1;
+
 	if (netId < CPU_RUNTIME_BASE) { // GPU runtime
 		copyTimeTable(netId, cudaMemcpyDeviceToHost);
 	} else {
@@ -4721,139 +5297,116 @@ void SNN::convertExtSpikesD1(int netId, int startIdx, int endIdx, int GtoLOffset
 }
 
 void SNN::routeSpikes() {
-	int firingTableIdxD2, firingTableIdxD1;
-	int GtoLOffset;
+	for (int srcNetId = 0; srcNetId < MAX_NET_PER_SNN; srcNetId++) {
+		if (spikeRoutes[srcNetId].empty())
+			continue;
 
-	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
-		int srcNetId = rteItr->srcNetId;
-		int destNetId = rteItr->destNetId;
+#ifndef __NO_CUDA__
+		// the external firing table of a source network is fetched once for all of its destinations
+		bool isFetched = false;
+#endif
 
-		fetchExtFiringTable(srcNetId);
+		for (std::vector<SpikeRoute>::iterator routeIt = spikeRoutes[srcNetId].begin(); routeIt != spikeRoutes[srcNetId].end(); routeIt++) {
+			int destNetId = routeIt->destNetId;
 
-		fetchTimeTable(destNetId);
-		firingTableIdxD2 = managerRuntimeData.timeTableD2[simTimeMs + glbNetworkConfig.maxDelay + 1];
-		firingTableIdxD1 = managerRuntimeData.timeTableD1[simTimeMs + glbNetworkConfig.maxDelay + 1];
-		//KERNEL_DEBUG("GPU1 D1:%d/D2:%d", firingTableIdxD1, firingTableIdxD2);
-		//printf("srcNetId %d,destNetId %d, D1:%d/D2:%d\n", srcNetId, destNetId, firingTableIdxD1, firingTableIdxD2);
+			if (srcNetId >= CPU_RUNTIME_BASE && destNetId >= CPU_RUNTIME_BASE) {
+				// both runtimes live in host memory, copy and convert all groups in one pass
+				routeSpikes_CPU(srcNetId, *routeIt);
+				continue;
+			}
 
-		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-			pthread_t threads[(2 * networkConfigs[srcNetId].numGroups) + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;
-			ThreadStruct argsThreadRoutine[(2 * networkConfigs[srcNetId].numGroups) + 1]; // same as above, +1 array size
-			int threadCount = 0;
-		#endif
+#ifndef __NO_CUDA__
+			// at least one of the runtimes is a GPU runtime
+			if (!isFetched) {
+				fetchExtFiringTable(srcNetId);
+				isFetched = true;
+			}
 
-		for (int lGrpId = 0; lGrpId < networkConfigs[srcNetId].numGroups; lGrpId++) {
-			if (groupConfigs[srcNetId][lGrpId].hasExternalConnect && managerRuntimeData.extFiringTableEndIdxD2[lGrpId] > 0) {
-				// search GtoLOffset of the neural group at destination local network
-				bool isFound = false;
-				for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[destNetId].begin(); grpIt != groupPartitionLists[destNetId].end(); grpIt++) {
-					if (grpIt->gGrpId == groupConfigs[srcNetId][lGrpId].gGrpId) {
-						GtoLOffset = grpIt->GtoLOffset;
-						isFound = true;
-						break;
-					}
-				}
+			fetchTimeTable(destNetId);
+			int firingTableIdxD2 = managerRuntimeData.timeTableD2[simTimeMs + glbNetworkConfig.maxDelay + 1];
+			int firingTableIdxD1 = managerRuntimeData.timeTableD1[simTimeMs + glbNetworkConfig.maxDelay + 1];
+
+			for (int i = 0; i < routeIt->lGrpIds.size(); i++) {
+				int lGrpId = routeIt->lGrpIds[i];
+				int GtoLOffset = routeIt->GtoLOffsets[i];
 
-				if (isFound) {
+				if (managerRuntimeData.extFiringTableEndIdxD2[lGrpId] > 0) {
 					transferSpikes(runtimeData[destNetId].firingTableD2 + firingTableIdxD2, destNetId,
 						managerRuntimeData.extFiringTableD2[lGrpId], srcNetId,
 						sizeof(int) * managerRuntimeData.extFiringTableEndIdxD2[lGrpId]);
 
-					if (destNetId < CPU_RUNTIME_BASE){
-						convertExtSpikesD2_GPU(destNetId, firingTableIdxD2,
-							firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId],
-							GtoLOffset); // [StartIdx, EndIdx)
-					}
-					else{// CPU runtime
-							#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
-								convertExtSpikesD2_CPU(destNetId, firingTableIdxD2,
-									firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId],
-									GtoLOffset); // [StartIdx, EndIdx)
-							#else // Linux or MAC
-								pthread_attr_t attr;
-								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-								argsThreadRoutine[threadCount].snn_pointer = this;
-								argsThreadRoutine[threadCount].netId = destNetId;
-								argsThreadRoutine[threadCount].lGrpId = 0;
-								argsThreadRoutine[threadCount].startIdx = firingTableIdxD2;
-								argsThreadRoutine[threadCount].endIdx = firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
-								argsThreadRoutine[threadCount].GtoLOffset = GtoLOffset;
-
-								pthread_create(&threads[threadCount], &attr, &SNN::helperConvertExtSpikesD2_CPU, (void*)&argsThreadRoutine[threadCount]);
-								pthread_attr_destroy(&attr);
-								threadCount++;
-							#endif
-					}
+					convertExtSpikesD2(destNetId, firingTableIdxD2,
+						firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId],
+						GtoLOffset); // [StartIdx, EndIdx)
 
 					firingTableIdxD2 += managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
 				}
-			}
-
-			if (groupConfigs[srcNetId][lGrpId].hasExternalConnect && managerRuntimeData.extFiringTableEndIdxD1[lGrpId] > 0) {
-				// search GtoLOffset of the neural group at destination local network
-				bool isFound = false;
-				for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[destNetId].begin(); grpIt != groupPartitionLists[destNetId].end(); grpIt++) {
-					if (grpIt->gGrpId == groupConfigs[srcNetId][lGrpId].gGrpId) {
-						GtoLOffset = grpIt->GtoLOffset;
-						isFound = true;
-						break;
-					}
-				}
 
-				if (isFound) {
+				if (managerRuntimeData.extFiringTableEndIdxD1[lGrpId] > 0) {
 					transferSpikes(runtimeData[destNetId].firingTableD1 + firingTableIdxD1, destNetId,
 						managerRuntimeData.extFiringTableD1[lGrpId], srcNetId,
 						sizeof(int) * managerRuntimeData.extFiringTableEndIdxD1[lGrpId]);
-					if (destNetId < CPU_RUNTIME_BASE){
-						convertExtSpikesD1_GPU(destNetId, firingTableIdxD1,
-							firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId],
-							GtoLOffset); // [StartIdx, EndIdx)
-					}
-					else{// CPU runtime
-						#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
-								convertExtSpikesD1_CPU(destNetId, firingTableIdxD1,
-									firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId],
-									GtoLOffset); // [StartIdx, EndIdx)
-							#else // Linux or MAC
-								pthread_attr_t attr;
-								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-								argsThreadRoutine[threadCount].snn_pointer = this;
-								argsThreadRoutine[threadCount].netId = destNetId;
-								argsThreadRoutine[threadCount].lGrpId = 0;
-								argsThreadRoutine[threadCount].startIdx = firingTableIdxD1;
-								argsThreadRoutine[threadCount].endIdx = firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
-								argsThreadRoutine[threadCount].GtoLOffset = GtoLOffset;
-
-								pthread_create(&threads[threadCount], &attr, &SNN::helperConvertExtSpikesD1_CPU, (void*)&argsThreadRoutine[threadCount]);
-								pthread_attr_destroy(&attr);
-								threadCount++;
-							#endif
-					}
+
+					convertExtSpikesD1(destNetId, firingTableIdxD1,
+						firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId],
+						GtoLOffset); // [StartIdx, EndIdx)
+
 					firingTableIdxD1 += managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
 				}
 			}
-			//KERNEL_DEBUG("GPU1 New D1:%d/D2:%d", firingTableIdxD1, firingTableIdxD2);
+
+			managerRuntimeData.timeTableD2[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD2;
+			managerRuntimeData.timeTableD1[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD1;
+			writeBackTimeTable(destNetId);
+#endif
 		}
+	}
+}
 
-		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
+// precomputes the routes of routeSpikes() from spikeRoutingTable: for every pair of source and destination
+// networks, the groups of the source network that send spikes and their GtoLOffset in the destination network
+void SNN::generateSpikeRoutes() {
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		spikeRoutes[netId].clear();
+
+	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
+		int srcNetId = rteItr->srcNetId;
+		int destNetId = rteItr->destNetId;
+		assert(srcNetId >= 0 && srcNetId < MAX_NET_PER_SNN && destNetId >= 0 && destNetId < MAX_NET_PER_SNN);
+
+		// spikeRoutingTable may list a pair of networks more than once
+		bool isDuplicate = false;
+		for (int i = 0; i < spikeRoutes[srcNetId].size(); i++)
+			isDuplicate |= (spikeRoutes[srcNetId][i].destNetId == destNetId);
+		if (isDuplicate)
+			continue;
+
+		SpikeRoute route(destNetId);
+		for (std::list<GroupConfigMD>::iterator srcGrpIt = groupPartitionLists[srcNetId].begin(); srcGrpIt != groupPartitionLists[srcNetId].end(); srcGrpIt++) {
+			if (srcGrpIt->netId != srcNetId || !srcGrpIt->hasExternalConnect)
+				continue;
+
+			// the group is routed if it has a copy in the destination network
+			for (std::list<GroupConfigMD>::iterator destGrpIt = groupPartitionLists[destNetId].begin(); destGrpIt != groupPartitionLists[destNetId].end(); destGrpIt++) {
+				if (destGrpIt->gGrpId == srcGrpIt->gGrpId) {
+					route.lGrpIds.push_back(srcGrpIt->lGrpId);
+					route.GtoLOffsets.push_back(destGrpIt->GtoLOffset);
+					break;
+				}
 			}
-		#endif
+		}
 
-		managerRuntimeData.timeTableD2[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD2;
-		managerRuntimeData.timeTableD1[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD1;
-		writeBackTimeTable(destNetId);
+		// keep the order of the local group ids, i.e., the order in which routeSpikes() used to fill the firing table
+		std::vector<std::pair<int, int> > groups;
+		for (int i = 0; i < route.lGrpIds.size(); i++)
+			groups.push_back(std::make_pair(route.lGrpIds[i], route.GtoLOffsets[i]));
+		std::sort(groups.begin(), groups.end());
+		for (int i = 0; i < groups.size(); i++) {
+			route.lGrpIds[i] = groups[i].first;
+			route.GtoLOffsets[i] = groups[i].second;
+		}
+
+		spikeRoutes[srcNetId].push_back(route);
 	}
 }
 
@@ -5093,12 +5646,66 @@ double SNN::getRFDist3D(const RadiusRF& radius, const Point3D& pre, const Point3
 	return rfDist;
 }
 
+// appends the (group-relative) ids of all neurons on a group's grid whose RF contains the location pre, in increasing
+// order. Instead of testing every neuron of the group, the index range along each axis of the group's Grid3D is
+// derived from the RF radius, so only neurons in the bounding box of the RF ellipsoid (narrowed row by row along x)
+// are tested with SNN::isPoint3DinRF.
+void SNN::findNeuronsInRF(const Grid3D& grid, const RadiusRF& radius, const Point3D& pre, std::vector<int>& relNeurIds) {
+	int loY, hiY, loZ, hiZ;
+	getGridIndexRangeInRF(grid.numY, grid.distY, grid.offsetY, pre.y, radius.radY, loY, hiY);
+	getGridIndexRangeInRF(grid.numZ, grid.distZ, grid.offsetZ, pre.z, radius.radZ, loZ, hiZ);
+
+	for (int intZ = loZ; intZ <= hiZ; intZ++) {
+		double dz = pre.z - (grid.distZ * intZ + grid.offsetZ);
+		double zTerm = (radius.radZ <= 0) ? 0.0 : dz * dz / (radius.radZ * radius.radZ);
+		for (int intY = loY; intY <= hiY; intY++) {
+			double dy = pre.y - (grid.distY * intY + grid.offsetY);
+			double yTerm = (radius.radY <= 0) ? 0.0 : dy * dy / (radius.radY * radius.radY);
+
+			// remaining extent of the ellipsoid along x in this row
+			double remaining = 1.0 - yTerm - zTerm;
+			if (remaining < -1e-9)
+				continue;
+			double halfWidthX = (radius.radX <= 0) ? radius.radX : radius.radX * sqrt(fmax(remaining, 0.0));
+
+			int loX, hiX;
+			getGridIndexRangeInRF(grid.numX, grid.distX, grid.offsetX, pre.x, halfWidthX, loX, hiX);
+			for (int intX = loX; intX <= hiX; intX++) {
+				int relNeurId = intX + grid.numX * (intY + grid.numY * intZ);
+				if (isPoint3DinRF(radius, pre, getGridLocation3D(grid, relNeurId)))
+					relNeurIds.push_back(relNeurId);
+			}
+		}
+	}
+}
+
+// computes a conservative range [lo,hi] of grid indices along one axis whose coordinates lie within rad of loc:
+// rad < 0 means the axis is unrestricted, rad == 0 means the coordinate must match. The bounds are rounded outwards,
+// so the exact test is left to the caller.
+void SNN::getGridIndexRangeInRF(int num, float dist, float offset, double loc, double rad, int& lo, int& hi) {
+	if (rad < 0) {
+		lo = 0;
+		hi = num - 1;
+		return;
+	}
+
+	double loIdx = floor((loc - rad - offset) / dist);
+	double hiIdx = ceil((loc + rad - offset) / dist);
+	lo = (int)fmax(loIdx, 0.0);
+	hi = (int)fmin(hiIdx, (double)(num - 1));
+}
+
 void SNN::partitionSNN() {
 	int numAssignedNeurons[MAX_NET_PER_SNN] = {0};
 
 	// get number of available GPU card(s) in the present machine
 	numAvailableGPUs = configGPUDevice();
 
+	// let the partitioner place the groups without a preferred partition
+	std::map<int, int> hybridNetIds;
+	if (preferredSimMode_ == HYBRID_MODE)
+		partitionHybridSNN(hybridNetIds);
+
 	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++) {
 		// assign a group to the GPU specified by users
 		int gGrpId = grpIt->second.gGrpId;
@@ -5121,10 +5728,10 @@ void SNN::partitionSNN() {
 				numAssignedNeurons[GPU_RUNTIME_BASE] += groupConfigMap[gGrpId].numN;
 				groupPartitionLists[GPU_RUNTIME_BASE].push_back(grpIt->second); // Copy by value, create a copy
 			} else  if (preferredSimMode_ == HYBRID_MODE) {
-				// TODO: implement partition algorithm, use naive partition for now (allocate to CPU 0)
-				grpIt->second.netId = CPU_RUNTIME_BASE; // CPU 0
-				numAssignedNeurons[CPU_RUNTIME_BASE] += groupConfigMap[gGrpId].numN;
-				groupPartitionLists[CPU_RUNTIME_BASE].push_back(grpIt->second); // Copy by value, create a copy
+				netId = hybridNetIds[gGrpId];
+				grpIt->second.netId = netId;
+				numAssignedNeurons[netId] += groupConfigMap[gGrpId].numN;
+				groupPartitionLists[netId].push_back(grpIt->second); // Copy by value, create a copy
 			} else {
 				KERNEL_ERROR("Unkown simulation mode");
 				exitSimulation(-1);
@@ -5239,7 +5846,13 @@ void SNN::partitionSNN() {
 	// update ConnectConfig::numberOfConnections
 	// update GroupConfig::numPostSynapses, GroupConfig::numPreSynapses
 	if (loadSimFID == NULL) {
-		connectNetwork();
+		// reuse the synapses of an earlier run with the same topology if possible
+		connCacheFile_ = getConnectionCacheFileName();
+		if (connCacheFile_.empty() || !loadConnectionCache(connCacheFile_)) {
+			connectNetwork();
+			if (!connCacheFile_.empty())
+				saveConnectionCache(connCacheFile_);
+		}
 	} else {
 		KERNEL_INFO("Load Simulation");
 		loadSimulation_internal(false);  // true or false doesn't matter here
@@ -5269,9 +5882,317 @@ void SNN::partitionSNN() {
 	// print spike routing table
 	printSikeRoutingInfo();
 
+	// precompute the per-destination routes used by routeSpikes()
+	generateSpikeRoutes();
+
 	snnState = PARTITIONED_SNN;
 }
 
+// estimates the number of synapses a connection will generate, before the connections are actually made
+double SNN::estimateNumSynapses(const ConnectConfig& connConfig) {
+	const GroupConfig& src = groupConfigMap[connConfig.grpSrc];
+	const GroupConfig& dest = groupConfigMap[connConfig.grpDest];
+	double numPairs;
+
+	switch (connConfig.type) {
+	case CONN_ONE_TO_ONE:
+		numPairs = std::min(src.numN, dest.numN);
+		break;
+	case CONN_FULL_NO_DIRECT:
+		numPairs = (double)src.numN * dest.numN - std::min(src.numN, dest.numN);
+		break;
+	default:
+		numPairs = (double)src.numN * dest.numN;
+		// a bounded receptive field only reaches a fraction of the post-synaptic grid
+		if (connConfig.connRadius.radX >= 0)
+			numPairs *= std::min(1.0, (2.0 * connConfig.connRadius.radX + 1.0) / dest.grid.numX);
+		if (connConfig.connRadius.radY >= 0)
+			numPairs *= std::min(1.0, (2.0 * connConfig.connRadius.radY + 1.0) / dest.grid.numY);
+		if (connConfig.connRadius.radZ >= 0)
+			numPairs *= std::min(1.0, (2.0 * connConfig.connRadius.radZ + 1.0) / dest.grid.numZ);
+		break;
+	}
+
+	return numPairs * connConfig.connProbability;
+}
+
+// Places the groups without a preferred partition on the CPU partitions in HYBRID_MODE.
+// The work of a group is estimated by its number of neurons, its incoming synapses (spike delivery) and
+// its outgoing synapses (expected spike traffic); each measure is normalized by its network total. For every
+// number of partitions up to one per core, the groups are placed greedily, heaviest first, on the partition
+// they exchange the most spikes with among the partitions that stay within the balance limit, and are then
+// moved between partitions as long as this reduces the spike traffic across partitions (i.e., through
+// spikeRoutingTable). The plan with the lowest cost is kept and reported. The cost weighs the share of the CPU work
+// on the busiest CPU partition against the share of the spike traffic routed across partitions, both in [0,1].
+// Only CPU partitions are candidates: GPU partitions hold the groups pinned to them, which count as neighbors
+// for the spike traffic but not for the load, since their work does not change with the plan. A free group that
+// would have to follow a compartmental partner onto a GPU partition is rejected.
+void SNN::partitionHybridSNN(std::map<int, int>& hybridNetIds) {
+	const double maxImbalance = 0.05; // allowed load above the average load of a partition
+	// routing a spike to another partition only copies it into the firing table of the destination, which is much
+	// cheaper than integrating a neuron, so the load share dominates the cost
+	const double loadCostWeight = 0.75;
+	const double trafficCostWeight = 0.25;
+
+	// groups connected by compartmental connections must share a partition and are placed as one unit
+	std::map<int, int> unitOf; // gGrpId -> representative gGrpId of its unit
+	std::map<int, int> fixedNetId; // representative gGrpId -> netId required by a pinned compartment partner
+	for (std::map<int, GroupConfig>::iterator grpIt = groupConfigMap.begin(); grpIt != groupConfigMap.end(); grpIt++) {
+		if (grpIt->second.preferredNetId == ANY)
+			unitOf[grpIt->first] = grpIt->first;
+	}
+
+	for (std::map<int, compConnectConfig>::iterator connIt = compConnectConfigMap.begin(); connIt != compConnectConfigMap.end(); connIt++) {
+		int grpA = connIt->second.grpSrc;
+		int grpB = connIt->second.grpDest;
+		bool freeA = unitOf.count(grpA) > 0;
+		bool freeB = unitOf.count(grpB) > 0;
+		if (freeA && freeB) {
+			int unitA = unitOf[grpA], unitB = unitOf[grpB];
+			if (unitA != unitB) {
+				for (std::map<int, int>::iterator it = unitOf.begin(); it != unitOf.end(); it++)
+					if (it->second == unitB)
+						it->second = unitA;
+				if (fixedNetId.count(unitB)) {
+					fixedNetId[unitA] = fixedNetId[unitB];
+					fixedNetId.erase(unitB);
+				}
+			}
+		} else if (freeA || freeB) {
+			int freeGrp = freeA ? grpA : grpB;
+			int pinnedGrp = freeA ? grpB : grpA;
+			if (groupConfigMap[pinnedGrp].preferredNetId < CPU_RUNTIME_BASE) {
+				KERNEL_ERROR("Group %s has no preferred partition but is connected to the compartments of group %s on "
+					"GPU %d. Groups without a preferred partition are only placed on CPU partitions, please assign "
+					"a partition to group %s.", groupConfigMap[freeGrp].grpName.c_str(),
+					groupConfigMap[pinnedGrp].grpName.c_str(), groupConfigMap[pinnedGrp].preferredNetId - GPU_RUNTIME_BASE,
+					groupConfigMap[freeGrp].grpName.c_str());
+				exitSimulation(1);
+			}
+			fixedNetId[unitOf[freeGrp]] = groupConfigMap[pinnedGrp].preferredNetId;
+		}
+	}
+
+	if (unitOf.empty())
+		return;
+
+	// estimate the work of every group
+	std::map<int, double> numSynIn, numSynOut;
+	double totalN = 0.0, totalSynIn = 0.0;
+	for (std::map<int, GroupConfig>::iterator grpIt = groupConfigMap.begin(); grpIt != groupConfigMap.end(); grpIt++)
+		totalN += grpIt->second.numN;
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		double numSyn = estimateNumSynapses(connIt->second);
+		numSynIn[connIt->second.grpDest] += numSyn;
+		numSynOut[connIt->second.grpSrc] += numSyn;
+		totalSynIn += numSyn;
+	}
+
+	std::map<int, double> work;
+	for (std::map<int, GroupConfig>::iterator grpIt = groupConfigMap.begin(); grpIt != groupConfigMap.end(); grpIt++) {
+		int gGrpId = grpIt->first;
+		work[gGrpId] = grpIt->second.numN / totalN;
+		if (totalSynIn > 0.0)
+			work[gGrpId] += (numSynIn[gGrpId] + numSynOut[gGrpId]) / totalSynIn;
+	}
+
+	// collect the units, in the order of their representative group
+	std::map<int, std::vector<int> > units; // representative gGrpId -> gGrpIds
+	std::map<int, double> unitWork;
+	int numFreeN = 0;
+	for (std::map<int, int>::iterator it = unitOf.begin(); it != unitOf.end(); it++) {
+		units[it->second].push_back(it->first);
+		unitWork[it->second] += work[it->first];
+		numFreeN += groupConfigMap[it->first].numN;
+	}
+
+	// use at most one CPU partition per core, and do not split the network into partitions that are too small to pay off
+#if !defined(WIN32) && !defined(WIN64)
+	int numAvailableCores = NUM_CPU_CORES;
+#else
+	int numAvailableCores = 1;
+#endif
+	if (numCPUCoresUser > 0)
+		numAvailableCores = numCPUCoresUser;
+	int maxPartitions = std::min(numAvailableCores, MAX_NET_PER_SNN - CPU_RUNTIME_BASE);
+	maxPartitions = std::min(maxPartitions, (int)units.size());
+	maxPartitions = std::min(maxPartitions, numFreeN / MIN_NEURONS_PER_CPU_THREAD);
+	maxPartitions = std::max(maxPartitions, 1);
+
+	// spike traffic between groups, a connection routes the spikes of its source group
+	std::map<int, std::map<int, double> > traffic;
+	double totalTraffic = 0.0;
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		int grpSrc = connIt->second.grpSrc, grpDest = connIt->second.grpDest;
+		totalTraffic += groupConfigMap[grpSrc].numN;
+		if (grpSrc == grpDest)
+			continue;
+		traffic[grpSrc][grpDest] += groupConfigMap[grpSrc].numN;
+		traffic[grpDest][grpSrc] += groupConfigMap[grpSrc].numN;
+	}
+
+	// the units are placed heaviest first
+	std::vector<std::pair<double, int> > order;
+	for (std::map<int, std::vector<int> >::iterator unitIt = units.begin(); unitIt != units.end(); unitIt++)
+		order.push_back(std::make_pair(-unitWork[unitIt->first], unitIt->first));
+	std::sort(order.begin(), order.end());
+
+	// try every number of partitions and keep the plan with the lowest cost
+	std::map<int, int> netIdOf;
+	double load[MAX_NET_PER_SNN];
+	double totalLoad = 0.0;
+	int numPartitions = 0;
+	double bestCost = 0.0;
+	for (int numTrialPartitions = 1; numTrialPartitions <= maxPartitions; numTrialPartitions++) {
+		// pinned groups keep their preferred partition
+		std::map<int, int> trialNetIdOf;
+		double trialLoad[MAX_NET_PER_SNN] = {0.0};
+		double trialTotalLoad = 0.0;
+		for (std::map<int, GroupConfig>::iterator grpIt = groupConfigMap.begin(); grpIt != groupConfigMap.end(); grpIt++) {
+			int netId = grpIt->second.preferredNetId;
+			if (netId != ANY) {
+				trialNetIdOf[grpIt->first] = netId;
+				trialLoad[netId] += work[grpIt->first];
+				if (netId >= CPU_RUNTIME_BASE && netId < CPU_RUNTIME_BASE + numTrialPartitions)
+					trialTotalLoad += work[grpIt->first];
+			} else {
+				trialTotalLoad += work[grpIt->first];
+			}
+		}
+		double maxLoad = (1.0 + maxImbalance) * trialTotalLoad / numTrialPartitions;
+
+		// greedy placement: prefer partitions within the balance limit, then the most local traffic, then the least load
+		for (int i = 0; i < order.size(); i++) {
+			int unit = order[i].second;
+			int bestNetId = -1;
+
+			if (fixedNetId.count(unit)) {
+				bestNetId = fixedNetId[unit];
+			} else {
+				double bestTraffic = 0.0;
+				for (int netId = CPU_RUNTIME_BASE; netId < CPU_RUNTIME_BASE + numTrialPartitions; netId++) {
+					double localTraffic = 0.0;
+					for (int g = 0; g < units[unit].size(); g++) {
+						std::map<int, double>& neighbors = traffic[units[unit][g]];
+						for (std::map<int, double>::iterator nIt = neighbors.begin(); nIt != neighbors.end(); nIt++)
+							if (trialNetIdOf.count(nIt->first) && trialNetIdOf[nIt->first] == netId)
+								localTraffic += nIt->second;
+					}
+
+					bool better;
+					bool fits = trialLoad[netId] + unitWork[unit] <= maxLoad;
+					if (bestNetId == -1)
+						better = true;
+					else if (fits != (trialLoad[bestNetId] + unitWork[unit] <= maxLoad))
+						better = fits;
+					else if (localTraffic != bestTraffic)
+						better = localTraffic > bestTraffic;
+					else
+						better = trialLoad[netId] < trialLoad[bestNetId];
+
+					if (better) {
+						bestNetId = netId;
+						bestTraffic = localTraffic;
+					}
+				}
+			}
+
+			for (int g = 0; g < units[unit].size(); g++)
+				trialNetIdOf[units[unit][g]] = bestNetId;
+			trialLoad[bestNetId] += unitWork[unit];
+		}
+
+		// refinement: move a unit to the partition it exchanges the most spikes with while the balance holds
+		for (int pass = 0; pass < 10; pass++) {
+			bool moved = false;
+			for (int i = 0; i < order.size(); i++) {
+				int unit = order[i].second;
+				if (fixedNetId.count(unit))
+					continue;
+
+				int curNetId = trialNetIdOf[units[unit][0]];
+				double netTraffic[MAX_NET_PER_SNN] = {0.0};
+				for (int g = 0; g < units[unit].size(); g++) {
+					std::map<int, double>& neighbors = traffic[units[unit][g]];
+					for (std::map<int, double>::iterator nIt = neighbors.begin(); nIt != neighbors.end(); nIt++)
+						if (unitOf.count(nIt->first) == 0 || unitOf[nIt->first] != unit)
+							netTraffic[trialNetIdOf[nIt->first]] += nIt->second;
+				}
+
+				int bestNetId = curNetId;
+				for (int netId = CPU_RUNTIME_BASE; netId < CPU_RUNTIME_BASE + numTrialPartitions; netId++) {
+					if (netId != curNetId && netTraffic[netId] > netTraffic[bestNetId] && trialLoad[netId] + unitWork[unit] <= maxLoad)
+						bestNetId = netId;
+				}
+
+				if (bestNetId != curNetId) {
+					for (int g = 0; g < units[unit].size(); g++)
+						trialNetIdOf[units[unit][g]] = bestNetId;
+					trialLoad[curNetId] -= unitWork[unit];
+					trialLoad[bestNetId] += unitWork[unit];
+					moved = true;
+				}
+			}
+			if (!moved)
+				break;
+		}
+
+		// the share of the CPU work on the busiest CPU partition (including partitions that only hold pinned groups),
+		// and the share of the spike traffic that crosses partitions (including GPU partitions)
+		double cpuLoad = 0.0, busiestLoad = 0.0, cutTraffic = 0.0;
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+			cpuLoad += trialLoad[netId];
+			busiestLoad = std::max(busiestLoad, trialLoad[netId]);
+		}
+		for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++)
+			if (trialNetIdOf[connIt->second.grpSrc] != trialNetIdOf[connIt->second.grpDest])
+				cutTraffic += groupConfigMap[connIt->second.grpSrc].numN;
+		double loadShare = (cpuLoad > 0.0) ? busiestLoad / cpuLoad : 0.0;
+		double trafficShare = (totalTraffic > 0.0) ? cutTraffic / totalTraffic : 0.0;
+		double cost = loadCostWeight * loadShare + trafficCostWeight * trafficShare;
+
+		if (numPartitions == 0 || cost < bestCost) {
+			numPartitions = numTrialPartitions;
+			bestCost = cost;
+			netIdOf = trialNetIdOf;
+			memcpy(load, trialLoad, sizeof(double) * MAX_NET_PER_SNN);
+			totalLoad = trialTotalLoad;
+		}
+	}
+
+	// report the plan
+	int numCutConnections = 0;
+	double cutTraffic = 0.0;
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		if (netIdOf[connIt->second.grpSrc] != netIdOf[connIt->second.grpDest]) {
+			numCutConnections++;
+			cutTraffic += groupConfigMap[connIt->second.grpSrc].numN;
+		}
+	}
+
+	KERNEL_INFO("\n");
+	KERNEL_INFO("***************************** Hybrid Partition Plan ***********************************");
+	for (int netId = CPU_RUNTIME_BASE; netId < CPU_RUNTIME_BASE + numPartitions; netId++) {
+		int numGrps = 0, numN = 0;
+		double numSyn = 0.0;
+		for (std::map<int, int>::iterator it = netIdOf.begin(); it != netIdOf.end(); it++) {
+			if (it->second == netId) {
+				numGrps++;
+				numN += groupConfigMap[it->first].numN;
+				numSyn += numSynIn[it->first];
+			}
+		}
+		KERNEL_INFO("CPU %d: %d group(s), %d neuron(s), ~%.0f synapse(s), load %.1f%%", netId - CPU_RUNTIME_BASE, numGrps,
+			numN, numSyn, 100.0 * load[netId] / totalLoad);
+	}
+	for (std::map<int, int>::iterator it = unitOf.begin(); it != unitOf.end(); it++)
+		KERNEL_DEBUG("Group %s(%d) -> CPU %d", groupConfigMap[it->first].grpName.c_str(), it->first, netIdOf[it->first] - CPU_RUNTIME_BASE);
+	KERNEL_INFO("Connections across partitions: %d (routed spike sources ~%.0f neuron(s))", numCutConnections, cutTraffic);
+
+	for (std::map<int, int>::iterator it = unitOf.begin(); it != unitOf.end(); it++)
+		hybridNetIds[it->first] = netIdOf[it->first];
+}
+
 int SNN::loadSimulation_internal(bool onlyPlastic) {
 	// TSC: so that we can restore the file position later...
 	// MB: not sure why though...
@@ -5291,17 +6212,18 @@ int SNN::loadSimulation_internal(bool onlyPlastic) {
 	// read file signature
 	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
 	readErr |= (result!=1);
-	if (tmpInt != 294338571) {
+	if (tmpInt != SIM_FILE_SIGNATURE) {
 		KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
 			"simulation file created with CARLsim::saveSimulation.");
 		exitSimulation(-1);
 	}
 
 	// read file version number
-	result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
+	float fileVersion;
+	result = fread(&fileVersion, sizeof(float), 1, loadSimFID);
 	readErr |= (result!=1);
-	if (tmpFloat > 0.3f) {
-		KERNEL_ERROR("loadSimulation: Unsupported version number (%f)",tmpFloat);
+	if (fileVersion > SIM_FILE_VERSION) {
+		KERNEL_ERROR("loadSimulation: Unsupported version number (%f)",fileVersion);
 		exitSimulation(-1);
 	}
 
@@ -5447,6 +6369,14 @@ int SNN::loadSimulation_internal(bool onlyPlastic) {
 	//		}
 
 	// ------- read synapse information ----------------
+	if (fileVersion > 0.35f) {
+		// version 0.4 and later: bulk arrays
+		loadSimulationSynapses_internal();
+		fseek(loadSimFID,file_position,SEEK_SET);
+		return 0;
+	}
+
+	// version 0.3: one record per synapse
 	int net_count = 0;
 	result = fread(&net_count, sizeof(int), 1, loadSimFID);
 	readErr |= (result!=1);
@@ -5590,6 +6520,146 @@ int SNN::loadSimulation_internal(bool onlyPlastic) {
 	return 0;
 }
 
+// reads the synapse part of a file of version 0.4 or later: the section table is read with fread, then the file is
+// mapped and the synapses are connected straight from the bulk arrays
+void SNN::loadSimulationSynapses_internal() {
+	int sectionHeader[2];
+	if (fread(sectionHeader, sizeof(int), 2, loadSimFID) != 2)
+		return; // file was saved without synapse info
+	int numSynapses = sectionHeader[0];
+	int numSections = sectionHeader[1];
+	fseek(loadSimFID, (ftell(loadSimFID) + 7) / 8 * 8, SEEK_SET);
+
+	const int sectionElemSize[NUM_SIM_SECTIONS] = {sizeof(int), sizeof(int), sizeof(int), sizeof(int),
+		sizeof(int), sizeof(float), sizeof(float), sizeof(uint8_t)};
+	long long sectionOffset[NUM_SIM_SECTIONS];
+	for (int s = 0; s < NUM_SIM_SECTIONS; s++)
+		sectionOffset[s] = -1;
+
+	for (int i = 0; i < numSections; i++) {
+		int sectionInfo[2];
+		long long sectionPos[2];
+		if (fread(sectionInfo, sizeof(int), 2, loadSimFID) != 2 || fread(sectionPos, sizeof(long long), 2, loadSimFID) != 2) {
+			KERNEL_ERROR("loadSimulation: Error while reading section table");
+			exitSimulation(-1);
+		}
+
+		// skip sections written by later versions
+		int s = sectionInfo[0];
+		if (s < 0 || s >= NUM_SIM_SECTIONS)
+			continue;
+		if (sectionInfo[1] != sectionElemSize[s] || sectionPos[1] != numSynapses) {
+			KERNEL_ERROR("loadSimulation: Section %d has an unexpected size", s);
+			exitSimulation(-1);
+		}
+		sectionOffset[s] = sectionPos[0];
+	}
+
+	fseek(loadSimFID, 0, SEEK_END);
+	long long fileSize = ftell(loadSimFID);
+	for (int s = 0; s < NUM_SIM_SECTIONS; s++) {
+		if (sectionOffset[s] < 0 || sectionOffset[s] + (long long)numSynapses * sectionElemSize[s] > fileSize) {
+			KERNEL_ERROR("loadSimulation: Section %d is missing or truncated", s);
+			exitSimulation(-1);
+		}
+	}
+
+	if (numSynapses == 0)
+		return;
+
+	const char* data = NULL;
+#if !defined(WIN32) && !defined(WIN64)
+	void* mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileno(loadSimFID), 0);
+	if (mapped != MAP_FAILED)
+		data = (const char*)mapped;
+#else
+	std::vector<char> fileBuffer(fileSize);
+	fseek(loadSimFID, 0, SEEK_SET);
+	if (fread(&fileBuffer[0], 1, fileSize, loadSimFID) == fileSize)
+		data = &fileBuffer[0];
+#endif
+	if (data == NULL) {
+		KERNEL_ERROR("loadSimulation: Error while reading synapse sections");
+		exitSimulation(-1);
+	}
+
+	const int* grpIdPreArr = (const int*)(data + sectionOffset[SIM_SECTION_GRP_ID_PRE]);
+	const int* grpIdPostArr = (const int*)(data + sectionOffset[SIM_SECTION_GRP_ID_POST]);
+	const int* nIdPreArr = (const int*)(data + sectionOffset[SIM_SECTION_NEUR_ID_PRE]);
+	const int* nIdPostArr = (const int*)(data + sectionOffset[SIM_SECTION_NEUR_ID_POST]);
+	const int* connIdArr = (const int*)(data + sectionOffset[SIM_SECTION_CONN_ID]);
+	const float* wtArr = (const float*)(data + sectionOffset[SIM_SECTION_WEIGHT]);
+	const float* maxWtArr = (const float*)(data + sectionOffset[SIM_SECTION_MAX_WEIGHT]);
+	const uint8_t* delayArr = (const uint8_t*)(data + sectionOffset[SIM_SECTION_DELAY]);
+
+	// look up the connect list of every connection once
+	std::vector<std::list<ConnectConfig>::iterator> connIts(numConnections);
+	std::vector<int> connNetId(numConnections, -1);
+	std::vector<bool> connIsExternal(numConnections, false);
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		std::list<ConnectConfig>::iterator connIt;
+		for (connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++) {
+			connIts[connIt->connId] = connIt;
+			connNetId[connIt->connId] = netId;
+		}
+		for (connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++) {
+			connIts[connIt->connId] = connIt;
+			connNetId[connIt->connId] = netId;
+			connIsExternal[connIt->connId] = true;
+		}
+	}
+
+	for (int i = 0; i < numSynapses; i++) {
+		int connId = connIdArr[i];
+		int gGrpIdPre = grpIdPreArr[i];
+		int gGrpIdPost = grpIdPostArr[i];
+
+		// check connection
+		if (connId < 0 || connId >= numConnections || connNetId[connId] < 0) {
+			KERNEL_ERROR("loadSimulation: connection %d in file does not exist in simulation.", connId);
+			exitSimulation(-1);
+		}
+
+		if (connectConfigMap[connId].grpSrc != gGrpIdPre) {
+			KERNEL_ERROR("loadSimulation: source group in file (%d) and in simulation (%d) for connection %d don't match.",
+				gGrpIdPre , connectConfigMap[connId].grpSrc, connId);
+			exitSimulation(-1);
+		}
+
+		if (connectConfigMap[connId].grpDest != gGrpIdPost) {
+			KERNEL_ERROR("loadSimulation: dest group in file (%d) and in simulation (%d) for connection %d don't match.",
+				gGrpIdPost , connectConfigMap[connId].grpDest, connId);
+			exitSimulation(-1);
+		}
+
+		if (nIdPreArr[i] < 0 || nIdPreArr[i] >= groupConfigMap[gGrpIdPre].numN || nIdPostArr[i] < 0
+			|| nIdPostArr[i] >= groupConfigMap[gGrpIdPost].numN || delayArr[i] < 1 || delayArr[i] > MAX_SYN_DELAY) {
+			KERNEL_ERROR("loadSimulation: invalid synapse %d of connection %d in file.", i, connId);
+			exitSimulation(-1);
+		}
+
+		// connect synapse
+		int netIdPre = groupConfigMDMap[gGrpIdPre].netId;
+		int netIdPost = groupConfigMDMap[gGrpIdPost].netId;
+		assert(connNetId[connId] == netIdPre && connIsExternal[connId] == (netIdPre != netIdPost));
+		connectNeurons(netIdPre, gGrpIdPre, gGrpIdPost, groupConfigMDMap[gGrpIdPre].gStartN + nIdPreArr[i],
+			groupConfigMDMap[gGrpIdPost].gStartN + nIdPostArr[i], connId, wtArr[i], maxWtArr[i], delayArr[i],
+			connIsExternal[connId] ? netIdPost : -1);
+		connIts[connId]->numberOfConnections++;
+	}
+
+#if !defined(WIN32) && !defined(WIN64)
+	munmap(mapped, fileSize);
+#endif
+
+	// update numPostSynapses and numPreSynapses of the groups once per connection
+	for (int connId = 0; connId < numConnections; connId++)
+		if (connNetId[connId] >= 0)
+			updateGroupSynapseCounts(connNetId[connId], connIts[connId], connIsExternal[connId]);
+
+	KERNEL_INFO("Loaded %d synapses", numSynapses);
+}
+
 void SNN::generateRuntimeSNN() {
 	// 1. genearte configurations for the simulation
 	// generate (copy) group configs from groupPartitionLists[]
@@ -5685,6 +6755,11 @@ void SNN::generateRuntimeSNN() {
 			numCores++;
 	}
 
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	// spawn the CPU workers once, instead of once per phase of every simulation step
+	startCPUWorkerPool();
+#endif
+
 	// 5. declare the spiking neural network is excutable
 	snnState = EXECUTABLE_SNN;
 }
@@ -6046,14 +7121,13 @@ void SNN::resetFiringTable() {
 void SNN::resetSpikeCnt(int gGrpId) {
 	assert(gGrpId >= ALL);
 
-	if (gGrpId == ALL) {
-		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;
-			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-			int threadCount = 0;
-		#endif
+	// the manager copy of the reset groups no longer matches the runtime
+	for (int g = 0; g < numGroups; g++) {
+		if (gGrpId == ALL || g == gGrpId)
+			spikeCntFetchedTime_[g] = -1;
+	}
 
+	if (gGrpId == ALL) {
 		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 			if (!groupPartitionLists[netId].empty()) {
 				if (netId < CPU_RUNTIME_BASE) // GPU runtime
@@ -6061,33 +7135,14 @@ void SNN::resetSpikeCnt(int gGrpId) {
 				else{ // CPU runtime
 					#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 						resetSpikeCnt_CPU(netId, ALL);
-					#else // Linux or MAC
-						pthread_attr_t attr;
-						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-						argsThreadRoutine[threadCount].snn_pointer = this;
-						argsThreadRoutine[threadCount].netId = netId;
-						argsThreadRoutine[threadCount].lGrpId = ALL;
-						argsThreadRoutine[threadCount].startIdx = 0;
-						argsThreadRoutine[threadCount].endIdx = 0;
-						argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-						pthread_create(&threads[threadCount], &attr, &SNN::helperResetSpikeCnt_CPU, (void*)&argsThreadRoutine[threadCount]);
-						pthread_attr_destroy(&attr);
-						threadCount++;
 					#endif
 				}
 			}
 		}
 
 		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
+			// run the CPU partitions on the persistent worker pool
+			runCPUWorkerPool(&SNN::helperResetSpikeCnt_CPU, ALL);
 		#endif
 	}
 	else {
@@ -6142,30 +7197,18 @@ int SNN::setRandSeed(int seed) {
 		return seed;
 }
 
-void SNN::fillSpikeGenBits(int netId) {
-	SpikeBuffer::SpikeIterator spikeBufIter;
-	SpikeBuffer::SpikeIterator spikeBufIterEnd = spikeBuf->back();
-
+void SNN::fillSpikeGenBits(int netId, unsigned int* spikeGenBits) {
 	// Covert spikes stored in spikeBuffer to SpikeGenBit
-	for (spikeBufIter = spikeBuf->front(); spikeBufIter != spikeBufIterEnd; ++spikeBufIter) {
-		// get the global neuron id and group id for this particular spike
-		int gGrpId = spikeBufIter->grpId;
-
-		if (groupConfigMDMap[gGrpId].netId == netId) {
-			int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
-			int lNId = spikeBufIter->neurId /* gNId */ + groupConfigMDMap[gGrpId].GtoLOffset;
-
-			// add spike to spikeGentBit
-			assert(groupConfigMap[gGrpId].isSpikeGenerator == true);
+	// the buffer holds the spikes of this partition only, already as positions into spikeGenBits
+	const std::vector<int>& spikes = spikeBuf->getSpikes(netId);
+	for (size_t i = 0; i < spikes.size(); i++) {
+		int nIdPos = spikes[i];
+		int nIdBitPos = nIdPos % 32;
+		int nIdIndex = nIdPos / 32;
 
-			int nIdPos = (lNId - groupConfigs[netId][lGrpId].lStartN + groupConfigs[netId][lGrpId].Noffset);
-			int nIdBitPos = nIdPos % 32;
-			int nIdIndex = nIdPos / 32;
+		assert(nIdIndex < (networkConfigs[netId].numNSpikeGen / 32 + 1));
 
-			assert(nIdIndex < (networkConfigs[netId].numNSpikeGen / 32 + 1));
-
-			managerRuntimeData.spikeGenBits[nIdIndex] |= (1 << nIdBitPos);
-		}
+		spikeGenBits[nIdIndex] |= (1 << nIdBitPos);
 	}
 }
 
@@ -6221,8 +7264,7 @@ void SNN::updateConnectionMonitor(short int connId) {
 			int timeInterval = connMonCoreList[monId]->getUpdateTimeIntervalSec();
 			if (timeInterval==1 || timeInterval>1 && (getSimTime()%timeInterval)==0) {
 				// this ConnectionMonitor wants periodic recording
-				connMonCoreList[monId]->writeConnectFileSnapshot(simTime,
-					getWeightMatrix2D(connMonCoreList[monId]->getConnectId()));
+				connMonCoreList[monId]->writeConnectFileSnapshot(simTime);
 			}
 		}
 	}
@@ -6236,9 +7278,6 @@ std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
 	int grpIdPre = connectConfigMap[connId].grpSrc;
 	int grpIdPost = connectConfigMap[connId].grpDest;
 
-	int netIdPost = groupConfigMDMap[grpIdPost].netId;
-	int lGrpIdPost = groupConfigMDMap[grpIdPost].lGrpId;
-
 	// init weight matrix with right dimensions
 	for (int i = 0; i < groupConfigMap[grpIdPre].numN; i++) {
 		std::vector<float> wtSlice;
@@ -6248,32 +7287,61 @@ std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
 		wtConnId.push_back(wtSlice);
 	}
 
+	// then scatter the existing synapses into the matrix
+	std::vector<float> wts;
+	std::vector<int> nIdsPre, nIdsPost;
+	getWeightsSparse(connId, wts, &nIdsPre, &nIdsPost);
+	for (unsigned int i = 0; i < wts.size(); i++)
+		wtConnId[nIdsPre[i]][nIdsPost[i]] = wts[i];
+
+	return wtConnId;
+}
+
+// FIXME: modify this for multi-GPUs
+void SNN::getWeightsSparse(short int connId, std::vector<float>& wts, std::vector<int>* nIdsPre, std::vector<int>* nIdsPost) {
+	assert(connId > ALL); // ALL == -1
+
+	int grpIdPost = connectConfigMap[connId].grpDest;
+	assert(grpIdPost > ALL); // ALL == -1
+
+	int netIdPost = groupConfigMDMap[grpIdPost].netId;
+	int lGrpIdPost = groupConfigMDMap[grpIdPost].lGrpId;
+
 	// copy the weights for a given post-group from device
 	// \TODO: check if the weights for this grpIdPost have already been copied
 	// \TODO: even better, but tricky because of ordering, make copyWeightState connection-based
 
-	assert(grpIdPost > ALL); // ALL == -1
-
 	// Note, copyWeightState() also copies pre-connections information (e.g., Npre, Npre_plastic, cumulativePre, and preSynapticIds)
 	fetchWeightState(netIdPost, lGrpIdPost);
 	fetchConnIdsLookupArray(netIdPost);
 
+	wts.clear();
+	if (nIdsPre != NULL)
+		nIdsPre->clear();
+	if (nIdsPost != NULL)
+		nIdsPost->clear();
+
+	// synapses are visited in the order in which they are stored: by post-synaptic neuron, then by the
+	// position in its pre-synaptic list, so that repeated calls return the same order
 	for (int lNIdPost = groupConfigs[netIdPost][lGrpIdPost].lStartN; lNIdPost <= groupConfigs[netIdPost][lGrpIdPost].lEndN; lNIdPost++) {
 		unsigned int pos_ij = managerRuntimeData.cumulativePre[lNIdPost];
 		for (int i = 0; i < managerRuntimeData.Npre[lNIdPost]; i++, pos_ij++) {
 			// skip synapses that belong to a different connection ID
-			if (managerRuntimeData.connIdsPreIdx[pos_ij] != connId) //connInfo->connId)
+			if (managerRuntimeData.connIdsPreIdx[pos_ij] != connId)
 				continue;
 
-			// find pre-neuron ID and update ConnectionMonitor container
-			int lNIdPre = GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos_ij]);
-			int lGrpIdPre = GET_CONN_GRP_ID(managerRuntimeData.preSynapticIds[pos_ij]);
-			wtConnId[lNIdPre - groupConfigs[netIdPost][lGrpIdPre].lStartN][lNIdPost - groupConfigs[netIdPost][lGrpIdPost].lStartN] =
-				fabs(managerRuntimeData.wt[pos_ij]);
+			wts.push_back(fabs(managerRuntimeData.wt[pos_ij]));
+
+			// only look up neuron IDs if the caller asks for them
+			if (nIdsPre != NULL) {
+				int lNIdPre = GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos_ij]);
+				int lGrpIdPre = GET_CONN_GRP_ID(managerRuntimeData.preSynapticIds[pos_ij]);
+				nIdsPre->push_back(lNIdPre - groupConfigs[netIdPost][lGrpIdPre].lStartN);
+			}
+			if (nIdsPost != NULL)
+				nIdsPost->push_back(lNIdPost - groupConfigs[netIdPost][lGrpIdPost].lStartN);
 		}
 	}
-
-	return wtConnId;
 }
 
 void SNN::updateGroupMonitor(int gGrpId) {
@@ -6361,10 +7429,37 @@ void SNN::userDefinedSpikeGenerator(int gGrpId) {
 	// \FIXME this function is a mess
 	SpikeGeneratorCore* spikeGenFunc = groupConfigMap[gGrpId].spikeGenFunc;
 	int netId = groupConfigMDMap[gGrpId].netId;
+	int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
 	int timeSlice = groupConfigMDMap[gGrpId].currTimeSlice;
 	int currTime = simTime;
 	bool done;
 
+	// the end of the valid time window is either the length of the scheduling time slice from now (because that
+	// is the max of the allowed propagated buffer size) or simply the end of the simulation
+	int endOfTimeWindow = std::min(currTime+timeSlice, simTimeRunStop);
+
+	// try the batch interface first: the generator hands over all spikes of the time slice in a single call, and
+	// does not need the last spike times of the group
+	spikeGenSink.clear();
+	if (spikeGenFunc->generateSpikes(this, gGrpId, currTime, endOfTimeWindow, spikeGenSink)) {
+		int numN = groupConfigMap[gGrpId].numN;
+		int nIdOffset = groupConfigs[netId][lGrpId].Noffset;
+		for (int i = 0; i < spikeGenSink.getNumSpikes(); i++) {
+			int nId = spikeGenSink.getNeuronId(i);
+			int spikeTime = spikeGenSink.getSpikeTime(i);
+			if (nId < 0 || nId >= numN) {
+				KERNEL_ERROR("SpikeGenerator of group %s scheduled a spike for neuron %d, but the group has %d neurons",
+					groupConfigMap[gGrpId].grpName.c_str(), nId, numN);
+				exitSimulation(1);
+			}
+
+			// spikes outside of the scheduling time slice are ignored, same as in nextSpikeTime mode
+			if (spikeTime >= currTime && spikeTime < endOfTimeWindow)
+				spikeBuf->schedule(netId, nId + nIdOffset, spikeTime - currTime);
+		}
+		return;
+	}
+
 	fetchLastSpikeTime(netId);
 
 	for(int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
@@ -6374,14 +7469,15 @@ void SNN::userDefinedSpikeGenerator(int gGrpId) {
 		if (nextTime == MAX_SIMULATION_TIME)
 			nextTime = 0;
 
-		// the end of the valid time window is either the length of the scheduling time slice from now (because that
-		// is the max of the allowed propagated buffer size) or simply the end of the simulation
-		int endOfTimeWindow = std::min(currTime+timeSlice, simTimeRunStop);
-
 		done = false;
 		while (!done) {
 			// generate the next spike time (nextSchedTime) from the nextSpikeTime callback
 			int nextSchedTime = spikeGenFunc->nextSpikeTime(this, gGrpId, gNId - groupConfigMDMap[gGrpId].gStartN, currTime, nextTime, endOfTimeWindow);
+			if (!spikeGenFunc->isNextSpikeTimeImplemented()) {
+				KERNEL_ERROR("SpikeGenerator of group %s implements neither generateSpikes nor nextSpikeTime",
+					groupConfigMap[gGrpId].grpName.c_str());
+				exitSimulation(1);
+			}
 
 			// the generated spike time is valid only if:
 			// - it has not been scheduled before (nextSchedTime > nextTime)
@@ -6394,7 +7490,10 @@ void SNN::userDefinedSpikeGenerator(int gGrpId) {
 				// \TODO CPU mode does not check whether the same AER event has been scheduled before (bug #212)
 				// check how GPU mode does it, then do the same here.
 				nextTime = nextSchedTime;
-				spikeBuf->schedule(gNId, gGrpId, nextTime - currTime);
+
+				// store the position of the neuron in spikeGenBits of its partition, see fillSpikeGenBits
+				int nIdPos = lNId - groupConfigs[netId][lGrpId].lStartN + groupConfigs[netId][lGrpId].Noffset;
+				spikeBuf->schedule(netId, nIdPos, nextTime - currTime);
 			} else {
 				done = true;
 			}
@@ -6480,82 +7579,105 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 	if (!numSpikeMonitor)
 		return;
 
-	if (gGrpId == ALL) {
-		for (int gGrpId = 0; gGrpId < numGroups; gGrpId++)
-			updateSpikeMonitor(gGrpId);
-	} else {
-		int netId = groupConfigMDMap[gGrpId].netId;
-		int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
-		// update spike monitor of a specific group
-		// find index in spike monitor arrays
-		int monitorId = groupConfigMDMap[gGrpId].spikeMonitorId;
+	// find the time interval in which to update spikes
+	// usually, we call updateSpikeMonitor once every second, so the time interval is [0,1000)
+	// however, updateSpikeMonitor can be called at any time t \in [0,1000)... so we can have the cases
+	// [0,t), [t,1000), and even [t1, t2)
+	int numMsMax = getSimTimeMs(); // upper bound is given by current time
+	if (numMsMax == 0)
+		numMsMax = 1000; // special case: full second
+
+	// current time is last completed second in milliseconds (plus t to be added below)
+	// special case is after each completed second where !getSimTimeMs(): here we look 1s back
+	int currentTimeSec = getSimTimeSec();
+	if (!getSimTimeMs())
+		currentTimeSec--;
+
+	// the spikes of a local network are fetched once and distributed to all of its monitors in a single pass
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		// monitors of the local groups that need an update, and the lower bound of their time interval
+		// (the firing tables also hold external spikes, whose groups are assigned but never monitored here)
+		std::vector<SpikeMonitorCore*> spkMonObjs(networkConfigs[netId].numGroupsAssigned, (SpikeMonitorCore*)NULL);
+		std::vector<int> numMsMins(networkConfigs[netId].numGroupsAssigned, 0);
+		int numMsMinNet = numMsMax;
+
+		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+			int gGrpIdMon = groupConfigs[netId][lGrpId].gGrpId;
+			if (gGrpId != ALL && gGrpIdMon != gGrpId)
+				continue;
 
-		// don't continue if no spike monitor enabled for this group
-		if (monitorId < 0) return;
+			// find index in spike monitor arrays, don't continue if no spike monitor enabled for this group
+			int monitorId = groupConfigMDMap[gGrpIdMon].spikeMonitorId;
+			if (monitorId < 0)
+				continue;
 
-		// find last update time for this group
-		SpikeMonitorCore* spkMonObj = spikeMonCoreList[monitorId];
-		long int lastUpdate = spkMonObj->getLastUpdated();
+			// find last update time for this group
+			SpikeMonitorCore* spkMonObj = spikeMonCoreList[monitorId];
+			long int lastUpdate = spkMonObj->getLastUpdated();
 
-		// don't continue if time interval is zero (nothing to update)
-		if ( ((long int)getSimTime()) - lastUpdate <= 0)
-			return;
+			// don't continue if time interval is zero (nothing to update)
+			if ( ((long int)getSimTime()) - lastUpdate <= 0)
+				continue;
 
-		if ( ((long int)getSimTime()) - lastUpdate > 1000)
-			KERNEL_ERROR("updateSpikeMonitor(grpId=%d) must be called at least once every second",gGrpId);
+			if ( ((long int)getSimTime()) - lastUpdate > 1000)
+				KERNEL_ERROR("updateSpikeMonitor(grpId=%d) must be called at least once every second",gGrpIdMon);
+
+			// AER buffer max size warning here.
+			// Because of C++ short-circuit evaluation, the last condition should not be evaluated
+			// if the previous conditions are false.
+			if (spkMonObj->getAccumTime() > LONG_SPIKE_MON_DURATION \
+					&& this->getGroupNumNeurons(gGrpIdMon) > LARGE_SPIKE_MON_GRP_SIZE \
+					&& spkMonObj->isBufferBig()){
+				// change this warning message to correct message
+				KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%lu MB)",gGrpIdMon,(long int) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
+				KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(gGrpIdMon));
+			}
 
-        // AER buffer max size warning here.
-        // Because of C++ short-circuit evaluation, the last condition should not be evaluated
-        // if the previous conditions are false.
-        if (spkMonObj->getAccumTime() > LONG_SPIKE_MON_DURATION \
-                && this->getGroupNumNeurons(gGrpId) > LARGE_SPIKE_MON_GRP_SIZE \
-                && spkMonObj->isBufferBig()){
-            // change this warning message to correct message
-            KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%lu MB)",gGrpId,(long int) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
-            KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(gGrpId));
-		}
+			int numMsMin = lastUpdate % 1000; // lower bound is given by last time we called update
+			assert(numMsMin < numMsMax);
 
-		// copy the neuron firing information to the manager runtime
-		fetchSpikeTables(netId);
-		fetchGrpIdsLookupArray(netId);
+			// save current time as last update time
+			spkMonObj->setLastUpdated( (long int)getSimTime() );
 
-		// find the time interval in which to update spikes
-		// usually, we call updateSpikeMonitor once every second, so the time interval is [0,1000)
-		// however, updateSpikeMonitor can be called at any time t \in [0,1000)... so we can have the cases
-		// [0,t), [t,1000), and even [t1, t2)
-		int numMsMin = lastUpdate % 1000; // lower bound is given by last time we called update
-		int numMsMax = getSimTimeMs(); // upper bound is given by current time
-		if (numMsMax == 0)
-			numMsMax = 1000; // special case: full second
-		assert(numMsMin < numMsMax);
+			// only monitors that record spikes need to see them
+			if (spkMonObj->getSpikeFileId() == NULL && !(spkMonObj->getMode() == AER && spkMonObj->isRecording()))
+				continue;
 
-		// current time is last completed second in milliseconds (plus t to be added below)
-		// special case is after each completed second where !getSimTimeMs(): here we look 1s back
-		int currentTimeSec = getSimTimeSec();
-		if (!getSimTimeMs())
-			currentTimeSec--;
+			spkMonObjs[lGrpId] = spkMonObj;
+			numMsMins[lGrpId] = numMsMin;
+			numMsMinNet = std::min(numMsMinNet, numMsMin);
+		}
 
-		// save current time as last update time
-		spkMonObj->setLastUpdated( (long int)getSimTime() );
+		// nothing to distribute, skip the fetch
+		if (numMsMinNet == numMsMax)
+			continue;
 
-		// prepare fast access
-		FILE* spkFileId = spikeMonCoreList[monitorId]->getSpikeFileId();
-		bool writeSpikesToFile = spkFileId != NULL;
-		bool writeSpikesToArray = spkMonObj->getMode()==AER && spkMonObj->isRecording();
+		// copy the neuron firing information to the manager runtime, unless it is already there
+		if (spikeTablesFetchedNetId_ != netId || spikeTablesFetchedTime_ != (long int)getSimTime()) {
+			fetchSpikeTables(netId);
+			fetchGrpIdsLookupArray(netId);
+			spikeTablesFetchedNetId_ = netId;
+			spikeTablesFetchedTime_ = (long int)getSimTime();
+		}
 
 		// Read one spike at a time from the buffer and put the spikes to an appopriate monitor buffer. Later the user
 		// may need need to dump these spikes to an output file
 		for (int k = 0; k < 2; k++) {
 			unsigned int* timeTablePtr = (k == 0) ? managerRuntimeData.timeTableD2 : managerRuntimeData.timeTableD1;
 			int* fireTablePtr = (k == 0) ? managerRuntimeData.firingTableD2 : managerRuntimeData.firingTableD1;
-			for(int t = numMsMin; t < numMsMax; t++) {
+			for(int t = numMsMinNet; t < numMsMax; t++) {
+				// current time is last completed second plus whatever is leftover in t
+				int time = currentTimeSec * 1000 + t;
+
 				for(int i = timeTablePtr[t + glbNetworkConfig.maxDelay]; i < timeTablePtr[t + glbNetworkConfig.maxDelay + 1]; i++) {
-					// retrieve the neuron id
+					// retrieve the neuron id and the monitor of its group
 					int lNId = fireTablePtr[i];
-
-					// make sure neuron belongs to currently relevant group
-					int this_grpId = managerRuntimeData.grpIds[lNId];
-					if (this_grpId != lGrpId)
+					int lGrpId = managerRuntimeData.grpIds[lNId];
+					SpikeMonitorCore* spkMonObj = spkMonObjs[lGrpId];
+					if (spkMonObj == NULL || t < numMsMins[lGrpId])
 						continue;
 
 					// adjust nid to be 0-indexed for each group
@@ -6564,24 +7686,20 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 					int nId = lNId - groupConfigs[netId][lGrpId].lStartN;
 					assert(nId >= 0);
 
-					// current time is last completed second plus whatever is leftover in t
-					int time = currentTimeSec * 1000 + t;
-
-					if (writeSpikesToFile) {
-						int cnt;
-						cnt = fwrite(&time, sizeof(int), 1, spkFileId); assert(cnt==1);
-						cnt = fwrite(&nId,  sizeof(int), 1, spkFileId); assert(cnt==1);
-					}
+					if (spkMonObj->getSpikeFileId() != NULL)
+						spkMonObj->pushSpikeFileAER(time, nId);
 
-					if (writeSpikesToArray) {
+					if (spkMonObj->getMode()==AER && spkMonObj->isRecording()) {
 						spkMonObj->pushAER(time, nId);
 					}
 				}
 			}
 		}
 
-		if (spkFileId!=NULL) // flush spike file
-			fflush(spkFileId);
+		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+			if (spkMonObjs[lGrpId] != NULL && spkMonObjs[lGrpId]->getSpikeFileId() != NULL) // hand the AER block off to the spike file writer
+				spkMonObjs[lGrpId]->flushSpikeFile();
+		}
 	}
 }
 
@@ -50,159 +50,75 @@
 #include <vector>
 
 
-// the size of an allocation chunk
-#define MAX_CHUNK_SIZE 1024
-
-
 class SpikeBuffer::Impl {
 public:
 	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
-	Impl(int minDelay, int maxDelay) : _currNodeId(0), _spikeBufFront(maxDelay+1), 
-		_spikeBufBack(maxDelay+1), _chunkBuf(0), _currFreeChunkId(NULL), _nextFreeNodeId(0), _nextFreeChunkId(0),
-		_recycledNodes(NULL)
-	{
+	Impl(int minDelay, int maxDelay) : _currSlotId(0), _numSlots(0) {
 		reset(minDelay, maxDelay);
 	}
-	
-	~Impl() {
-		for (size_t i=0; i<_chunkBuf.size(); i++) {
-			delete[] _chunkBuf[i];
-		}
-	}
 
-	void reset(int minDelay, int maxDelay) {
-		init(maxDelay + minDelay);
+	~Impl() {}
 
-		for (size_t i=0; i<_spikeBufFront.size(); i++) {
-			_spikeBufFront[i] = NULL;
-			_spikeBufBack[i] = NULL;
+	void reset(int minDelay, int maxDelay) {
+		_numSlots = maxDelay + minDelay + 1;
+		for (size_t netId=0; netId<_slots.size(); netId++) {
+			_slots[netId].resize(_numSlots);
+			for (size_t i=0; i<_slots[netId].size(); i++)
+				_slots[netId][i].clear();
 		}
-
-		_currFreeChunkId = _chunkBuf[0];
-		_nextFreeChunkId = 1;
-
-		_currNodeId = 0;
-		_nextFreeNodeId = 0;
-		_recycledNodes = NULL;
+		_currSlotId = 0;
 	}
 
 
 
 	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
-	// points to front of buffer
-	SpikeIterator front(int stepOffset=0) {
-		return SpikeIterator(_spikeBufFront[(_currNodeId + stepOffset + length()) % length()]);
-	};
-
-	// End iterator corresponding to beginSynapseGroups
-	SpikeIterator back() {
-		return SpikeIterator(NULL);
-	};
+	// spikes of partition netId scheduled for the current time step (plus stepOffset)
+	const std::vector<int>& getSpikes(int netId, int stepOffset=0) {
+		if (netId < 0 || netId >= (int)_slots.size() || _slots[netId].empty())
+			return _noSpikes;
+		return _slots[netId][(_currSlotId + stepOffset + _numSlots) % _numSlots];
+	}
 
 	// retrieve actual length of buffer
 	size_t length() {
-		return _spikeBufFront.size();
+		return _numSlots;
 	}
-	
-	// schedule a spike at t + delay for neuron neurId
-	void schedule(int neurId, int grpId, unsigned short int delay) {
-		SpikeNode* n = getFreeNode();
-
-		int writeIdx = (_currNodeId+delay) % _spikeBufFront.size();
-
-		n->neurId = neurId;
-		n->grpId = grpId;
-		n->delay = delay;
-		n->next = NULL;
-		if (_spikeBufFront[writeIdx] == NULL) {
-			_spikeBufFront[writeIdx] = n;
-			_spikeBufBack[writeIdx] = n;
-		} else {
-			_spikeBufBack[writeIdx]->next = n;
-			_spikeBufBack[writeIdx] = n;
-		}
+
+	// schedule a spike at t + delay for neuron neurId of partition netId
+	void schedule(int netId, int neurId, unsigned short int delay) {
+		// the ring of a partition is allocated the first time it schedules a spike
+		if (netId >= (int)_slots.size())
+			_slots.resize(netId + 1);
+		if (_slots[netId].empty())
+			_slots[netId].resize(_numSlots);
+
+		_slots[netId][(_currSlotId + delay) % _numSlots].push_back(neurId);
 	}
 
 	void step() {
-	// move the solts of _currNodeId to recycled slots
-		if (_spikeBufFront[_currNodeId] != NULL) {
-			_spikeBufBack[_currNodeId]->next = _recycledNodes;
-			_recycledNodes = _spikeBufFront[_currNodeId];
+		// mark current slot as processed, but keep its memory for reuse
+		for (size_t netId=0; netId<_slots.size(); netId++) {
+			if (!_slots[netId].empty())
+				_slots[netId][_currSlotId].clear();
 		}
-	
-		// mark current index as processed
-		_spikeBufFront[_currNodeId] = NULL;
-		_spikeBufBack[_currNodeId] = NULL;
-		_currNodeId = (_currNodeId + 1) % _spikeBufFront.size();
+		_currSlotId = (_currSlotId + 1) % _numSlots;
 	}
 
 
 private:
-	//! Set up internal memory management
-	void init(size_t maxDelaySteps) {
-		if (_spikeBufFront.size() != maxDelaySteps + 1) {
-			_spikeBufFront.resize(maxDelaySteps + 1);
-			_spikeBufBack.resize(maxDelaySteps + 1);
-		}
-		if (_chunkBuf.size() < 1) {
-			_chunkBuf.reserve(10);
-			_chunkBuf.resize(0);
-			_chunkBuf.push_back(new SpikeNode[MAX_CHUNK_SIZE]);
-		}
-	}
-
-	//! Get a new SpikeNode from the internal memory management
-	SpikeNode* getFreeNode() {
-		SpikeNode* n;
-		if (_recycledNodes != NULL) {
-			// find a recycled node
-			n = _recycledNodes;
-			_recycledNodes = _recycledNodes->next;
-		} else if (_nextFreeNodeId < MAX_CHUNK_SIZE) {
-			// as long as there is pre-allocated memory left: get a new slot from the current chunk
-			n = &(_currFreeChunkId[_nextFreeNodeId++]);
-		} else if (_nextFreeChunkId < _chunkBuf.size()) {
-			// pre-allocated memory chunk is used up: go to next chunk
-			_currFreeChunkId = _chunkBuf[_nextFreeChunkId++];
-			n = &(_currFreeChunkId[0]);
-			_nextFreeNodeId = 1;
-		} else {
-			// all chunks used up: need to allocate new one
-			_currFreeChunkId = new SpikeNode[MAX_CHUNK_SIZE];
-			_chunkBuf.push_back(_currFreeChunkId);
-
-			_nextFreeChunkId++;
-			_nextFreeNodeId = 1;
-			n = &(_currFreeChunkId[0]);
-		}
-		return n;
-	}
-
 	//! The index into the ring buffer which corresponds to the current time step
-	int _currNodeId;
-
-	//! A ring buffer storing a pointer to the first SpikeNode
-	std::vector<SpikeNode*> _spikeBufFront;
-
-	//! A ring buffer storing a pointer to the last SpikeNode
-	std::vector<SpikeNode*> _spikeBufBack;
-
-	//! Buffer with pointers to chunks of pre-allocated memory
-	std::vector<SpikeNode*> _chunkBuf;
-
-	//! Pointer to array of SpikeNodes to take from (from position _nextFreeNodeId)
-	SpikeNode* _currFreeChunkId;
+	int _currSlotId;
 
-	//! Index into array _currFreeChunkId which specifies the next SpikeNode to use
-	int _nextFreeNodeId;
+	//! The number of slots of the ring buffer
+	int _numSlots;
 
-	//! Index into _chunkBuf which specifies the next free chunk of memory to use
-	size_t _nextFreeChunkId;
+	//! A ring buffer per partition, each slot holding the neuron IDs of the spikes scheduled at that time step
+	std::vector< std::vector< std::vector<int> > > _slots;
 
-	//! Head of list of SpikeNodes which can be reused
-	SpikeNode* _recycledNodes;
+	//! Returned for partitions that have never scheduled a spike
+	std::vector<int> _noSpikes;
 };
 
 
@@ -216,9 +132,8 @@ SpikeBuffer::SpikeBuffer(int minDelay, int maxDelay) :
 SpikeBuffer::~SpikeBuffer() { delete _impl; }
 
 // public methods
-void SpikeBuffer::schedule(int neurId, int grpId, unsigned short int delay) { _impl->schedule(neurId, grpId, delay); }
+void SpikeBuffer::schedule(int netId, int neurId, unsigned short int delay) { _impl->schedule(netId, neurId, delay); }
 void SpikeBuffer::step() { _impl->step(); }
 void SpikeBuffer::reset(int minDelay, int maxDelay) { _impl->reset(minDelay, maxDelay); }
 size_t SpikeBuffer::length() { return _impl->length(); }
-SpikeBuffer::SpikeIterator SpikeBuffer::front(int stepOffset) { return _impl->front(stepOffset); }
-SpikeBuffer::SpikeIterator SpikeBuffer::back() { return _impl->back(); }
+const std::vector<int>& SpikeBuffer::getSpikes(int netId, int stepOffset) { return _impl->getSpikes(netId, stepOffset); }
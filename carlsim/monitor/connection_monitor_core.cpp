@@ -73,7 +73,7 @@ ConnectionMonitorCore::ConnectionMonitorCore(SNN* snn,int monitorId,short int co
 	needToWriteFileHeader_ = true;
 	needToInit_ = true;
 	connFileSignature_ = 202029319;
-	connFileVersion_ = 0.3f;
+	connFileVersion_ = 0.4f;
 
 	minWt_ = -1.0f;
 	maxWt_ = -1.0f;
@@ -103,18 +103,23 @@ void ConnectionMonitorCore::init() {
 	fpDeb_ = snn_->getLogFpDeb();
 	fpLog_ = snn_->getLogFpLog();
 
-	// init weight matrix with right dimensions
-	for (int i = 0; i < nNeurPre_; i++) {
-		std::vector<float> wt;
-		for (int j = 0; j < nNeurPost_; j++) {
-			wt.push_back(NAN);
-		}
-		wtMat_.push_back(wt);
-		wtMatLast_.push_back(wt);
+	// fetch the topology of the connection once: weights are stored as flat arrays with one entry per
+	// synapse, in the same order as these pre/post neuron IDs
+	snn_->getWeightsSparse(connId_, wtSparse_, &nIdsPre_, &nIdsPost_);
+	wtSparse_.assign(nIdsPre_.size(), NAN);
+
+	// the topology does not change during the simulation, so count the synapses per neuron only once
+	fanIn_.assign(nNeurPost_, 0);
+	fanOut_.assign(nNeurPre_, 0);
+	for (unsigned int k=0; k<nIdsPre_.size(); k++) {
+		fanOut_[nIdsPre_[k]]++;
+		fanIn_[nIdsPost_[k]]++;
 	}
 
-	// then load current weigths from SNN into weight matrix
+	// then load current weigths from SNN into weight arrays
 	updateStoredWeights();
+
+	needToInit_ = false;
 }
 
 ConnectionMonitorCore::~ConnectionMonitorCore() {
@@ -123,7 +128,7 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 		if (connFileTimeIntervalSec_ > 0) {
 			// make sure SNN is not already deallocated!
 			assert(snn_!=NULL);
-			writeConnectFileSnapshot(snn_->getSimTime(), snn_->getWeightMatrix2D(connId_));
+			writeConnectFileSnapshot(snn_->getSimTime());
 		}
 
 		// then close file and clean up
@@ -139,13 +144,10 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 // calculate weight changes since last update (element-wise )
 std::vector< std::vector<float> > ConnectionMonitorCore::calcWeightChanges() {
 	updateStoredWeights();
-	std::vector< std::vector<float> > wtChange(nNeurPre_, std::vector<float>(nNeurPost_));
+	std::vector< std::vector<float> > wtChange(nNeurPre_, std::vector<float>(nNeurPost_, NAN));
 
-	// take the naive approach for now
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			wtChange[i][j] = wtMat_[i][j] - wtMatLast_[i][j];
-		}
+	for (unsigned int k=0; k<wtSparse_.size(); k++) {
+		wtChange[nIdsPre_[k]][nIdsPost_[k]] = wtSparse_[k] - wtSparseLast_[k];
 	}
 
 	return wtChange;
@@ -154,36 +156,20 @@ std::vector< std::vector<float> > ConnectionMonitorCore::calcWeightChanges() {
 
 // reset weight matrix
 void ConnectionMonitorCore::clear() {
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			wtMat_[i][j] = NAN;
-			wtMatLast_[i][j] = NAN;
-		}
-	}
+	wtSparse_.assign(wtSparse_.size(), NAN);
+	wtSparseLast_.assign(wtSparseLast_.size(), NAN);
 }
 
 // find number of incoming synapses for a specific post neuron
 int ConnectionMonitorCore::getFanIn(int neurPostId) {
 	assert(neurPostId<nNeurPost_);
-	int nSyn = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		if (!std::isnan(wtMat_[i][neurPostId])) {
-			nSyn++;
-		}
-	}
-	return nSyn;
+	return isWeightSnapshotCleared() ? 0 : fanIn_[neurPostId];
 }
 
 // find number of outgoing synapses of a specific pre neuron
 int ConnectionMonitorCore::getFanOut(int neurPreId) {
 	assert(neurPreId<nNeurPre_);
-	int nSyn = 0;
-	for (int j=0; j<nNeurPost_; j++) {
-		if (!std::isnan(wtMat_[neurPreId][j])) {
-			nSyn++;
-		}
-	}
-	return nSyn;
+	return isWeightSnapshotCleared() ? 0 : fanOut_[neurPreId];
 }
 
 float ConnectionMonitorCore::getMaxWeight(bool getCurrent) {
@@ -192,15 +178,13 @@ float ConnectionMonitorCore::getMaxWeight(bool getCurrent) {
 		updateStoredWeights();
 
 		// find currently largest weight value
-		for (int i=0; i<nNeurPre_; i++) {
-			for (int j=0; j<nNeurPost_; j++) {
-				// skip entries in matrix where no synapse exists
-				if (std::isnan(wtMat_[i][j]))
-					continue;
-
-				if (wtMat_[i][j] > maxVal) {
-					maxVal = wtMat_[i][j];
-				}
+		for (unsigned int k=0; k<wtSparse_.size(); k++) {
+			// skip entries that have been cleared
+			if (std::isnan(wtSparse_[k]))
+				continue;
+
+			if (wtSparse_[k] > maxVal) {
+				maxVal = wtSparse_[k];
 			}
 		}
 	} else {
@@ -217,15 +201,13 @@ float ConnectionMonitorCore::getMinWeight(bool getCurrent) {
 		updateStoredWeights();
 
 		// find currently largest weight value
-		for (int i=0; i<nNeurPre_; i++) {
-			for (int j=0; j<nNeurPost_; j++) {
-				// skip entries in matrix where no synapse exists
-				if (std::isnan(wtMat_[i][j]))
-					continue;
-
-				if (wtMat_[i][j] < minVal) {
-					minVal = wtMat_[i][j];
-				}
+		for (unsigned int k=0; k<wtSparse_.size(); k++) {
+			// skip entries that have been cleared
+			if (std::isnan(wtSparse_[k]))
+				continue;
+
+			if (wtSparse_[k] < minVal) {
+				minVal = wtSparse_[k];
 			}
 		}
 	} else {
@@ -239,18 +221,16 @@ float ConnectionMonitorCore::getMinWeight(bool getCurrent) {
 // find number of synapses whose weights changed
 int ConnectionMonitorCore::getNumWeightsChanged(double minAbsChange) {
 	assert(minAbsChange>=0.0);
-	std::vector< std::vector<float> > wtChange = calcWeightChanges();
+	updateStoredWeights();
 
 	int nChanged = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (std::isnan(wtMat_[i][j]))
-				continue;
+	for (unsigned int k=0; k<wtSparse_.size(); k++) {
+		// skip entries that have been cleared
+		if (std::isnan(wtSparse_[k]))
+			continue;
 
-			if (fabs(wtChange[i][j]) >= minAbsChange) {
-				nChanged++;
-			}
+		if (fabs(wtSparse_[k] - wtSparseLast_[k]) >= minAbsChange) {
+			nChanged++;
 		}
 	}
 	return nChanged;
@@ -268,15 +248,13 @@ int ConnectionMonitorCore::getNumWeightsInRange(double minVal, double maxVal) {
 	}
 
 	int cnt = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (std::isnan(wtMat_[i][j]))
-				continue;
+	for (unsigned int k=0; k<wtSparse_.size(); k++) {
+		// skip entries that have been cleared
+		if (std::isnan(wtSparse_[k]))
+			continue;
 
-			if (wtMat_[i][j]>=minVal && wtMat_[i][j]<=maxVal) {
-				cnt++;
-			}
+		if (wtSparse_[k]>=minVal && wtSparse_[k]<=maxVal) {
+			cnt++;
 		}
 	}
 
@@ -295,21 +273,20 @@ int ConnectionMonitorCore::getNumWeightsWithValue(double value) {
 
 // calculate total absolute amount of weight change
 double ConnectionMonitorCore::getTotalAbsWeightChange() {
-	std::vector< std::vector<float> > wtChange = calcWeightChanges();
+	updateStoredWeights();
 	double wtTotalChange = 0.0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (std::isnan(wtMat_[i][j]))
-				continue;
-			wtTotalChange += fabs(wtChange[i][j]);
-		}
+	for (unsigned int k=0; k<wtSparse_.size(); k++) {
+		// skip entries that have been cleared
+		if (std::isnan(wtSparse_[k]))
+			continue;
+		wtTotalChange += fabs(wtSparse_[k] - wtSparseLast_[k]);
 	}
 	return wtTotalChange;
 }
 
 void ConnectionMonitorCore::print() {
 	updateStoredWeights();
+	std::vector< std::vector<float> > wtMat = getWeightMatrix2D(wtSparse_);
 
 	KERNEL_INFO("(t=%.3fs) ConnectionMonitor ID=%d: %d(%s) => %d(%s)",
 		(getTimeMsCurrentSnapshot()/1000.0f), connId_,
@@ -331,25 +308,40 @@ void ConnectionMonitorCore::print() {
 		std::stringstream line;
 		line << std::setw(9) << std::setfill(' ') << i << " |";
 		for (int j=0; j<nNeurPost_; j++) {
-			line << std::fixed << std::setprecision(4) << (std::isnan(wtMat_[i][j])?"      ":(wtMat_[i][j]>=0?"   ":"  "))
-				<< wtMat_[i][j]  << "  ";
+			line << std::fixed << std::setprecision(4) << (std::isnan(wtMat[i][j])?"      ":(wtMat[i][j]>=0?"   ":"  "))
+				<< wtMat[i][j]  << "  ";
 		}
 		KERNEL_INFO("%s",line.str().c_str());
 	}
 }
 
+// sorts synapse indices by pre-synaptic neuron ID first, then post-synaptic neuron ID
+struct SynapseOrderPreMajor {
+	SynapseOrderPreMajor(const std::vector<int>& nIdsPre, const std::vector<int>& nIdsPost)
+		: nIdsPre_(nIdsPre), nIdsPost_(nIdsPost) {}
+
+	bool operator()(int a, int b) const {
+		if (nIdsPre_[a] != nIdsPre_[b])
+			return nIdsPre_[a] < nIdsPre_[b];
+		return nIdsPost_[a] < nIdsPost_[b];
+	}
+
+	const std::vector<int>& nIdsPre_;
+	const std::vector<int>& nIdsPost_;
+};
+
 void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPerLine, bool storeNewSnapshot) {
 	assert(neurPostId<nNeurPost_);
 	assert(maxConn>0);
 	assert(connPerLine>0);
 
 	// give the option of not storing the new snapshot
-	std::vector< std::vector<float> > wtNew, wtOld;
+	std::vector<float> wtNew, wtOld;
 	long int timeNew, timeOld;
 	if (!storeNewSnapshot) {
 		// make a copy of current snapshots so that we can restore them later
-		wtNew = wtMat_;
-		wtOld = wtMatLast_;
+		wtNew = wtSparse_;
+		wtOld = wtSparseLast_;
 		timeNew = wtTime_;
 		timeOld = wtTimeLast_;
 	}
@@ -369,33 +361,34 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 		postZ = neurPostId;
 	}
 
-	std::vector< std::vector<float> > wtChange;
-	if (isPlastic_) {
-		wtChange = calcWeightChanges();
+	// list synapses ordered by pre-synaptic neuron first, then post-synaptic neuron
+	std::vector<int> synIds;
+	for (unsigned int k=0; k<wtSparse_.size(); k++) {
+		if (nIdsPost_[k]>=postA && nIdsPost_[k]<=postZ && !std::isnan(wtSparse_[k]))
+			synIds.push_back(k);
 	}
+	std::sort(synIds.begin(), synIds.end(), SynapseOrderPreMajor(nIdsPre_, nIdsPost_));
 
 	std::stringstream line;
 	int nConn = 0;
 	int maxIntDigits = ceil(log10((double)std::max(nNeurPre_,nNeurPost_)));
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j = postA; j <= postZ; j++) {
-			// display only so many connections
-			if (nConn>=maxConn)
-				break;
-
-			if (!std::isnan(wtMat_[i][j])) {
-				line << "[" << std::setw(maxIntDigits) << i << "," << std::setw(maxIntDigits) << j << "] "
-					<< std::fixed << std::setprecision(4) << wtMat_[i][j];
-				if (isPlastic_) {
-					line << " (" << ((wtChange[i][j]<0)?"":"+");
-					line << std::setprecision(4) << wtChange[i][j] << ")";
-				}
-				line << "   ";
-				if (!(++nConn % connPerLine)) {
-					KERNEL_INFO("%s",line.str().c_str());
-					line.str(std::string());
-				}
-			}
+	for (unsigned int s=0; s<synIds.size(); s++) {
+		// display only so many connections
+		if (nConn>=maxConn)
+			break;
+
+		int k = synIds[s];
+		line << "[" << std::setw(maxIntDigits) << nIdsPre_[k] << "," << std::setw(maxIntDigits) << nIdsPost_[k] << "] "
+			<< std::fixed << std::setprecision(4) << wtSparse_[k];
+		if (isPlastic_) {
+			float wtChange = wtSparse_[k] - wtSparseLast_[k];
+			line << " (" << ((wtChange<0)?"":"+");
+			line << std::setprecision(4) << wtChange << ")";
+		}
+		line << "   ";
+		if (!(++nConn % connPerLine)) {
+			KERNEL_INFO("%s",line.str().c_str());
+			line.str(std::string());
 		}
 	}
 	// flush
@@ -403,8 +396,8 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 		KERNEL_INFO("%s",line.str().c_str());
 
 	if (!storeNewSnapshot) {
-		wtMat_ = wtNew;
-		wtMatLast_ = wtOld;
+		wtSparse_ = wtNew;
+		wtSparseLast_ = wtOld;
 		wtTime_ = timeNew;
 		wtTimeLast_ = timeOld;
 	}
@@ -437,19 +430,28 @@ void ConnectionMonitorCore::setUpdateTimeIntervalSec(int intervalSec) {
 void ConnectionMonitorCore::updateStoredWeights() {
 	if (snn_->getSimTime() > wtTime_) {
 		// time has advanced: get new weights
-		wtMatLast_ = wtMat_;
+		wtSparseLast_.swap(wtSparse_);
 		wtTimeLast_ = wtTime_;
 
-		wtMat_ = snn_->getWeightMatrix2D(connId_);
+		snn_->getWeightsSparse(connId_, wtSparse_);
 		wtTime_ = snn_->getSimTime();
 	}
 }
 
+// scatters a flat weight array into a 2D matrix (non-existent synapses: NAN)
+std::vector< std::vector<float> > ConnectionMonitorCore::getWeightMatrix2D(const std::vector<float>& wts) {
+	std::vector< std::vector<float> > wtMat(nNeurPre_, std::vector<float>(nNeurPost_, NAN));
+	for (unsigned int k=0; k<wts.size(); k++) {
+		wtMat[nIdsPre_[k]][nIdsPost_[k]] = wts[k];
+	}
+	return wtMat;
+}
+
 // returns a current snapshot
 std::vector< std::vector<float> > ConnectionMonitorCore::takeSnapshot() {
 	updateStoredWeights();
-	writeConnectFileSnapshot(wtTime_, wtMat_);
-	return wtMat_;
+	writeConnectFileSnapshot(wtTime_, wtSparse_);
+	return getWeightMatrix2D(wtSparse_);
 }
 
 // write the header section of the spike file
@@ -509,12 +511,21 @@ void ConnectionMonitorCore::writeConnectFileHeader() {
 		KERNEL_ERROR("ConnectionMonitorCore: writeConnectFileHeader has fwrite error");
 
 
+	// write the topology of the connection once (pre and post neuron IDs of every synapse), so that each
+	// snapshot only has to store one weight per synapse in the same order
+	if (!nIdsPre_.empty()) {
+		if (fwrite(&nIdsPre_[0],sizeof(int),nIdsPre_.size(),connFileId_) != nIdsPre_.size())
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+		if (fwrite(&nIdsPost_[0],sizeof(int),nIdsPost_.size(),connFileId_) != nIdsPost_.size())
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+	}
+
 	// \TODO: write delays
 
 	needToWriteFileHeader_ = false;
 }
 
-void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, std::vector< std::vector<float> > wts) {
+void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, const std::vector<float>& wts) {
 	// don't write if we have already written this timestamp to file (or file doesn't exist)
 	if ((long long)simTimeMs <= wtTimeWrite_ || connFileId_==NULL) {
 		return;
@@ -526,12 +537,18 @@ void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, std::vector<
 	if (!fwrite(&wtTimeWrite_,sizeof(long long),1,connFileId_))
 		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
 
-	// write all weights
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			if (!fwrite(&wts[i][j],sizeof(float),1,connFileId_)) {
-				KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
-			}
-		}
+	// write one weight per synapse, in the order of the topology stored in the header
+	if (!wts.empty() && fwrite(&wts[0],sizeof(float),wts.size(),connFileId_) != wts.size())
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+}
+
+void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs) {
+	// don't fetch weights if there is nothing to write
+	if ((long long)simTimeMs <= wtTimeWrite_ || connFileId_==NULL) {
+		return;
 	}
+
+	// fetch into a scratch buffer, so that the stored snapshots (used for weight changes) are not touched
+	snn_->getWeightsSparse(connId_, wtWriteBuf_);
+	writeConnectFileSnapshot(simTimeMs, wtWriteBuf_);
 }
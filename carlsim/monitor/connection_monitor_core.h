@@ -50,6 +50,7 @@
 
 #include <stdio.h>					// FILE
 #include <vector>					// std::vector
+#include <cmath>					// std::isnan
 #include <carlsim_definitions.h>	// ALL
 
 class SNN; // forward declaration of SNN class
@@ -166,14 +167,23 @@ public:
 	//! sets time update interval (seconds) for periodically storing weights to file
 	void setUpdateTimeIntervalSec(int intervalSec);
 
-	//! writes each snapshot to connect file
-	void writeConnectFileSnapshot(int simTimeMs, std::vector< std::vector<float> > wts);
+	//! fetches the current weights and writes them to connect file as a snapshot (unless already written)
+	void writeConnectFileSnapshot(int simTimeMs);
 	
 private:
 	//! indicates whether writing the current snapshot is necessary (false it has already been written)
 	bool needToWriteSnapshot();
 
 	void updateStoredWeights();
+
+	//! whether the current snapshot has been cleared (clear() resets all weights, updateStoredWeights() sets all)
+	bool isWeightSnapshotCleared() { return wtSparse_.empty() || std::isnan(wtSparse_[0]); }
+
+	//! scatters a flat weight array (one entry per synapse) into a 2D matrix (non-existent synapses: NAN)
+	std::vector< std::vector<float> > getWeightMatrix2D(const std::vector<float>& wts);
+
+	//! writes a flat weight array (one entry per synapse) to connect file as a snapshot
+	void writeConnectFileSnapshot(int simTimeMs, const std::vector<float>& wts);
 	
 	//! writes the header section (file signature, version number) of a connect file
 	void writeConnectFileHeader();
@@ -192,8 +202,13 @@ private:
 
 	bool isPlastic_; //!< whether this connection has plastic synapses
 
-	std::vector< std::vector<float> > wtMat_;      //!< current snapshot of weight matrix
-	std::vector< std::vector<float> > wtMatLast_;  //!< last snapshot of weight matrix
+	std::vector<int> nIdsPre_;          //!< pre-synaptic neuron ID (relative to group) of each synapse
+	std::vector<int> nIdsPost_;         //!< post-synaptic neuron ID (relative to group) of each synapse
+	std::vector<int> fanIn_;            //!< number of synapses of each post-synaptic neuron
+	std::vector<int> fanOut_;           //!< number of synapses of each pre-synaptic neuron
+	std::vector<float> wtSparse_;       //!< current snapshot of weights, one entry per synapse
+	std::vector<float> wtSparseLast_;   //!< last snapshot of weights, one entry per synapse
+	std::vector<float> wtWriteBuf_;     //!< scratch buffer for periodic snapshots written to file
 	long long wtTime_;
 	long long wtTimeLast_;
 	long long wtTimeWrite_;
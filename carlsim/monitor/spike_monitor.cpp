@@ -259,7 +259,7 @@ void SpikeMonitor::setMode(SpikeMonMode mode) {
 	spikeMonitorCorePtr_->setMode(mode);
 }
 
-void SpikeMonitor::setLogFile(const std::string& fileName) {
+void SpikeMonitor::setLogFile(const std::string& fileName, bool compressed) {
 	std::string funcName = "setLogFile";
 
 	FILE* fid;
@@ -279,5 +279,5 @@ void SpikeMonitor::setLogFile(const std::string& fileName) {
 	}
 
 	// tell new file id to core object
-	spikeMonitorCorePtr_->setSpikeFileId(fid);
+	spikeMonitorCorePtr_->setSpikeFileId(fid, compressed);
 }
\ No newline at end of file
@@ -465,11 +465,19 @@ class SpikeMonitor {
 	 * to "training.dat" and "testing.dat".
 	 * In order to stop recording to file, pass string "NULL".
 	 *
+	 * By default, every spike is stored as a (time,neurId) pair of 32-bit integers (file version 0.2).
+	 * If compressed is true, the file is written in the compressed format (file version 0.3) instead:
+	 * spikes are stored in blocks (one per SpikeMonitor update), and within a block, spikes are grouped
+	 * by millisecond, with delta-encoded spike times and neuron IDs stored as variable-length integers.
+	 * Compressed files can be read by SpikeGeneratorFromFile and the SpikeReader of the Offline Analysis
+	 * Toolbox.
+	 *
 	 * \param[in] logFileName path to binary file or "NULL" (for not recording to file at all)
+	 * \param[in] compressed  whether to write the compressed spike file format
 	 * \attention Make sure the directory exists!
 	 * \since v3.0
 	 */
-	void setLogFile(const std::string& logFileName);
+	void setLogFile(const std::string& logFileName, bool compressed=false);
 
  private:
   //! This is a pointer to the actual implementation of the class. The user should never directly instantiate it.
@@ -51,6 +51,7 @@
 #include <snn_definitions.h>	// KERNEL_ERROR, KERNEL_INFO, ...
 
 #include <algorithm>			// std::sort
+#include <string.h>				// memcpy
 
 
 
@@ -64,12 +65,22 @@ SpikeMonitorCore::SpikeMonitorCore(SNN* snn, int monitorId, int grpId) {
 	recordSet_ = false;
 	spkMonLastUpdated_ = 0;
 
+	spikeFileWriterRunning_ = false;
+	spikeFileBlockPending_ = false;
+	spikeFileWriterExit_ = false;
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	pthread_mutex_init(&spikeFileMutex_, NULL);
+	pthread_cond_init(&spikeFileCond_, NULL);
+#endif
+
 	mode_ = AER;
 	persistentData_ = false;
     userHasBeenWarned_ = false;
 	needToWriteFileHeader_ = true;
 	spikeFileSignature_ = 206661989;
 	spikeFileVersion_ = 0.2f;
+	spikeFileVersionCompressed_ = 0.3f;
+	spikeFileCompressed_ = false;
 
 	// defer all unsafe operations to init function
 	init();
@@ -94,6 +105,12 @@ void SpikeMonitorCore::init() {
 }
 
 SpikeMonitorCore::~SpikeMonitorCore() {
+	stopSpikeFileWriter();
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	pthread_mutex_destroy(&spikeFileMutex_);
+	pthread_cond_destroy(&spikeFileCond_);
+#endif
+
 	if (spikeFileId_!=NULL) {
 		fclose(spikeFileId_);
 		spikeFileId_ = NULL;
@@ -346,6 +363,7 @@ void SpikeMonitorCore::stopRecording() {
 	// call updateSpikeMonitor to make sure spike file and spike vector are up-to-date
 	// Caution: must be called before recordSet_ is set to false!
 	snn_->updateSpikeMonitor(grpId_);
+	waitForSpikeFileWriter();
 
 	recordSet_ = false;
     userHasBeenWarned_ = false;
@@ -356,9 +374,12 @@ void SpikeMonitorCore::stopRecording() {
 	assert(totalTime_>=0);
 }
 
-void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
+void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId, bool compressed) {
 	assert(!isRecording());
 
+	// all spikes handed off so far belong to the previous file
+	waitForSpikeFileWriter();
+
 	// close previous file pointer if exists
 	if (spikeFileId_!=NULL) {
 		fclose(spikeFileId_);
@@ -367,6 +388,7 @@ void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 
 	// set it to new file id
 	spikeFileId_=spikeFileId;
+	spikeFileCompressed_ = (spikeFileId_!=NULL) && compressed;
 
 	if (spikeFileId_==NULL)
 		needToWriteFileHeader_ = false;
@@ -419,6 +441,160 @@ void SpikeMonitorCore::sortFiringRates() {
 	needToSortFiringRates_ = false;
 }
 
+void SpikeMonitorCore::flushSpikeFile() {
+	if (spikeFileBlock_.empty())
+		return;
+	assert(spikeFileId_!=NULL);
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	if (!spikeFileWriterRunning_) {
+		spikeFileWriterExit_ = false;
+		if (pthread_create(&spikeFileWriter_, NULL, &SpikeMonitorCore::spikeFileWriterLoop, (void*)this)) {
+			KERNEL_ERROR("SpikeMonitorCore: flushSpikeFile could not start the spike file writer");
+			snn_->exitSimulation(1);
+		}
+		spikeFileWriterRunning_ = true;
+	}
+
+	pthread_mutex_lock(&spikeFileMutex_);
+	// the writer may still be busy with the previous block (e.g., a slow disk)
+	while (spikeFileBlockPending_)
+		pthread_cond_wait(&spikeFileCond_, &spikeFileMutex_);
+
+	spikeFileBlock_.swap(spikeFileWriteBlock_);
+	spikeFileBlockPending_ = true;
+	pthread_cond_broadcast(&spikeFileCond_);
+	pthread_mutex_unlock(&spikeFileMutex_);
+
+	spikeFileBlock_.clear();
+#else
+	// no background writer on this platform, write the block synchronously
+	writeSpikeFileBlock(spikeFileBlock_);
+#endif
+}
+
+void SpikeMonitorCore::waitForSpikeFileWriter() {
+	if (!spikeFileWriterRunning_)
+		return;
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	pthread_mutex_lock(&spikeFileMutex_);
+	while (spikeFileBlockPending_)
+		pthread_cond_wait(&spikeFileCond_, &spikeFileMutex_);
+	pthread_mutex_unlock(&spikeFileMutex_);
+#endif
+}
+
+void SpikeMonitorCore::writeSpikeFileBlock(std::vector<int>& block) {
+	if (spikeFileCompressed_) {
+		encodeSpikeFileBlock(block, spikeFileBytes_);
+		size_t cnt = fwrite(&spikeFileBytes_[0], 1, spikeFileBytes_.size(), spikeFileId_);
+		assert(cnt==spikeFileBytes_.size());
+	} else {
+		size_t cnt = fwrite(&block[0], sizeof(int), block.size(), spikeFileId_);
+		assert(cnt==block.size());
+	}
+	fflush(spikeFileId_);
+	block.clear();
+}
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+void* SpikeMonitorCore::spikeFileWriterLoop(void* args) {
+	SpikeMonitorCore* spkMon = (SpikeMonitorCore*)args;
+
+	pthread_mutex_lock(&spkMon->spikeFileMutex_);
+	while (true) {
+		while (!spkMon->spikeFileBlockPending_ && !spkMon->spikeFileWriterExit_)
+			pthread_cond_wait(&spkMon->spikeFileCond_, &spkMon->spikeFileMutex_);
+
+		if (!spkMon->spikeFileBlockPending_)
+			break; // exit requested and nothing left to write
+
+		// the simulation does not touch the write block (or the file) while the block is pending
+		pthread_mutex_unlock(&spkMon->spikeFileMutex_);
+		spkMon->writeSpikeFileBlock(spkMon->spikeFileWriteBlock_);
+		pthread_mutex_lock(&spkMon->spikeFileMutex_);
+
+		spkMon->spikeFileBlockPending_ = false;
+		pthread_cond_broadcast(&spkMon->spikeFileCond_);
+	}
+	pthread_mutex_unlock(&spkMon->spikeFileMutex_);
+
+	return NULL;
+}
+#endif
+
+// appends an unsigned integer to a byte stream, 7 bits at a time (LEB128)
+static inline void appendVarint(std::vector<unsigned char>& bytes, unsigned int val) {
+	while (val >= 0x80) {
+		bytes.push_back((unsigned char)(val | 0x80));
+		val >>= 7;
+	}
+	bytes.push_back((unsigned char)val);
+}
+
+// Compressed spike file block (file version 0.3):
+//   int numBytes   number of bytes that follow the block header (the spike lists)
+//   int firstTime  time (ms) of the first spike in the block
+//   int lastTime   time (ms) of the last spike in the block
+//   int numSpikes  number of spikes in the block
+// followed by one spike list per millisecond that has spikes, in ascending order of time:
+//   varint dt      time difference to the previous spike list (to firstTime for the first list)
+//   varint n       number of spikes in this millisecond
+//   varint dNId[n] neuron IDs in ascending order, the first one absolute, the others as difference to their predecessor
+// The block header allows a reader to skip blocks without decoding them.
+void SpikeMonitorCore::encodeSpikeFileBlock(std::vector<int>& aer, std::vector<unsigned char>& bytes) {
+	assert(aer.size()%2 == 0);
+	int numSpikes = aer.size()/2;
+
+	// the AER block lists the spikes of the D2 and D1 firing tables after another, sort them by (time,neurId)
+	std::vector<long long> spikes(numSpikes);
+	for (int i=0; i<numSpikes; i++) {
+		assert(aer[2*i]>=0 && aer[2*i+1]>=0);
+		spikes[i] = ((long long)aer[2*i] << 32) | (unsigned int)aer[2*i+1];
+	}
+	std::sort(spikes.begin(), spikes.end());
+
+	int header[4] = {0, (int)(spikes[0] >> 32), (int)(spikes[numSpikes-1] >> 32), numSpikes};
+	bytes.resize(sizeof(header));
+
+	int lastTime = header[1];
+	for (int i=0; i<numSpikes; ) {
+		int time = (int)(spikes[i] >> 32);
+		int end = i;
+		while (end < numSpikes && (int)(spikes[end] >> 32) == time)
+			end++;
+
+		appendVarint(bytes, time - lastTime);
+		appendVarint(bytes, end - i);
+		int lastNId = 0;
+		for (; i<end; i++) {
+			int nId = (int)(spikes[i] & 0xFFFFFFFF);
+			appendVarint(bytes, nId - lastNId);
+			lastNId = nId;
+		}
+		lastTime = time;
+	}
+
+	header[0] = bytes.size() - sizeof(header);
+	memcpy(&bytes[0], header, sizeof(header));
+}
+
+void SpikeMonitorCore::stopSpikeFileWriter() {
+	if (!spikeFileWriterRunning_)
+		return;
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	pthread_mutex_lock(&spikeFileMutex_);
+	spikeFileWriterExit_ = true;
+	pthread_cond_broadcast(&spikeFileCond_);
+	pthread_mutex_unlock(&spikeFileMutex_);
+
+	pthread_join(spikeFileWriter_, NULL);
+#endif
+	spikeFileWriterRunning_ = false;
+}
+
 // write the header section of the spike file
 // this should be done once per file, and should be the very first entries in the file
 void SpikeMonitorCore::writeSpikeFileHeader() {
@@ -430,7 +606,8 @@ void SpikeMonitorCore::writeSpikeFileHeader() {
 		KERNEL_ERROR("SpikeMonitorCore: writeSpikeFileHeader has fwrite error");
 
 	// write version number
-	if (!fwrite(&spikeFileVersion_,sizeof(float),1,spikeFileId_))
+	float version = spikeFileCompressed_ ? spikeFileVersionCompressed_ : spikeFileVersion_;
+	if (!fwrite(&version,sizeof(float),1,spikeFileId_))
 		KERNEL_ERROR("SpikeMonitorCore: writeSpikeFileHeader has fwrite error");
 
 	// write grid dimensions
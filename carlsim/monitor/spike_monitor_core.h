@@ -52,6 +52,9 @@
 #include <carlsim_datastructures.h>	// SpikeMonMode
 #include <stdio.h>					// FILE
 #include <vector>					// std::vector
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+#include <pthread.h>				// pthread
+#endif
 
 class SNN; // forward declaration of SNN class
 
@@ -177,8 +180,21 @@ public:
 	//! returns a pointer to the spike file
 	FILE* getSpikeFileId() { return spikeFileId_; }
 
-	//! sets pointer to spike file
-	void setSpikeFileId(FILE* spikeFileId);
+	//! sets pointer to spike file, which is written in the compressed format (version 0.3) if compressed is true
+	void setSpikeFileId(FILE* spikeFileId, bool compressed=false);
+
+	//! returns true if the spike file is written in the compressed format
+	bool isSpikeFileCompressed() { return spikeFileCompressed_; }
+
+	//! appends a (time,neurId) tupel to the AER block that is written to the spike file on the next flush
+	void pushSpikeFileAER(int time, int neurId) { spikeFileBlock_.push_back(time); spikeFileBlock_.push_back(neurId); }
+
+	//! hands the current AER block off to the background writer, which writes it to the spike file in one go
+	//! (on platforms without pthreads, the block is written right away)
+	void flushSpikeFile();
+
+	//! blocks until all AER blocks handed off so far have been written to the spike file
+	void waitForSpikeFileWriter();
 
 	//! returns timestamp of last SpikeMonitor update
 	long int getLastUpdated() { return spkMonLastUpdated_; }
@@ -208,6 +224,20 @@ private:
 	//! writes the header section (file signature, version number) of a spike file
 	void writeSpikeFileHeader();
 
+	//! encodes an AER block in the compressed spike file format (block header followed by the per-ms spike lists)
+	static void encodeSpikeFileBlock(std::vector<int>& aer, std::vector<unsigned char>& bytes);
+
+	//! writes an AER block to the spike file (in the compressed format if requested) and clears the block
+	void writeSpikeFileBlock(std::vector<int>& block);
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	//! main loop of the background writer thread, writes every AER block handed off by flushSpikeFile()
+	static void* spikeFileWriterLoop(void* args);
+#endif
+
+	//! stops the background writer thread (after it has written all pending AER blocks)
+	void stopSpikeFileWriter();
+
 	//! whether we have to perform calculateFiringRates()
 	bool needToCalculateFiringRates_;
 
@@ -225,6 +255,24 @@ private:
 	FILE* spikeFileId_;	//!< file pointer to the spike file or NULL
 	int spikeFileSignature_; //!< int signature of spike file
 	float spikeFileVersion_; //!< version number of spike file
+	float spikeFileVersionCompressed_; //!< version number of compressed spike file
+	bool spikeFileCompressed_; //!< whether the spike file is written in the compressed format
+
+	// The spike file is written by a background thread using two AER blocks: the simulation fills
+	// spikeFileBlock_, flushSpikeFile() swaps it with spikeFileWriteBlock_ and wakes up the writer, which
+	// writes the block with a single fwrite while the simulation fills the other block. Without pthreads (Windows,
+	// macOS), flushSpikeFile() writes spikeFileBlock_ synchronously instead.
+	std::vector<int> spikeFileBlock_;		//!< AER block currently filled by the simulation
+	std::vector<int> spikeFileWriteBlock_;	//!< AER block currently written by the writer thread
+	std::vector<unsigned char> spikeFileBytes_;	//!< compressed spike file block (used by the writer thread)
+	bool spikeFileWriterRunning_;	//!< whether the writer thread has been started
+	bool spikeFileBlockPending_;	//!< whether spikeFileWriteBlock_ is waiting to be (or being) written
+	bool spikeFileWriterExit_;		//!< tells the writer thread to exit once the pending block is written
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	pthread_t spikeFileWriter_;
+	pthread_mutex_t spikeFileMutex_;
+	pthread_cond_t spikeFileCond_;
+#endif
 
 	//! Used to analyzed the spike information
 	std::vector<std::vector<int> > spkVector_;
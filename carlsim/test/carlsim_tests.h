@@ -98,4 +98,7 @@
 void readAndReturnSpikeFile(const std::string fileName, int*& AERArray, long &arraySize);
 void readAndPrintSpikeFile(const std::string fileName);
 
+//! expects two weight matrices (e.g., from ConnectionMonitor::takeSnapshot) to be equal, NAN entries (no synapse) included
+void expectWeightsEqual(const std::vector<std::vector<float> >& wtA, const std::vector<std::vector<float> >& wtB);
+
 #endif // _CARLSIM_TEST_H_
@@ -45,11 +45,13 @@
 * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
 * Ver 12/31/2016
 */
+#include "gtest/gtest.h"
 #include "carlsim_tests.h"
 
 #include <stdio.h>			// fopen, fseek, fclose, etc.
 #include <cassert>			// assert
 #include <string.h>			// std::string
+#include <math.h>			// isnan
 
 
 /// ****************************************************************************
@@ -113,4 +115,16 @@ void readAndPrintSpikeFile(const std::string fileName){
 
 	for (int i=0; i<arraySize; i+=2)
 		printf("time = %d, nid = %d\n",arrayAER[i],arrayAER[i+1]);
-}
\ No newline at end of file
+}
+
+/// ****************************************************************************
+/// Function for comparing two weight matrices, where NAN marks a missing synapse
+/// ****************************************************************************
+void expectWeightsEqual(const std::vector<std::vector<float> >& wtA, const std::vector<std::vector<float> >& wtB) {
+	ASSERT_EQ(wtA.size(), wtB.size());
+	for (size_t i=0; i<wtA.size(); i++) {
+		ASSERT_EQ(wtA[i].size(), wtB[i].size());
+		for (size_t j=0; j<wtA[i].size(); j++)
+			EXPECT_TRUE(wtA[i][j] == wtB[i][j] || (isnan(wtA[i][j]) && isnan(wtB[i][j])));
+	}
+}
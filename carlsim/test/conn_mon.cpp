@@ -362,6 +362,79 @@ TEST(ConnMon, weightFile) {
 	}
 }
 
+//! sparse connections should only store existing synapses: the header lists the pre/post IDs of every synapse
+//! once, and each snapshot then stores one weight per synapse in the same order
+TEST(ConnMon, weightFileSparse) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const int GRP_SIZE = 100;
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		long fileLength[2] = {0,0};
+		int nSyn = 0;
+		std::vector< std::vector<float> > wtMat;
+		for (int interval=-1; interval<=1; interval+=2) {
+			CARLsim* sim = new CARLsim("ConnMon.weightFileSparse",mode?GPU_MODE:CPU_MODE,SILENT,1,42);
+			int g0 = sim->createGroup("g0", GRP_SIZE, EXCITATORY_NEURON, 0);
+			sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+			sim->connect(g0,g0,"random",RangeWeight(0.05f),0.05f);
+			sim->setConductances(true);
+			sim->setupNetwork();
+
+			ConnectionMonitor* CM = sim->setConnectionMonitor(g0,g0,"results/weights_sparse.dat");
+			CM->setUpdateTimeIntervalSec(interval);
+			nSyn = CM->getNumSynapses();
+			if (interval==1) {
+				// snapshot at t=0 is recorded anyway, so this does not add to the file
+				wtMat = CM->takeSnapshot();
+			}
+			sim->runNetwork(2,0);
+			delete sim;
+
+			std::ifstream wtFile("results/weights_sparse.dat", std::ios::binary | std::ios::ate);
+			EXPECT_TRUE(wtFile.is_open());
+			if (wtFile) {
+				fileLength[(interval+1)/2] = wtFile.tellg();
+			}
+		}
+		ASSERT_GT(nSyn, 0);
+		ASSERT_LT(nSyn, GRP_SIZE*GRP_SIZE/10);
+
+		// 3 snapshots (t = 0, 1, 2 sec), each a timestamp plus one float per synapse
+		EXPECT_EQ(fileLength[1] - fileLength[0], 3*(8 + 4*nSyn));
+
+		// header contains the topology, but no dense matrix
+		EXPECT_GE(fileLength[0], 2*4*nSyn);
+		EXPECT_LT(fileLength[0], 2*4*nSyn + 100);
+
+		// read back the topology and the first snapshot, and compare to the dense matrix
+		FILE* fp = fopen("results/weights_sparse.dat", "rb");
+		ASSERT_TRUE(fp != NULL);
+		std::vector<int> nIdsPre(nSyn), nIdsPost(nSyn);
+		std::vector<float> wts(nSyn);
+		long long timeMs = -1;
+		fseek(fp, fileLength[0] - 2*4*nSyn, SEEK_SET);
+		EXPECT_EQ(fread(&nIdsPre[0], sizeof(int), nSyn, fp), (size_t)nSyn);
+		EXPECT_EQ(fread(&nIdsPost[0], sizeof(int), nSyn, fp), (size_t)nSyn);
+		EXPECT_EQ(fread(&timeMs, sizeof(long long), 1, fp), 1u);
+		EXPECT_EQ(fread(&wts[0], sizeof(float), nSyn, fp), (size_t)nSyn);
+		fclose(fp);
+		EXPECT_EQ(timeMs, 0);
+
+		int nFound = 0;
+		for (int i=0; i<GRP_SIZE; i++) {
+			for (int j=0; j<GRP_SIZE; j++) {
+				if (!std::isnan(wtMat[i][j]))
+					nFound++;
+			}
+		}
+		EXPECT_EQ(nFound, nSyn);
+		for (int k=0; k<nSyn; k++) {
+			EXPECT_FLOAT_EQ(wts[k], wtMat[nIdsPre[k]][nIdsPost[k]]);
+		}
+	}
+}
+
 TEST(ConnMon, weightChange) {
 	// set this flag to make all death tests thread-safe
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
@@ -131,6 +131,47 @@ TEST(Connect, connectFullNoDirect) {
 	delete sim;
 }
 
+TEST(Connect, connectFullIrregularGrid) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	CARLsim* sim = new CARLsim("Connect.connectFullIrregularGrid",CPU_MODE,SILENT,1,42);
+	Grid3D gridPre(7, 0.7f, -2.1f, 5, 1.3f, 0.4f, 3, 2.0f, -2.0f);
+	Grid3D gridPost(9, 0.5f, -2.0f, 4, 1.1f, 0.0f, 5, 0.9f, -1.8f);
+	int g0=sim->createGroup("excit0", gridPre, EXCITATORY_NEURON);
+	int g1=sim->createGroup("excit1", gridPost, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	RadiusRF radius[4] = {RadiusRF(1.3, 2.2, 1.7), RadiusRF(0.9, -1, 2.5), RadiusRF(-1, 1.0, 0.0), RadiusRF(0.3, 0.2, 0.4)};
+	int c[4];
+	for (int r=0; r<4; r++)
+		c[r] = sim->connect(g0, g1, "full", RangeWeight(0.1), 1.0, RangeDelay(1), radius[r]);
+
+	sim->setupNetwork(); // need SETUP state for this function to work
+
+	// compare to testing every (pre, post) pair
+	for (int r=0; r<4; r++) {
+		int numExpected = 0;
+		for (int i=0; i<gridPre.N; i++) {
+			Point3D pre = sim->getNeuronLocation3D(g0, i);
+			for (int j=0; j<gridPost.N; j++) {
+				Point3D post = sim->getNeuronLocation3D(g1, j);
+				if ((radius[r].radX==0 && pre.x!=post.x) || (radius[r].radY==0 && pre.y!=post.y)
+					|| (radius[r].radZ==0 && pre.z!=post.z))
+					continue;
+				double rfDist = 0.0;
+				if (radius[r].radX>0) rfDist += (pre.x-post.x)*(pre.x-post.x)/(radius[r].radX*radius[r].radX);
+				if (radius[r].radY>0) rfDist += (pre.y-post.y)*(pre.y-post.y)/(radius[r].radY*radius[r].radY);
+				if (radius[r].radZ>0) rfDist += (pre.z-post.z)*(pre.z-post.z)/(radius[r].radZ*radius[r].radZ);
+				numExpected += (rfDist <= 1.0);
+			}
+		}
+		EXPECT_EQ(sim->getNumSynapticConnections(c[r]), numExpected);
+	}
+
+	delete sim;
+}
+
 TEST(Connect, connectOneToOne) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -199,6 +240,147 @@ TEST(Connect, connectRandom) {
 }
 
 
+TEST(Connect, connectRandomLargeGroups) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	CARLsim* sim = new CARLsim("Connect.connectRandomLargeGroups",CPU_MODE,SILENT,1,42);
+	int g0=sim->createGroup("excit0", 1000, EXCITATORY_NEURON);
+	int g1=sim->createGroup("excit1", 800, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	int c0=sim->connect(g0,g1,"random",RangeWeight(0.1), 0.01, RangeDelay(1)); // sparse
+	int c1=sim->connect(g1,g0,"random",RangeWeight(0.1), 0.5, RangeDelay(1)); // dense
+
+	sim->setupNetwork(); // need SETUP state for this function to work
+	ConnectionMonitor* CM = sim->setConnectionMonitor(g0, g1, "NULL");
+
+	// number of synapses is binomial, allow for 5 standard deviations
+	EXPECT_NEAR(sim->getNumSynapticConnections(c0), 1000*800*0.01, 5*sqrt(1000*800*0.01*0.99));
+	EXPECT_NEAR(sim->getNumSynapticConnections(c1), 1000*800*0.5, 5*sqrt(1000*800*0.5*0.5));
+
+	// synapses must be spread over all pre-neurons, not just the first ones
+	std::vector<std::vector<float> > wt = CM->takeSnapshot();
+	int numFirstHalf = 0;
+	for (int i=0; i<500; i++)
+		for (int j=0; j<800; j++)
+			numFirstHalf += !isnan(wt[i][j]);
+	EXPECT_NEAR(numFirstHalf, sim->getNumSynapticConnections(c0)/2.0, 5*sqrt(500*800*0.01*0.99));
+
+	delete sim;
+}
+
+// connections draw from their own random streams, so the network only depends on the random seed
+TEST(Connect, connectSameSeedSameNetwork) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	int seeds[3] = {42, 42, 43};
+	std::vector<uint8_t> delays[3];
+	std::vector<std::vector<float> > wtGauss[3];
+	for (int s=0; s<3; s++) {
+		CARLsim* sim = new CARLsim("Connect.connectSameSeedSameNetwork",CPU_MODE,SILENT,1,seeds[s]);
+		Grid3D grid(10,10,6);
+		int g0=sim->createGroup("excit0", 600, EXCITATORY_NEURON);
+		int g1=sim->createGroup("excit1", 600, EXCITATORY_NEURON);
+		int g2=sim->createGroup("excit2", grid, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g2, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		sim->connect(g0, g1, "random", RangeWeight(0.1), 0.1, RangeDelay(1,20));
+		sim->connect(g2, g2, "gaussian", RangeWeight(0.1), 0.5, RangeDelay(1), RadiusRF(3,3,2));
+
+		sim->setupNetwork();
+
+		int numPre, numPost;
+		uint8_t* d = sim->getDelays(g0, g1, numPre, numPost);
+		delays[s].assign(d, d + numPre*numPost);
+		delete[] d;
+		wtGauss[s] = sim->setConnectionMonitor(g2, g2, "NULL")->takeSnapshot();
+
+		delete sim;
+	}
+
+	EXPECT_TRUE(delays[0] == delays[1]);
+	EXPECT_FALSE(delays[0] == delays[2]);
+	expectWeightsEqual(wtGauss[0], wtGauss[1]);
+}
+
+// a network read from the connection cache must be identical to the generated one
+TEST(Connect, connectionCache) {
+	std::vector<uint8_t> delays[4];
+	std::vector<std::vector<float> > wtGauss[4];
+	int numSyn[4], numSpikes[4];
+	std::string cacheFile[4];
+	for (int run=0; run<4; run++) {
+		CARLsim* sim = new CARLsim("Connect.connectionCache",CPU_MODE,SILENT,1,42);
+		Grid3D grid(10,10,3);
+		int g0=sim->createGroup("excit0", 300, EXCITATORY_NEURON);
+		int g1=sim->createGroup("inhib", 100, INHIBITORY_NEURON);
+		int g2=sim->createGroup("excit2", grid, EXCITATORY_NEURON);
+		int gIn=sim->createSpikeGeneratorGroup("input", 300, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.1f, 0.2f, -65.0f, 2.0f);
+		sim->setNeuronParameters(g2, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		// run 3 changes a delay range, which is part of the topology hash
+		int maxDelay = (run == 3) ? 20 : 10;
+		sim->connect(gIn, g0, "random", RangeWeight(0.0, 2.0, 4.0), 0.1, RangeDelay(1,maxDelay), RadiusRF(-1), SYN_PLASTIC);
+		sim->connect(g0, g1, "random", RangeWeight(1.0), 0.1, RangeDelay(1,5));
+		sim->connect(g1, g0, "full", RangeWeight(0.5), 1.0, RangeDelay(1));
+		int c3=sim->connect(g0, g2, "gaussian", RangeWeight(0.5), 0.5, RangeDelay(1,3), RadiusRF(3,3,1));
+		sim->setConductances(false);
+		sim->setESTDP(g0, true, STANDARD, ExpCurve(0.001f, 20.0f, -0.0012f, 20.0f));
+
+		// run 0 generates the network, run 1 generates or loads it, run 2 loads it, run 3 generates another one
+		if (run > 0)
+			sim->setConnectionCache("results");
+
+		sim->setupNetwork();
+		cacheFile[run] = sim->getConnectionCacheFile();
+		if (run > 0) {
+			FILE* fid = fopen(cacheFile[run].c_str(), "rb");
+			EXPECT_TRUE(fid != NULL);
+			if (fid != NULL) fclose(fid);
+		}
+
+		PoissonRate in(300);
+		in.setRates(20.0f);
+		sim->setSpikeRate(gIn, &in);
+		SpikeMonitor* SM = sim->setSpikeMonitor(g0, "NULL");
+
+		int numPre, numPost;
+		uint8_t* d = sim->getDelays(gIn, g0, numPre, numPost);
+		delays[run].assign(d, d + numPre*numPost);
+		delete[] d;
+		wtGauss[run] = sim->setConnectionMonitor(g0, g2, "NULL")->takeSnapshot();
+		numSyn[run] = sim->getNumSynapticConnections(c3);
+
+		SM->startRecording();
+		sim->runNetwork(0, 500, false);
+		SM->stopRecording();
+		numSpikes[run] = SM->getPopNumSpikes();
+
+		delete sim;
+	}
+
+	EXPECT_TRUE(cacheFile[0].empty());
+	EXPECT_EQ(cacheFile[1].find("results/conn_"), 0u);
+	for (int run=1; run<3; run++) {
+		EXPECT_EQ(cacheFile[run], cacheFile[1]);
+		EXPECT_TRUE(delays[run] == delays[0]);
+		EXPECT_EQ(numSyn[run], numSyn[0]);
+		EXPECT_EQ(numSpikes[run], numSpikes[0]);
+		expectWeightsEqual(wtGauss[run], wtGauss[0]);
+	}
+	EXPECT_GT(numSpikes[0], 0);
+
+	// a different topology must not be served from the cache of the first one
+	EXPECT_NE(cacheFile[3], cacheFile[1]);
+	EXPECT_FALSE(delays[3] == delays[0]);
+	EXPECT_GT(*std::max_element(delays[3].begin(), delays[3].end()), 10);
+}
+
 TEST(Connect, connectGaussian) {
 	CARLsim* sim = NULL;
 
@@ -50,6 +50,10 @@
 
 #include <carlsim.h>
 #include <vector>
+#include <math.h> // isnan
+#include <callback_core.h>
+#include <snn_definitions.h>
+#include <snn_datastructures.h> // SimFileSection
 
 #include <periodic_spikegen.h>
 
@@ -637,6 +641,397 @@ TEST(Core, saveLoadSimulation) {
 	}
 }
 
+// the network of the save/checkpoint tests: input -> exc (plastic, partition 0), exc <-> inh (across partitions)
+static void createTwoPartitionNetwork(CARLsim* sim, float wtIn, float wtRec, float alphaLTP, int& gIn, int& gExc,
+	int& gInh) {
+	gIn = sim->createSpikeGeneratorGroup("input", 50, EXCITATORY_NEURON, 0, CPU_CORES);
+	gExc = sim->createGroup("exc", 40, EXCITATORY_NEURON, 0, CPU_CORES);
+	gInh = sim->createGroup("inh", 30, INHIBITORY_NEURON, 1, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+
+	sim->connect(gIn, gExc, "random", RangeWeight(0.0, wtIn, 2*wtIn), 0.3f, RangeDelay(1, 10), RadiusRF(-1),
+		SYN_PLASTIC);
+	sim->connect(gExc, gInh, "random", RangeWeight(wtRec), 0.2f, RangeDelay(1, 5));
+	sim->connect(gInh, gExc, "random", RangeWeight(wtRec), 0.2f, RangeDelay(1, 3));
+	sim->setConductances(false);
+	sim->setESTDP(gExc, true, STANDARD, ExpCurve(alphaLTP, 20.0f, -1.2f*alphaLTP, 20.0f));
+}
+
+// synapses within and across partitions must be restored from the bulk arrays of the save file
+TEST(Core, saveLoadSimulationMultiPartition) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	std::vector<std::vector<float> > wtSave[3], wtLoad[3];
+	std::vector<uint8_t> delaySave, delayLoad;
+	for (int loadSim=0; loadSim<=1; loadSim++) {
+		// the loaded network uses a different seed, so it only matches if the synapses come from file
+		CARLsim* sim = new CARLsim("Core.saveLoadSimulationMultiPartition", CPU_MODE, SILENT, 0, 42 + loadSim);
+		int gIn, gExc, gInh;
+		createTwoPartitionNetwork(sim, 1.0f, 0.5f, 0.01f, gIn, gExc, gInh);
+
+		FILE* simFid = NULL;
+		if (loadSim) {
+			simFid = fopen("results/sim_multi.dat", "rb");
+			sim->loadSimulation(simFid);
+		}
+
+		sim->setupNetwork();
+
+		ConnectionMonitor* CM[3] = {sim->setConnectionMonitor(gIn, gExc, "NULL"),
+			sim->setConnectionMonitor(gExc, gInh, "NULL"), sim->setConnectionMonitor(gInh, gExc, "NULL")};
+		int numPre, numPost;
+		uint8_t* d = sim->getDelays(gIn, gExc, numPre, numPost);
+		std::vector<uint8_t>& delays = loadSim ? delayLoad : delaySave;
+		delays.assign(d, d + numPre*numPost);
+		delete[] d;
+
+		if (!loadSim) {
+			PoissonRate in(50);
+			in.setRates(30.0f);
+			sim->setSpikeRate(gIn, &in);
+			sim->runNetwork(1, 0, false); // change plastic weights before saving
+			for (int c=0; c<3; c++)
+				wtSave[c] = CM[c]->takeSnapshot();
+			sim->saveSimulation("results/sim_multi.dat", true);
+		} else {
+			for (int c=0; c<3; c++)
+				wtLoad[c] = CM[c]->takeSnapshot();
+		}
+
+		if (simFid != NULL) fclose(simFid);
+		delete sim;
+	}
+
+	EXPECT_TRUE(delaySave == delayLoad);
+	for (int c=0; c<3; c++)
+		expectWeightsEqual(wtSave[c], wtLoad[c]);
+}
+
+// files of version 0.3 store one record per synapse and must still be readable
+TEST(Core, loadSimulationVersion03) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	CARLsim* sim = new CARLsim("Core.loadSimulationVersion03", CPU_MODE, SILENT, 1, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 3, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", 2, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "full", RangeWeight(0.0, 1.0, 2.0), 1.0f, RangeDelay(1, 4), RadiusRF(-1), SYN_PLASTIC);
+	sim->setConductances(false);
+
+	// header, groups, and one record {grpPre, grpPost, nIdPre, nIdPost, connId, wt, maxWt, delay} per synapse
+	FILE* fid = fopen("results/sim_v03.dat", "wb");
+	int sig = 294338571, numN = 5, numGroups = 2, netCount = 1, numSyn = 6;
+	float version = 0.3f, simTime = 0.0f;
+	fwrite(&sig, sizeof(int), 1, fid);
+	fwrite(&version, sizeof(float), 1, fid);
+	fwrite(&simTime, sizeof(float), 1, fid);
+	fwrite(&simTime, sizeof(float), 1, fid);
+	fwrite(&numN, sizeof(int), 1, fid);
+	fwrite(&numGroups, sizeof(int), 1, fid);
+	// regular neurons come first: exc is [0,1], input is [2,4]
+	int grpInfo[2][5] = {{2, 4, 3, 1, 1}, {0, 1, 2, 1, 1}}; // startN, endN, numX, numY, numZ
+	const char* grpName[2] = {"input", "exc"};
+	for (int g=0; g<2; g++) {
+		char name[100] = {0};
+		strncpy(name, grpName[g], 99);
+		fwrite(grpInfo[g], sizeof(int), 5, fid);
+		fwrite(name, 1, 100, fid);
+	}
+	fwrite(&netCount, sizeof(int), 1, fid);
+	fwrite(&numSyn, sizeof(int), 1, fid);
+	for (int pre=0; pre<3; pre++) {
+		for (int post=0; post<2; post++) {
+			int rec[5] = {gIn, gExc, pre, post, 0};
+			float wt[2] = {0.1f*(pre*2+post+1), 2.0f};
+			int delay = 1 + (pre+post)%4;
+			fwrite(rec, sizeof(int), 5, fid);
+			fwrite(wt, sizeof(float), 2, fid);
+			fwrite(&delay, sizeof(int), 1, fid);
+		}
+	}
+	fclose(fid);
+
+	fid = fopen("results/sim_v03.dat", "rb");
+	sim->loadSimulation(fid);
+	sim->setupNetwork();
+
+	std::vector<std::vector<float> > wt = sim->setConnectionMonitor(gIn, gExc, "NULL")->takeSnapshot();
+	int numPre, numPost;
+	uint8_t* delays = sim->getDelays(gIn, gExc, numPre, numPost);
+	for (int pre=0; pre<3; pre++) {
+		for (int post=0; post<2; post++) {
+			EXPECT_FLOAT_EQ(wt[pre][post], 0.1f*(pre*2+post+1));
+			EXPECT_EQ(delays[pre + numPre*post], 1 + (pre+post)%4);
+		}
+	}
+	delete[] delays;
+
+	fclose(fid);
+	delete sim;
+}
+
+// deterministic connectivity for the synapse order test: which pairs connect and with what delay depends only on
+// (i,j), so the runtime arrays do not depend on the connection RNG
+class SynapseOrderConnGen : public ConnectionGenerator {
+public:
+	SynapseOrderConnGen(int type) : type_(type) {}
+	void connect(CARLsim* s, int srcGrp, int i, int destGrp, int j, float& weight, float& maxWt, float& delay,
+		bool& connected) {
+		switch (type_) {
+		case 0: connected = (i*7 + j*3)%4 != 0; delay = 1 + (i + 2*j)%4; break;
+		case 1: connected = (i + j)%2 == 0; delay = 1 + (i*j)%3; break;
+		default: connected = true; delay = 1 + (i + j)%2; break;
+		}
+		weight = 0.01f*(i*10 + j + 1);
+		maxWt = 1.0f;
+	}
+private:
+	int type_;
+};
+
+// the synapses are saved in the order of the runtime CSR arrays (by pre neuron, then by delay), which must match
+// the order produced by the per-synapse construction before it was replaced by the bulk build
+TEST(Core, saveSimulationSynapseOrder) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	// {grpPre, grpPost, nIdPre, nIdPost, connId, delay} as saved by the per-synapse construction
+	const int numSyn = 52;
+	const int expected[numSyn][6] = {
+		{1,2,0,0,1,1},{1,2,0,2,1,1},{1,2,1,3,1,1},{1,2,1,1,1,2},{1,2,2,0,1,1},{1,2,2,2,1,2},
+		{1,2,3,1,1,1},{1,2,3,3,1,1},{1,2,4,0,1,1},{1,2,4,2,1,3},{2,1,0,0,2,1},{2,1,0,2,2,1},
+		{2,1,0,4,2,1},{2,1,0,1,2,2},{2,1,0,3,2,2},{2,1,1,1,2,1},{2,1,1,3,2,1},{2,1,1,0,2,2},
+		{2,1,1,2,2,2},{2,1,1,4,2,2},{2,1,2,0,2,1},{2,1,2,2,2,1},{2,1,2,4,2,1},{2,1,2,1,2,2},
+		{2,1,2,3,2,2},{2,1,3,1,2,1},{2,1,3,3,2,1},{2,1,3,0,2,2},{2,1,3,2,2,2},{2,1,3,4,2,2},
+		{0,1,0,2,0,1},{0,1,0,1,0,3},{0,1,0,3,0,3},{0,1,1,0,0,2},{0,1,1,2,0,2},{0,1,1,4,0,2},
+		{0,1,1,1,0,4},{0,1,2,1,0,1},{0,1,2,3,0,1},{0,1,2,0,0,3},{0,1,2,4,0,3},{0,1,3,3,0,2},
+		{0,1,3,0,0,4},{0,1,3,2,0,4},{0,1,3,4,0,4},{0,1,4,2,0,1},{0,1,4,1,0,3},{0,1,4,3,0,3},
+		{0,1,5,0,0,2},{0,1,5,2,0,2},{0,1,5,4,0,2},{0,1,5,1,0,4}
+	};
+
+	CARLsim* sim = new CARLsim("Core.saveSimulationSynapseOrder", CPU_MODE, SILENT, 1, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 6, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", 5, EXCITATORY_NEURON);
+	int gInh = sim->createGroup("inh", 4, INHIBITORY_NEURON);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+	SynapseOrderConnGen cgInExc(0), cgExcInh(1), cgInhExc(2);
+	sim->connect(gIn, gExc, &cgInExc, SYN_PLASTIC);
+	sim->connect(gExc, gInh, &cgExcInh, SYN_FIXED);
+	sim->connect(gInh, gExc, &cgInhExc, SYN_FIXED);
+	sim->setConductances(false);
+	sim->setESTDP(gExc, true, STANDARD, ExpCurve(0.01f, 20.0f, -0.012f, 20.0f));
+	sim->setupNetwork();
+	sim->saveSimulation("results/sim_order.dat", true);
+	delete sim;
+
+	// skip the header (4 words, numN, numGroups, 120 bytes per group) and read the section table
+	FILE* fid = fopen("results/sim_order.dat", "rb");
+	ASSERT_TRUE(fid != NULL);
+	int numGroups = 0;
+	fseek(fid, 5*sizeof(int), SEEK_SET);
+	fread(&numGroups, sizeof(int), 1, fid);
+	fseek(fid, numGroups*(5*sizeof(int) + 100), SEEK_CUR);
+	int sectionHeader[2];
+	fread(sectionHeader, sizeof(int), 2, fid);
+	ASSERT_EQ(sectionHeader[0], numSyn);
+	fseek(fid, (ftell(fid) + 7) / 8 * 8, SEEK_SET);
+
+	long long sectionPos[NUM_SIM_SECTIONS] = {0};
+	for (int i = 0; i < sectionHeader[1]; i++) {
+		int sectionInfo[2];
+		long long pos[2];
+		fread(sectionInfo, sizeof(int), 2, fid);
+		fread(pos, sizeof(long long), 2, fid);
+		if (sectionInfo[0] >= 0 && sectionInfo[0] < NUM_SIM_SECTIONS)
+			sectionPos[sectionInfo[0]] = pos[0];
+	}
+
+	const int intSections[5] = {SIM_SECTION_GRP_ID_PRE, SIM_SECTION_GRP_ID_POST, SIM_SECTION_NEUR_ID_PRE,
+		SIM_SECTION_NEUR_ID_POST, SIM_SECTION_CONN_ID};
+	for (int s = 0; s < 5; s++) {
+		int val[numSyn];
+		fseek(fid, sectionPos[intSections[s]], SEEK_SET);
+		fread(val, sizeof(int), numSyn, fid);
+		for (int i = 0; i < numSyn; i++)
+			EXPECT_EQ(val[i], expected[i][s]) << "section " << intSections[s] << ", synapse " << i;
+	}
+
+	float wt[numSyn];
+	uint8_t delay[numSyn];
+	fseek(fid, sectionPos[SIM_SECTION_WEIGHT], SEEK_SET);
+	fread(wt, sizeof(float), numSyn, fid);
+	fseek(fid, sectionPos[SIM_SECTION_DELAY], SEEK_SET);
+	fread(delay, sizeof(uint8_t), numSyn, fid);
+	// weights of inhibitory synapses are stored as negative values
+	for (int i = 0; i < numSyn; i++) {
+		EXPECT_EQ(delay[i], expected[i][5]) << "synapse " << i;
+		EXPECT_FLOAT_EQ(fabs(wt[i]), 0.01f*(expected[i][2]*10 + expected[i][3] + 1)) << "synapse " << i;
+	}
+
+	fclose(fid);
+}
+
+// a run that is restored from a checkpoint must continue exactly like the original run
+TEST(Core, checkpointRestart) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	std::vector<std::vector<int> > spkExc[2], spkInh[2];
+	std::vector<std::vector<float> > wt[2];
+	for (int restore=0; restore<=1; restore++) {
+		CARLsim* sim = new CARLsim("Core.checkpointRestart", CPU_MODE, SILENT, 0, 42);
+		int gIn, gExc, gInh;
+		createTwoPartitionNetwork(sim, 8.0f, 5.0f, 0.01f, gIn, gExc, gInh);
+		sim->setupNetwork();
+
+		SpikeMonitor* SMexc = sim->setSpikeMonitor(gExc, "NULL");
+		SpikeMonitor* SMinh = sim->setSpikeMonitor(gInh, "NULL");
+		ConnectionMonitor* CM = sim->setConnectionMonitor(gIn, gExc, "NULL");
+		PoissonRate in(50);
+		in.setRates(30.0f);
+		sim->setSpikeRate(gIn, &in);
+
+		if (!restore) {
+			// stop in the middle of a second, so that the checkpoint holds spikes in flight
+			sim->runNetwork(1, 300, false);
+			sim->saveCheckpoint("results/checkpoint.dat");
+		} else {
+			sim->loadCheckpoint("results/checkpoint.dat");
+		}
+
+		SMexc->startRecording();
+		SMinh->startRecording();
+		sim->runNetwork(1, 0, false);
+		SMexc->stopRecording();
+		SMinh->stopRecording();
+
+		spkExc[restore] = SMexc->getSpikeVector2D();
+		spkInh[restore] = SMinh->getSpikeVector2D();
+		wt[restore] = CM->takeSnapshot();
+		delete sim;
+	}
+
+	int numSpikes = 0;
+	for (int i=0; i<spkExc[0].size(); i++)
+		numSpikes += spkExc[0][i].size();
+	EXPECT_GT(numSpikes, 0);
+	EXPECT_TRUE(spkExc[0] == spkExc[1]);
+	EXPECT_TRUE(spkInh[0] == spkInh[1]);
+	expectWeightsEqual(wt[0], wt[1]);
+}
+
+// the pending spikes of an event-driven Poisson group are part of the checkpoint, so the input is not redrawn
+TEST(Core, checkpointRestartEventDriven) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	std::vector<std::vector<int> > spkIn[2], spkExc[2];
+	for (int restore=0; restore<=1; restore++) {
+		CARLsim* sim = new CARLsim("Core.checkpointRestartEventDriven", CPU_MODE, SILENT, 0, 42);
+		int gIn, gExc, gInh;
+		createTwoPartitionNetwork(sim, 8.0f, 5.0f, 0.01f, gIn, gExc, gInh);
+		sim->setupNetwork();
+
+		SpikeMonitor* SMin = sim->setSpikeMonitor(gIn, "NULL");
+		SpikeMonitor* SMexc = sim->setSpikeMonitor(gExc, "NULL");
+		// a low rate, so that most inter-spike intervals span the checkpoint
+		PoissonRate in(50);
+		in.setRates(5.0f);
+		sim->setSpikeRate(gIn, &in, 1, true);
+
+		if (!restore) {
+			sim->runNetwork(1, 300, false);
+			sim->saveCheckpoint("results/checkpoint.dat");
+		} else {
+			sim->loadCheckpoint("results/checkpoint.dat");
+		}
+
+		SMin->startRecording();
+		SMexc->startRecording();
+		sim->runNetwork(1, 0, false);
+		SMin->stopRecording();
+		SMexc->stopRecording();
+
+		spkIn[restore] = SMin->getSpikeVector2D();
+		spkExc[restore] = SMexc->getSpikeVector2D();
+		delete sim;
+	}
+
+	int numSpikes = 0;
+	for (int i=0; i<spkIn[0].size(); i++)
+		numSpikes += spkIn[0][i].size();
+	EXPECT_GT(numSpikes, 0);
+	EXPECT_TRUE(spkIn[0] == spkIn[1]);
+	EXPECT_TRUE(spkExc[0] == spkExc[1]);
+}
+
+// a base checkpoint plus its deltas restores the plastic weights; with an epsilon, up to that epsilon
+TEST(Core, checkpointDelta) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const float epsilon = 0.05f;
+	std::vector<std::vector<float> > wt[3];
+	for (int restore=0; restore<=2; restore++) {
+		CARLsim* sim = new CARLsim("Core.checkpointDelta", CPU_MODE, SILENT, 0, 42);
+		int gIn, gExc, gInh;
+		createTwoPartitionNetwork(sim, 8.0f, 5.0f, 0.1f, gIn, gExc, gInh);
+		sim->setupNetwork();
+
+		ConnectionMonitor* CM = sim->setConnectionMonitor(gIn, gExc, "NULL");
+		PoissonRate in(50);
+		in.setRates(30.0f);
+		sim->setSpikeRate(gIn, &in);
+
+		if (restore == 0) {
+			sim->runNetwork(1, 0, false);
+			sim->saveCheckpoint("results/checkpoint_base.dat");
+			sim->runNetwork(1, 0, false);
+			sim->saveCheckpointDelta("results/checkpoint_delta1.dat");
+			sim->runNetwork(1, 0, false);
+			sim->saveCheckpointDelta("results/checkpoint_delta2.dat");
+			sim->saveCheckpointDelta("results/checkpoint_delta3.dat", epsilon);
+		} else if (restore == 1) {
+			sim->loadCheckpoint("results/checkpoint_base.dat");
+			sim->loadCheckpointDelta("results/checkpoint_delta1.dat");
+			sim->loadCheckpointDelta("results/checkpoint_delta2.dat");
+
+			// deltas must be replayed in order
+			EXPECT_DEATH({sim->loadCheckpointDelta("results/checkpoint_delta1.dat");}, "");
+		} else {
+			sim->loadCheckpoint("results/checkpoint_base.dat");
+			sim->loadCheckpointDelta("results/checkpoint_delta3.dat");
+		}
+
+		wt[restore] = CM->takeSnapshot();
+		delete sim;
+	}
+
+	// the deltas are much smaller than the full checkpoint
+	FILE* fid = fopen("results/checkpoint_base.dat", "rb");
+	fseek(fid, 0, SEEK_END);
+	long sizeBase = ftell(fid);
+	fclose(fid);
+	fid = fopen("results/checkpoint_delta2.dat", "rb");
+	fseek(fid, 0, SEEK_END);
+	long sizeDelta = ftell(fid);
+	fclose(fid);
+	EXPECT_LT(sizeDelta * 4, sizeBase);
+
+	bool weightsChanged = false;
+	ASSERT_EQ(wt[0].size(), wt[1].size());
+	for (int i=0; i<wt[0].size(); i++) {
+		for (int j=0; j<wt[0][i].size(); j++) {
+			if (isnan(wt[0][i][j])) {
+				EXPECT_TRUE(isnan(wt[1][i][j]) && isnan(wt[2][i][j]));
+				continue;
+			}
+			EXPECT_FLOAT_EQ(wt[0][i][j], wt[1][i][j]);
+			EXPECT_NEAR(wt[0][i][j], wt[2][i][j], epsilon);
+			weightsChanged |= wt[0][i][j] != 8.0f;
+		}
+	}
+	EXPECT_TRUE(weightsChanged);
+}
+
 TEST(Core, synapseIdOverflow) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -651,3 +1046,74 @@ TEST(Core, synapseIdOverflow) {
 	
 	EXPECT_DEATH({ sim.setupNetwork(); }, ""); //sim.setupNetwork();
 }
+
+// the vectorized neuron update of the CPU runtime must produce the same voltages and spikes as the scalar path for
+// every neuron model and integration method it covers (100 neurons leave a remainder for the scalar loop)
+TEST(Core, cpuVectorizationVsScalar) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const int NUM_N = 100;
+	const char* model[4] = {"izh4-euler-cuba", "izh4-euler-coba", "izh9-rk4-cuba", "lif-cuba"};
+	const float wt[4] = {8.0f, 0.5f, 120.0f, 40.0f};
+	std::vector<std::vector<int> > spikes[2];
+	std::vector<float> voltage[2];
+
+	for (int m = 0; m < 4; m++) {
+		for (int vectorized = 0; vectorized <= 1; vectorized++) {
+			CARLsim* sim = new CARLsim("Core.cpuVectorizationVsScalar", CPU_MODE, SILENT, 0, 42);
+			sim->setCPUVectorization(vectorized > 0);
+
+			int gIn = sim->createSpikeGeneratorGroup("input", NUM_N, EXCITATORY_NEURON);
+			int gOut;
+			if (m < 3) {
+				gOut = sim->createGroup("output", NUM_N, EXCITATORY_NEURON);
+			} else {
+				gOut = sim->createGroupLIF("output", NUM_N, EXCITATORY_NEURON);
+				sim->setNeuronParametersLIF(gOut, 10, 2, -50.0f, -65.0f, RangeRmem(5.0f));
+			}
+			if (m < 2) {
+				sim->setNeuronParameters(gOut, 0.02f, 0.005f, 0.2f, 0.01f, -65.0f, 1.0f, 8.0f, 0.5f);
+			} else if (m == 2) {
+				sim->setNeuronParameters(gOut, 100.0f, 5.0f, 0.7f, 0.05f, -60.0f, 1.0f, -40.0f, 1.0f, 0.03f, 0.001f,
+					-2.0f, 0.1f, 35.0f, 1.0f, -50.0f, 1.0f, 100.0f, 5.0f);
+				sim->setIntegrationMethod(RUNGE_KUTTA4, 10);
+			}
+
+			sim->connect(gIn, gOut, "random", RangeWeight(wt[m]), 0.2f, RangeDelay(1, 5));
+			sim->setConductances(m == 1);
+			NeuronMonitor* nm = sim->setNeuronMonitor(gOut, "results/nrn_vectorization.dat");
+			sim->setupNetwork();
+
+			SpikeMonitor* sm = sim->setSpikeMonitor(gOut, "NULL");
+			PoissonRate in(NUM_N);
+			in.setRates(20.0f);
+			sim->setSpikeRate(gIn, &in);
+
+			sm->startRecording();
+			nm->startRecording();
+			sim->runNetwork(0, 500);
+			nm->stopRecording();
+			sm->stopRecording();
+			spikes[vectorized] = sm->getSpikeVector2D();
+			EXPECT_GT(sm->getPopNumSpikes(), 0) << model[m];
+			delete sim;
+
+			// header of 6 words, followed by records {time, neurId, v, u, I}
+			FILE* fid = fopen("results/nrn_vectorization.dat", "rb");
+			ASSERT_TRUE(fid != NULL);
+			fseek(fid, 6*sizeof(int), SEEK_SET);
+			voltage[vectorized].clear();
+			int rec[2];
+			float state[3];
+			while (fread(rec, sizeof(int), 2, fid) == 2 && fread(state, sizeof(float), 3, fid) == 3)
+				voltage[vectorized].push_back(state[0]);
+			fclose(fid);
+		}
+
+		EXPECT_EQ(spikes[0], spikes[1]) << model[m];
+		ASSERT_EQ(voltage[0].size(), voltage[1].size()) << model[m];
+		EXPECT_GT(voltage[0].size(), 0) << model[m];
+		for (int i = 0; i < voltage[0].size(); i++)
+			ASSERT_NEAR(voltage[0][i], voltage[1][i], 1e-4f) << model[m] << ", record " << i;
+	}
+}
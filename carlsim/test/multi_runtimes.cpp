@@ -50,6 +50,9 @@
 #include "gtest/gtest.h"
 #include "carlsim_tests.h"
 #include <carlsim.h>
+#include <periodic_spikegen.h>
+#include <math.h> // isnan
+#include <set>
 
 /*
 	class FixedRandomConnGen - Subclass of the connectionGenerator class to define custom connections between two groups
@@ -174,6 +177,132 @@ TEST(MultiRuntimes, spikesSingleVsMultiX2) {
 	}
 }
 
+//! Poisson spikes are drawn from a counter-based RNG keyed by (seed, group, time), so moving a Poisson group to
+//! another partition (and therefore another thread) must not change its spikes, nor the spikes of other Poisson
+//! groups. Neurons with zero rate must never fire.
+TEST(MultiRuntimes, poissonSpikesSingleVsMulti) {
+	const int GRP_SIZE = 20;
+	std::vector<std::vector<int> > spikes[2][2];
+
+	int randSeed = rand();
+	for (int partition = 0; partition < 2; partition++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.poissonSpikesSingleVsMulti", CPU_MODE, SILENT, 0, randSeed);
+
+		int gIn0 = sim->createSpikeGeneratorGroup("in0", GRP_SIZE, EXCITATORY_NEURON, 0, CPU_CORES);
+		int gIn1 = sim->createSpikeGeneratorGroup("in1", GRP_SIZE, EXCITATORY_NEURON, partition, CPU_CORES);
+		int gExc0 = sim->createGroup("exc0", GRP_SIZE, EXCITATORY_NEURON, 0, CPU_CORES);
+		int gExc1 = sim->createGroup("exc1", GRP_SIZE, EXCITATORY_NEURON, partition, CPU_CORES);
+		sim->setNeuronParameters(gExc0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(gExc1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(gIn0, gExc0, "one-to-one", RangeWeight(1.0f), 1.0f);
+		sim->connect(gIn1, gExc1, "one-to-one", RangeWeight(1.0f), 1.0f);
+		sim->setConductances(false);
+		sim->setupNetwork();
+
+		SpikeMonitor* sm[2];
+		sm[0] = sim->setSpikeMonitor(gIn0, "NULL");
+		sm[1] = sim->setSpikeMonitor(gIn1, "NULL");
+
+		// every other neuron is silent
+		PoissonRate in(GRP_SIZE);
+		for (int i = 0; i < GRP_SIZE; i++)
+			in.setRate(i, (i % 2) ? 0.0f : 40.0f);
+		sim->setSpikeRate(gIn0, &in);
+		sim->setSpikeRate(gIn1, &in);
+
+		sm[0]->startRecording();
+		sm[1]->startRecording();
+		sim->runNetwork(1, 0);
+		sm[0]->stopRecording();
+		sm[1]->stopRecording();
+
+		for (int g = 0; g < 2; g++) {
+			spikes[partition][g] = sm[g]->getSpikeVector2D();
+			EXPECT_GT(sm[g]->getPopNumSpikes(), 0);
+		}
+
+		delete sim;
+	}
+
+	for (int g = 0; g < 2; g++) {
+		for (int nId = 0; nId < GRP_SIZE; nId++) {
+			if (nId % 2) {
+				EXPECT_EQ(spikes[0][g][nId].size(), 0u);
+			}
+			EXPECT_EQ(spikes[0][g][nId], spikes[1][g][nId]);
+		}
+	}
+
+	// the two groups use different random streams
+	EXPECT_NE(spikes[0][0], spikes[0][1]);
+}
+
+//! The workers of a CPU runtime each own a contiguous range of neurons, so the number of workers must not change
+//! the spikes or the learned weights of a seeded network.
+TEST(MultiRuntimes, spikesAndWeightsSingleVsMultiThreaded) {
+	const int NUM_THREADS[2] = {1, 4};
+	std::vector<std::vector<int> > spikesExc[2], spikesInh[2];
+	std::vector<std::vector<float> > weights[2];
+
+	int randSeed = rand();
+	for (int coba = 0; coba <= 1; coba++) {
+		for (int t = 0; t < 2; t++) {
+			CARLsim* sim = new CARLsim("MultiRuntimes.spikesAndWeightsSingleVsMultiThreaded", CPU_MODE, SILENT, 0,
+				randSeed);
+			sim->setNumCPUThreads(NUM_THREADS[t]);
+
+			int gIn = sim->createSpikeGeneratorGroup("input", 200, EXCITATORY_NEURON, 0, CPU_CORES);
+			int gExc = sim->createGroup("exc", 400, EXCITATORY_NEURON, 0, CPU_CORES);
+			int gInh = sim->createGroup("inh", 100, INHIBITORY_NEURON, 0, CPU_CORES);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+			sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+
+			float wtScale = coba ? 0.05f : 1.0f;
+			sim->connect(gIn, gExc, "random", RangeWeight(0.0f, 8.0f*wtScale, 16.0f*wtScale), 0.1f, RangeDelay(1, 10),
+				RadiusRF(-1), SYN_PLASTIC);
+			sim->connect(gExc, gExc, "random", RangeWeight(2.0f*wtScale), 0.05f, RangeDelay(1, 20));
+			sim->connect(gExc, gInh, "random", RangeWeight(4.0f*wtScale), 0.1f, RangeDelay(1, 5));
+			sim->connect(gInh, gExc, "random", RangeWeight(4.0f*wtScale), 0.1f, RangeDelay(1));
+			sim->setConductances(coba > 0);
+			sim->setESTDP(gExc, true, STANDARD, ExpCurve(0.1f*wtScale, 20.0f, -0.12f*wtScale, 20.0f));
+			sim->setupNetwork();
+
+			SpikeMonitor* smExc = sim->setSpikeMonitor(gExc, "NULL");
+			SpikeMonitor* smInh = sim->setSpikeMonitor(gInh, "NULL");
+			ConnectionMonitor* cm = sim->setConnectionMonitor(gIn, gExc, "NULL");
+
+			PoissonRate in(200);
+			in.setRates(20.0f);
+			sim->setSpikeRate(gIn, &in);
+
+			smExc->startRecording();
+			smInh->startRecording();
+			sim->runNetwork(1, 0);
+			smExc->stopRecording();
+			smInh->stopRecording();
+
+			spikesExc[t] = smExc->getSpikeVector2D();
+			spikesInh[t] = smInh->getSpikeVector2D();
+			weights[t] = cm->takeSnapshot();
+			EXPECT_GT(smExc->getPopNumSpikes(), 0);
+
+			delete sim;
+		}
+
+		EXPECT_EQ(spikesExc[0], spikesExc[1]);
+		EXPECT_EQ(spikesInh[0], spikesInh[1]);
+		ASSERT_EQ(weights[0].size(), weights[1].size());
+		for (int i = 0; i < weights[0].size(); i++) {
+			for (int j = 0; j < weights[0][i].size(); j++) {
+				if (isnan(weights[0][i][j]))
+					EXPECT_TRUE(isnan(weights[1][i][j]));
+				else
+					EXPECT_FLOAT_EQ(weights[0][i][j], weights[1][i][j]);
+			}
+		}
+	}
+}
+
 TEST(MultiRuntimes, spikesSingleVsMultiX2_2_GPU_MultiGPU) {
 	int gExc, gExc2, gInput;
 	std::vector<std::vector<int> > spikesSingleRuntime, spikesMultiRuntimes;
@@ -517,3 +646,69 @@ TEST(MultiRuntimes, shuffleGroups_2_GPU_MultiGPU) {
 		}
 	}
 }
+
+// groups without a preferred partition are placed by the hybrid partitioner, which must not change the network dynamics
+TEST(MultiRuntimes, hybridPartitionVsSingleRuntime) {
+	int nNeur = 4096; // large enough to be split into two partitions
+	std::vector<std::vector<int> > spikesSingleRuntime, spikesHybrid;
+	std::set<int> netIds;
+	int randSeed = 42;
+
+	for (int hybrid = 0; hybrid < 2; hybrid++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.hybridPartitionVsSingleRuntime", hybrid ? HYBRID_MODE : CPU_MODE, SILENT, 0, randSeed);
+
+		// configure the network, deterministic connections so that both runs see the same topology
+		int gInput = sim->createSpikeGeneratorGroup("input", nNeur, EXCITATORY_NEURON);
+		int gExc1 = sim->createGroup("exc1", nNeur, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc1, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+		int gExc2 = sim->createGroup("exc2", nNeur, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc2, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+		int gInh = sim->createGroup("inh", nNeur, INHIBITORY_NEURON);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+		sim->connect(gInput, gExc1, "one-to-one", RangeWeight(30.0f), 1.0f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc1, gExc2, "one-to-one", RangeWeight(30.0f), 1.0f, RangeDelay(5), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc2, gInh, "one-to-one", RangeWeight(30.0f), 1.0f, RangeDelay(3), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh, gExc1, "one-to-one", RangeWeight(10.0f), 1.0f, RangeDelay(2), RadiusRF(-1), SYN_FIXED);
+
+		sim->setConductances(false);
+
+		// the partitioner uses at most one CPU partition per core, independent of the cores of this machine
+		sim->setNumCPUCores(2);
+
+		PeriodicSpikeGenerator* spkGen = new PeriodicSpikeGenerator(10.0f, true);
+		sim->setSpikeGenerator(gInput, spkGen);
+
+		// build the network
+		sim->setupNetwork();
+
+		if (hybrid) {
+			for (int g = 0; g < sim->getNumGroups(); g++)
+				netIds.insert(sim->getGroupNetId(g));
+		}
+
+		SpikeMonitor* smInh = sim->setSpikeMonitor(gInh, "NULL");
+		smInh->startRecording();
+		sim->runNetwork(1, 0);
+		smInh->stopRecording();
+
+		if (hybrid)
+			spikesHybrid = smInh->getSpikeVector2D();
+		else
+			spikesSingleRuntime = smInh->getSpikeVector2D();
+
+		delete spkGen;
+		delete sim;
+	}
+
+	// the groups without a preferred partition must have been split
+	ASSERT_GT(netIds.size(), 1u);
+
+	ASSERT_EQ(spikesSingleRuntime.size(), spikesHybrid.size());
+	for (int nId = 0; nId < spikesSingleRuntime.size(); nId++) {
+		EXPECT_GT(spikesSingleRuntime[nId].size(), 0);
+		EXPECT_EQ(spikesSingleRuntime[nId].size(), spikesHybrid[nId].size()); // the same number of spikes
+		for (int s = 0; s < spikesSingleRuntime[nId].size() && s < spikesHybrid[nId].size(); s++)
+			EXPECT_EQ(spikesSingleRuntime[nId][s], spikesHybrid[nId][s]); // the same spike timing
+	}
+}
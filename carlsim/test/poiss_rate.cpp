@@ -202,3 +202,116 @@ TEST(PoissRate, runSim) {
 	// \TODO test CARLsim integration
 	// \TODO use cuRAND
 }
+
+//! event-driven Poisson groups draw inter-spike intervals instead of testing every neuron every ms: the population rate
+//! should match the requested rate, silent neurons must stay silent, ISIs must honor the refractory period, and new
+//! rates must take effect at the next runNetwork
+TEST(PoissRate, eventDriven) {
+	const int GRP_SIZE = 500;
+	const int REF_PERIOD = 20;
+
+	CARLsim* sim = new CARLsim("PoissRate.eventDriven", CPU_MODE, SILENT, 1, 42);
+	int g0 = sim->createSpikeGeneratorGroup("in0", GRP_SIZE, EXCITATORY_NEURON);
+	int g1 = sim->createSpikeGeneratorGroup("in1", GRP_SIZE, EXCITATORY_NEURON);
+	int gOut = sim->createGroup("out", 1, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(g0, gOut, "full", RangeWeight(0.0f), 1.0f);
+	sim->connect(g1, gOut, "full", RangeWeight(0.0f), 1.0f);
+	sim->setConductances(false);
+	sim->setupNetwork();
+
+	// every fifth neuron of g0 is silent
+	PoissonRate rate0(GRP_SIZE), rate1(GRP_SIZE);
+	for (int i = 0; i < GRP_SIZE; i++)
+		rate0.setRate(i, (i % 5) ? 10.0f : 0.0f);
+	rate1.setRates(30.0f);
+	sim->setSpikeRate(g0, &rate0, 1, true);
+	sim->setSpikeRate(g1, &rate1, REF_PERIOD, true);
+
+	SpikeMonitor* sm0 = sim->setSpikeMonitor(g0, "NULL");
+	SpikeMonitor* sm1 = sim->setSpikeMonitor(g1, "NULL");
+	sm0->startRecording();
+	sm1->startRecording();
+	sim->runNetwork(10, 0);
+	sm0->stopRecording();
+	sm1->stopRecording();
+
+	std::vector<std::vector<int> > spk0 = sm0->getSpikeVector2D();
+	int nSpk0 = 0;
+	for (int i = 0; i < GRP_SIZE; i++) {
+		if (i % 5 == 0) {
+			EXPECT_EQ(spk0[i].size(), 0u);
+		}
+		nSpk0 += spk0[i].size();
+	}
+	// 400 neurons * 10Hz * 10s = 40000 spikes, std ~ 200
+	EXPECT_NEAR(nSpk0, 40000, 1000);
+
+	// with a dead time of REF_PERIOD-1 ms after every spike, the rate is 1/(1/30Hz + 19ms) ~ 19.1Hz
+	std::vector<std::vector<int> > spk1 = sm1->getSpikeVector2D();
+	int nSpk1 = 0;
+	for (int i = 0; i < GRP_SIZE; i++) {
+		nSpk1 += spk1[i].size();
+		for (int s = 1; s < spk1[i].size(); s++)
+			EXPECT_GE(spk1[i][s] - spk1[i][s-1], REF_PERIOD);
+	}
+	EXPECT_NEAR(nSpk1 / (GRP_SIZE * 10.0), 1000.0 / (1000.0 / 30.0 + REF_PERIOD - 1), 1.0);
+
+	// silence g1 and switch g0 to a uniform rate
+	rate0.setRates(5.0f);
+	rate1.setRates(0.0f);
+	sim->setSpikeRate(g0, &rate0, 1, true);
+	sim->setSpikeRate(g1, &rate1, REF_PERIOD, true);
+	sm0->clear();
+	sm1->clear();
+	sm0->startRecording();
+	sm1->startRecording();
+	sim->runNetwork(10, 0);
+	sm0->stopRecording();
+	sm1->stopRecording();
+	EXPECT_NEAR(sm0->getPopNumSpikes(), 25000, 800);
+	EXPECT_EQ(sm1->getPopNumSpikes(), 0);
+
+	delete sim;
+}
+
+//! setting the rates of one event-driven group must not redraw the scheduled spikes of another one
+TEST(PoissRate, eventDrivenSetSpikeRateOtherGroup) {
+	const int GRP_SIZE = 100;
+
+	std::vector<std::vector<int> > spk0[2];
+	for (int update = 0; update <= 1; update++) {
+		CARLsim* sim = new CARLsim("PoissRate.eventDrivenSetSpikeRateOtherGroup", CPU_MODE, SILENT, 1, 42);
+		int g0 = sim->createSpikeGeneratorGroup("in0", GRP_SIZE, EXCITATORY_NEURON);
+		int g1 = sim->createSpikeGeneratorGroup("in1", GRP_SIZE, EXCITATORY_NEURON);
+		int gOut = sim->createGroup("out", 1, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(g0, gOut, "full", RangeWeight(0.0f), 1.0f);
+		sim->connect(g1, gOut, "full", RangeWeight(0.0f), 1.0f);
+		sim->setConductances(false);
+		sim->setupNetwork();
+
+		PoissonRate rate0(GRP_SIZE), rate1(GRP_SIZE);
+		rate0.setRates(5.0f);
+		rate1.setRates(20.0f);
+		sim->setSpikeRate(g0, &rate0, 1, true);
+		sim->setSpikeRate(g1, &rate1, 1, true);
+		SpikeMonitor* sm0 = sim->setSpikeMonitor(g0, "NULL");
+		sim->runNetwork(0, 500);
+
+		if (update) {
+			rate1.setRates(40.0f);
+			sim->setSpikeRate(g1, &rate1, 1, true);
+		}
+
+		sm0->startRecording();
+		sim->runNetwork(1, 0);
+		sm0->stopRecording();
+		spk0[update] = sm0->getSpikeVector2D();
+
+		delete sim;
+	}
+
+	EXPECT_GT(spk0[0].size(), 0u);
+	EXPECT_TRUE(spk0[0] == spk0[1]);
+}
@@ -113,6 +113,125 @@ TEST(spikeGenFunc, PeriodicSpikeGenerator) {
 	if (inputArray1!=NULL) delete[] inputArray1;
 }
 
+//! spike generator groups on different CPU partitions are scheduled into separate arrays of the SpikeBuffer, make
+//! sure every partition receives exactly the spikes of its own groups
+TEST(spikeGenFunc, PeriodicSpikeGeneratorMultiPartition) {
+	const int nNeur = 40;
+	CARLsim sim("PeriodicSpikeGeneratorMultiPartition",CPU_MODE,SILENT,0,42);
+
+	int g0 = sim.createSpikeGeneratorGroup("Input0",nNeur,EXCITATORY_NEURON,0,CPU_CORES);
+	int g1 = sim.createSpikeGeneratorGroup("Input1",nNeur,EXCITATORY_NEURON,1,CPU_CORES);
+	int g2 = sim.createGroup("g2", 1, EXCITATORY_NEURON,0,CPU_CORES);
+	int g3 = sim.createGroup("g3", 1, EXCITATORY_NEURON,1,CPU_CORES);
+	sim.setNeuronParameters(g2, 0.02, 0.2, -65.0, 8.0);
+	sim.setNeuronParameters(g3, 0.02, 0.2, -65.0, 8.0);
+	PeriodicSpikeGenerator spkGen0(10.0f,true);
+	PeriodicSpikeGenerator spkGen1(25.0f,true);
+	sim.setSpikeGenerator(g0, &spkGen0);
+	sim.setSpikeGenerator(g1, &spkGen1);
+	sim.connect(g0,g2,"full", RangeWeight(0.0f), 1.0f);
+	sim.connect(g1,g3,"full", RangeWeight(0.0f), 1.0f);
+	sim.setConductances(false);
+	sim.setupNetwork();
+
+	SpikeMonitor* sm0 = sim.setSpikeMonitor(g0,"NULL");
+	SpikeMonitor* sm1 = sim.setSpikeMonitor(g1,"NULL");
+	sm0->startRecording();
+	sm1->startRecording();
+	sim.runNetwork(2,0);
+	sm0->stopRecording();
+	sm1->stopRecording();
+
+	std::vector<std::vector<int> > spk0 = sm0->getSpikeVector2D();
+	std::vector<std::vector<int> > spk1 = sm1->getSpikeVector2D();
+	for (int i=0; i<nNeur; i++) {
+		ASSERT_EQ(spk0[i].size(), 20);
+		ASSERT_EQ(spk1[i].size(), 50);
+		for (int s=0; s<spk0[i].size(); s++)
+			EXPECT_EQ(spk0[i][s], s*100);
+		for (int s=0; s<spk1[i].size(); s++)
+			EXPECT_EQ(spk1[i][s], s*40);
+	}
+}
+
+// neuron i spikes every (i+10) ms, scheduled one spike at a time
+class StaggeredSpikeGenerator : public SpikeGenerator {
+public:
+	int nextSpikeTime(CARLsim* s, int grpId, int i, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice) {
+		return lastScheduledSpikeTime + i + 10;
+	}
+};
+
+// same spike times as StaggeredSpikeGenerator, scheduled a whole time slice at a time
+class StaggeredBatchSpikeGenerator : public SpikeGenerator {
+public:
+	bool generateSpikes(CARLsim* s, int grpId, int tStart, int tEnd, SpikeSink& sink) {
+		for (int i=0; i<s->getGroupNumNeurons(grpId); i++) {
+			int isi = i + 10;
+			for (int t = (tStart + isi - 1) / isi * isi; t < tEnd; t += isi) {
+				if (t > 0)
+					sink.addSpike(t, i);
+			}
+		}
+		return true;
+	}
+};
+
+// the batch interface must schedule exactly the same spikes as the per-neuron interface
+TEST(spikeGenFunc, generateSpikesBatchVsNextSpikeTime) {
+	const int nNeur = 20;
+	CARLsim sim("generateSpikesBatchVsNextSpikeTime",CPU_MODE,SILENT,0,42);
+
+	int g0 = sim.createSpikeGeneratorGroup("Input0",nNeur,EXCITATORY_NEURON);
+	int g1 = sim.createSpikeGeneratorGroup("Input1",nNeur,EXCITATORY_NEURON);
+	int g2 = sim.createGroup("g2", 1, EXCITATORY_NEURON);
+	sim.setNeuronParameters(g2, 0.02, 0.2, -65.0, 8.0);
+	StaggeredSpikeGenerator spkGen0;
+	StaggeredBatchSpikeGenerator spkGen1;
+	sim.setSpikeGenerator(g0, &spkGen0);
+	sim.setSpikeGenerator(g1, &spkGen1);
+	sim.connect(g0,g2,"full", RangeWeight(0.0f), 1.0f);
+	sim.connect(g1,g2,"full", RangeWeight(0.0f), 1.0f);
+	sim.setConductances(false);
+	sim.setupNetwork();
+
+	SpikeMonitor* sm0 = sim.setSpikeMonitor(g0,"NULL");
+	SpikeMonitor* sm1 = sim.setSpikeMonitor(g1,"NULL");
+	sm0->startRecording();
+	sm1->startRecording();
+	sim.runNetwork(1,500);
+	sim.runNetwork(0,700);
+	sm0->stopRecording();
+	sm1->stopRecording();
+
+	std::vector<std::vector<int> > spk0 = sm0->getSpikeVector2D();
+	std::vector<std::vector<int> > spk1 = sm1->getSpikeVector2D();
+	for (int i=0; i<nNeur; i++) {
+		ASSERT_EQ(spk0[i].size(), (2200-1)/(i+10)); // every ISI in [1, 2200)
+		EXPECT_EQ(spk1[i], spk0[i]);
+	}
+}
+
+// a generator that overrides neither callback would silently produce no spikes
+class EmptySpikeGenerator : public SpikeGenerator {
+};
+
+TEST(spikeGenFunc, EmptySpikeGeneratorDeath) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	CARLsim sim("EmptySpikeGeneratorDeath",CPU_MODE,SILENT,0,42);
+	int g0 = sim.createSpikeGeneratorGroup("Input",10,EXCITATORY_NEURON);
+	int g1 = sim.createGroup("g1", 1, EXCITATORY_NEURON);
+	sim.setNeuronParameters(g1, 0.02, 0.2, -65.0, 8.0);
+	EmptySpikeGenerator spkGen;
+	sim.setSpikeGenerator(g0, &spkGen);
+	sim.connect(g0,g1,"full", RangeWeight(0.0f), 1.0f);
+	sim.setConductances(false);
+	sim.setupNetwork();
+
+	EXPECT_DEATH({sim.runNetwork(1,0);},"");
+}
+
 TEST(spikeGenFunc, PeriodicSpikeGeneratorDeath) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -306,6 +425,68 @@ TEST(spikeGenFunc, SpikeGeneratorFromFileLoadFile) {
 	}
 }
 
+// tests whether spikes written to a compressed spike file are scheduled again by SpikeGeneratorFromFile, and
+// whether the compressed file is smaller than the raw AER format
+TEST(spikeGenFunc, SpikeGeneratorFromCompressedFile) {
+	const int nNeur = 100;
+	std::string fileName = "results/spk_compressed.dat";
+	std::vector< std::vector<int> > spkVec0, spkVec1;
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		for (int run=0; run<=1; run++) {
+			CARLsim* sim = new CARLsim("SpikeGeneratorFromCompressedFile",mode?GPU_MODE:CPU_MODE,SILENT,1,42);
+			int g1 = sim->createGroup("g1", nNeur, EXCITATORY_NEURON);
+			sim->setNeuronParameters(g1, 0.02, 0.2, -65.0, 8.0);
+
+			int g0 = sim->createSpikeGeneratorGroup("g0", nNeur, EXCITATORY_NEURON);
+			SpikeGeneratorFromFile* sgf = NULL;
+			if (run==1) {
+				sgf = new SpikeGeneratorFromFile(fileName);
+				sim->setSpikeGenerator(g0, sgf);
+			}
+			sim->connect(g0,g1,"one-to-one",RangeWeight(0.1f), 1.0f);
+			sim->setConductances(true);
+			sim->setupNetwork();
+
+			PoissonRate poiss(nNeur);
+			if (run==0) {
+				// first run: record Poisson spike trains to a compressed file
+				poiss.setRates(30.0f);
+				sim->setSpikeRate(g0, &poiss);
+			}
+
+			SpikeMonitor* SM = sim->setSpikeMonitor(g0, "NULL");
+			if (run==0)
+				SM->setLogFile(fileName, true);
+			SM->startRecording();
+			sim->runNetwork(2,500,false);
+			SM->stopRecording();
+
+			if (run==0) {
+				spkVec0 = SM->getSpikeVector2D();
+
+				// header section plus at most one block per second, each must be smaller than raw AER
+				FILE* fp = fopen(fileName.c_str(), "rb");
+				ASSERT_TRUE(fp != NULL);
+				fseek(fp, 0, SEEK_END);
+				long fileSize = ftell(fp);
+				fclose(fp);
+				EXPECT_GT(SM->getPopNumSpikes(), 0);
+				EXPECT_LT(fileSize, 4*sizeof(int)+sizeof(float) + SM->getPopNumSpikes()*2*sizeof(int));
+			} else {
+				spkVec1 = SM->getSpikeVector2D();
+				ASSERT_EQ(spkVec0.size(), spkVec1.size());
+				for (int neurId=0; neurId<spkVec0.size(); neurId++)
+					EXPECT_EQ(spkVec0[neurId], spkVec1[neurId]);
+			}
+
+			if (sgf != NULL)
+				delete sgf;
+			delete sim;
+		}
+	}
+}
+
 TEST(spikeGenFunc, SpikeGeneratorFromFileDeath) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 	EXPECT_DEATH({SpikeGeneratorFromFile spkGen("");},"");
@@ -401,6 +401,117 @@ TEST(SpikeMon, spikeTimes) {
 	}
 }
 
+/*
+ * This test checks that the spikes of a local network are distributed to the right monitors when several groups are
+ * monitored and the monitors are updated at different times (updateSpikeMonitor of a single group in the middle of a
+ * second, and of all groups at the end of a second).
+ */
+TEST(SpikeMon, multipleGroups) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const int NUM_GRPS = 4;
+	const int GRP_SIZE = 5;
+	const int rates[NUM_GRPS] = {10, 20, 25, 50}; // integer inter-spike intervals
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		CARLsim* sim = new CARLsim("SpikeMon.multipleGroups",mode?GPU_MODE:CPU_MODE,SILENT,1,42);
+
+		int grps[NUM_GRPS];
+		PeriodicSpikeGenerator* spkGens[NUM_GRPS];
+		for (int g=0; g<NUM_GRPS; g++) {
+			grps[g] = sim->createSpikeGeneratorGroup("input", GRP_SIZE, EXCITATORY_NEURON, 0);
+			spkGens[g] = new PeriodicSpikeGenerator(rates[g], true);
+			sim->setSpikeGenerator(grps[g], spkGens[g]);
+		}
+		int gOut = sim->createGroup("output", GRP_SIZE, EXCITATORY_NEURON, 0);
+		sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(grps[0], gOut, "one-to-one", RangeWeight(0.1f), 1.0f);
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		SpikeMonitor* spkMons[NUM_GRPS];
+		for (int g=0; g<NUM_GRPS; g++) {
+			spkMons[g] = sim->setSpikeMonitor(grps[g], "NULL");
+			spkMons[g]->startRecording();
+		}
+
+		// the first monitor stops in the middle of the second, the others record for two seconds
+		sim->runNetwork(0, 500);
+		spkMons[0]->stopRecording();
+		sim->runNetwork(1, 500);
+		for (int g=1; g<NUM_GRPS; g++)
+			spkMons[g]->stopRecording();
+
+		EXPECT_EQ(spkMons[0]->getPopNumSpikes(), rates[0] / 2 * GRP_SIZE);
+		for (int g=1; g<NUM_GRPS; g++) {
+			EXPECT_EQ(spkMons[g]->getPopNumSpikes(), 2 * rates[g] * GRP_SIZE);
+
+			std::vector<std::vector<int> > spkVector = spkMons[g]->getSpikeVector2D();
+			int isi = 1000 / rates[g];
+			for (int i=0; i<GRP_SIZE; i++) {
+				for (int j=0; j<spkVector[i].size(); j++)
+					EXPECT_EQ(spkVector[i][j], j * isi);
+			}
+		}
+
+		for (int g=0; g<NUM_GRPS; g++)
+			delete spkGens[g];
+		delete sim;
+	}
+}
+
+/*
+ * This test checks that the spike file, which is written in the background, contains exactly the spikes recorded by
+ * the AER vector of the SpikeMonitor, and that it is complete whenever runNetwork returns.
+ */
+TEST(SpikeMon, spikeFileMatchesAER) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const int GRP_SIZE = 10;
+	const std::string fileName = "results/spk_async.dat";
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		CARLsim* sim = new CARLsim("SpikeMon.spikeFileMatchesAER",mode?GPU_MODE:CPU_MODE,SILENT,1,42);
+		int g0 = sim->createSpikeGeneratorGroup("input", GRP_SIZE, EXCITATORY_NEURON);
+		int g1 = sim->createGroup("output", GRP_SIZE, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(g0, g1, "one-to-one", RangeWeight(0.1f), 1.0f);
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		PoissonRate poissRate(GRP_SIZE);
+		poissRate.setRates(40.0f);
+		sim->setSpikeRate(g0, &poissRate);
+
+		SpikeMonitor* spkMon = sim->setSpikeMonitor(g0, fileName);
+		spkMon->startRecording();
+		sim->runNetwork(2, 0);
+		sim->runNetwork(0, 300);
+		spkMon->stopRecording();
+
+		// the file must be complete although the simulation is still alive
+		int* inputArray = NULL;
+		long inputSize;
+		readAndReturnSpikeFile(fileName, inputArray, inputSize);
+
+		std::vector<std::vector<int> > spkVector = spkMon->getSpikeVector2D();
+		std::vector<std::vector<int> > spkVectorFile(GRP_SIZE);
+		for (int i=0; i<inputSize; i+=2) {
+			ASSERT_GE(inputArray[i+1], 0);
+			ASSERT_LT(inputArray[i+1], GRP_SIZE);
+			spkVectorFile[inputArray[i+1]].push_back(inputArray[i]);
+		}
+
+		EXPECT_EQ(inputSize/2, spkMon->getPopNumSpikes());
+		EXPECT_GT(spkMon->getPopNumSpikes(), 0);
+		for (int i=0; i<GRP_SIZE; i++)
+			EXPECT_EQ(spkVectorFile[i], spkVector[i]);
+
+		delete[] inputArray;
+		delete sim;
+	}
+}
+
 /*
  * This test checks for the correctness of the getGroupFiringRate method.
  * A PeriodicSpikeGenerator is used to periodically generate input spikes, so that the input spike times are known.
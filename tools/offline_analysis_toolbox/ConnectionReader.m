@@ -49,6 +49,9 @@ classdef ConnectionReader < handle
         nNeurPost;
         nSynapses;
         isPlastic;
+        isSparse;            % whether snapshots store one weight per synapse (version >= 0.4)
+        synIdsPre;           % pre-synaptic neuron ID of each synapse (sparse files)
+        synIdsPost;          % post-synaptic neuron ID of each synapse (sparse files)
         
         errorFlag;           % error flag (true if error occured)
         errorMsg;            % error message
@@ -178,11 +181,58 @@ classdef ConnectionReader < handle
                 
                 % read data and append  to member
                 obj.timeStamps = [obj.timeStamps fread(obj.fileId, 1, 'int64')];
-                obj.weights(end+1,:) = fread(obj.fileId, obj.nNeurPre*obj.nNeurPost, 'float32');
+                if obj.isSparse
+                    % scatter the per-synapse weights into a dense row,
+                    % non-existent synapses are NaN (same as dense files)
+                    wts = fread(obj.fileId, obj.nSynapses, 'float32');
+                    row = nan(1, obj.nNeurPre*obj.nNeurPost);
+                    row(obj.synIdsPre*obj.nNeurPost + obj.synIdsPost + 1) = wts;
+                    obj.weights(end+1,:) = row;
+                else
+                    obj.weights(end+1,:) = fread(obj.fileId, obj.nNeurPre*obj.nNeurPost, 'float32');
+                end
             end
             timeStamps = obj.timeStamps;
             weights = obj.weights;
         end
+        
+        function [timeStamps, weights, preIds, postIds] = readWeightsSparse(obj, snapShots)
+            % [timeStamps, weights, preIds, postIds] = CR.readWeightsSparse(snapShots)
+            % reads the specified snapshots without expanding them into
+            % dense nNeurPre x nNeurPost rows. Each row of weights holds
+            % one entry per synapse; preIds and postIds (zero-indexed)
+            % give the pre- and post-synaptic neuron of each column.
+            % Only supported for files of version >= 0.4.
+            if ~obj.isSparse
+                obj.throwError(['readWeightsSparse requires a connect ' ...
+                    'file of version >= 0.4.'])
+                return
+            end
+            if nargin<2 || isempty(snapShots) || snapShots==-1
+                snapShots = 1:obj.nSnapshots;
+            end
+            if snapShots==0
+                obj.throwError('snapShots must be a list of snapshots.')
+                return
+            end
+            
+            timeStamps = zeros(1, numel(snapShots));
+            weights = zeros(numel(snapShots), obj.nSynapses);
+            for i=1:numel(snapShots)
+                % skip header and (frame-1) snapshots
+                szByteToSkip = obj.fileSizeByteHeader ...
+                    + obj.fileSizeByteSnapshot*(snapShots(i)-1);
+                status = fseek(obj.fileId, szByteToSkip, 'bof');
+                if status==-1
+                    obj.throwError(ferror(obj.fileId))
+                    return
+                end
+                timeStamps(i) = fread(obj.fileId, 1, 'int64');
+                weights(i,:) = fread(obj.fileId, obj.nSynapses, 'float32');
+            end
+            preIds = obj.synIdsPre;
+            postIds = obj.synIdsPost;
+        end
     end
     
     %% PRIVATE METHODS
@@ -210,6 +260,9 @@ classdef ConnectionReader < handle
             obj.nNeurPost = -1;
             obj.nSynapses = -1;
             obj.isPlastic = false;
+            obj.isSparse = false;
+            obj.synIdsPre = [];
+            obj.synIdsPost = [];
             obj.nSnapshots = -1;
             
             obj.supportedErrorModes = {'standard', 'warning', 'silent'};
@@ -323,13 +376,30 @@ classdef ConnectionReader < handle
                         num2str(obj.maxWt) ')'])
             end
             
+            % since version 0.4, the header lists the pre and post neuron
+            % IDs of all synapses, and each snapshot stores one weight per
+            % synapse in that order (instead of a dense weight matrix)
+            obj.isSparse = floor((version-obj.fileVersionMajor)*10.01)>=4;
+            if obj.isSparse
+                obj.synIdsPre = fread(obj.fileId, [1 obj.nSynapses], 'int32');
+                obj.synIdsPost = fread(obj.fileId, [1 obj.nSynapses], 'int32');
+                if numel(obj.synIdsPost)~=obj.nSynapses
+                    obj.throwError('Could not read synapse topology.')
+                    return
+                end
+            end
+            
             % store the size of the header section, so that we can skip it
             % when re-reading spikes
             obj.fileSizeByteHeader = ftell(obj.fileId);
             
             % find size of each snapshot: #weights * sizeof(float32) +
             % sizeof(long int)
-            obj.fileSizeByteSnapshot = obj.nNeurPre*obj.nNeurPost*4+8;
+            if obj.isSparse
+                obj.fileSizeByteSnapshot = obj.nSynapses*4+8;
+            else
+                obj.fileSizeByteSnapshot = obj.nNeurPre*obj.nNeurPost*4+8;
+            end
 
             % compute number of snapshots present in the file
             % find byte size from here on until end of file, divide it by
@@ -186,6 +186,35 @@ classdef SimulationReader < handle
             % reading synapse info is optional
             if loadSynapseInfo
                 syns = struct();
+                if version > 0.35
+                    % version 0.4+: section table followed by one aligned
+                    % array per synapse field
+                    nrSyn = fread(fid,1,'int32');
+                    nrSections = fread(fid,1,'int32');
+                    fseek(fid,ceil(ftell(fid)/8)*8,'bof');
+                    sections = zeros(nrSections,4);
+                    for s=1:nrSections
+                        sections(s,1:2) = fread(fid,2,'int32');
+                        sections(s,3:4) = fread(fid,2,'int64');
+                    end
+                    fields = {'gGrpIdPre','gGrpIdPost','grpNIdPre', ...
+                        'grpNIdPost','connId','weights','maxWeights','delays'};
+                    types = {'int32=>uint32','int32=>uint32','int32=>uint32', ...
+                        'int32=>uint32','int32=>uint32','single=>single', ...
+                        'single=>single','uint8=>uint32'};
+                    for s=1:nrSections
+                        % unknown sections are skipped
+                        id = sections(s,1)+1;
+                        if id > numel(fields)
+                            continue;
+                        end
+                        fseek(fid,sections(s,3),'bof');
+                        syns.(fields{id}) = fread(fid,sections(s,4),types{id});
+                    end
+                    obj.syns = syns;
+                    obj.fileId = fid;
+                    return;
+                end
                 netCount = fread(fid,1,'int32');
                 weightData = cell(netCount,1);
                 for n=1:netCount
@@ -14,6 +14,9 @@ classdef SpikeReader < handle
     % >> stimLengthMs = SR.getSimDurMs();
     % >> % etc.
     %
+    % Both the raw (version 0.2) and the compressed (version 0.3) spike
+    % file formats are supported (see SpikeMonitor::setLogFile).
+    %
     % Version 5/21/2015
     % Author: Michael Beyeler <mbeyeler@uci.edu>
     
@@ -32,6 +35,7 @@ classdef SpikeReader < handle
         fileVersionMajor;    % required major version number
         fileVersionMinor;    % required minimum minor version number
         fileSizeByteHeader;  % byte size of header section
+        isCompressed;        % flag whether file is in compressed format
         
         grid3D;              % 3D grid dimensions of group
         binWindow;           % binning window for spike times (ms)
@@ -142,6 +146,19 @@ classdef SpikeReader < handle
             %
             % The total simulation duration is usually stored in a
             % "sim_{simName}.dat" file and can be retrieved by using a
+            if obj.isCompressed
+                % walk the block headers, the last block holds the time
+                % stamp of the last spike
+                simDurMs = -1;
+                fseek(obj.fileId, obj.fileSizeByteHeader, 'bof');
+                blockHeader = fread(obj.fileId, [1 4], 'int32');
+                while numel(blockHeader)==4
+                    simDurMs = blockHeader(3);
+                    fseek(obj.fileId, blockHeader(1), 'cof');
+                    blockHeader = fread(obj.fileId, [1 4], 'int32');
+                end
+                return
+            end
             fseek(obj.fileId, -8, 'eof'); % jump to penultimate int
             simDurMs = fread(obj.fileId, 1, 'int32');
         end
@@ -179,11 +196,16 @@ classdef SpikeReader < handle
             d=zeros(0,nrRead);
             spk=[];
             
-            while size(d,2)==nrRead
+            while size(d,2)==nrRead || (obj.isCompressed && ~isempty(d))
                 % D is a 2xNRREAD matrix.  Row 1 contains the times that
                 % the neuron spiked. Row 2 contains the neuron id that
                 % spiked at this corresponding time.
-                d = fread(obj.fileId, [2 nrRead], 'int32');
+                if obj.isCompressed
+                    % one block at a time
+                    d = obj.readCompressedBlock();
+                else
+                    d = fread(obj.fileId, [2 nrRead], 'int32');
+                end
 
                 if ~isempty(d)
                     if obj.binWindow<0
@@ -237,6 +259,52 @@ classdef SpikeReader < handle
     
     %% PRIVATE METHODS
     methods (Hidden, Access = private)
+        function d = readCompressedBlock(obj)
+            % d = SR.readCompressedBlock() reads the next block of a
+            % compressed spike file and returns its spikes in AER format
+            % [times;nIDs]. Returns an empty matrix at the end of file.
+            %
+            % A block consists of a header (int32: number of bytes that
+            % follow, first spike time, last spike time, number of
+            % spikes), followed by one spike list per millisecond: the
+            % time difference to the previous list, the number of spikes,
+            % and the delta-encoded neuron IDs, all stored as unsigned
+            % LEB128 variable-length integers.
+            d = [];
+            blockHeader = fread(obj.fileId, [1 4], 'int32');
+            if numel(blockHeader)<4
+                return
+            end
+            bytes = fread(obj.fileId, blockHeader(1), 'uint8=>double');
+            numSpikes = blockHeader(4);
+            if numel(bytes)~=blockHeader(1)
+                obj.throwError('Unexpected end of compressed spike file.')
+                return
+            end
+            
+            % decode all varints of the block at once: every byte with
+            % the high bit cleared terminates a value
+            isLast = bytes<128;
+            varIdx = cumsum([1; isLast(1:end-1)]);
+            firstByte = find([true; isLast(1:end-1)]);
+            bytePos = (1:numel(bytes))' - firstByte(varIdx);
+            vals = accumarray(varIdx, mod(bytes,128).*2.^(7*bytePos));
+            
+            % unpack the per-ms spike lists
+            d = zeros(2, numSpikes);
+            t = blockHeader(2);
+            i = 1;
+            k = 0;
+            while k<numSpikes
+                t = t + vals(i);
+                n = vals(i+1);
+                d(1,k+1:k+n) = t;
+                d(2,k+1:k+n) = cumsum(vals(i+2:i+1+n));
+                i = i+2+n;
+                k = k+n;
+            end
+        end
+        
         function isSupported = isErrorModeSupported(obj, errMode)
             % determines whether an error mode is currently supported
             isSupported = sum(ismember(obj.supportedErrorModes,errMode))>0;
@@ -249,6 +317,7 @@ classdef SpikeReader < handle
             obj.fileVersionMajor = 0;
             obj.fileVersionMinor = 2;
             obj.fileSizeByteHeader = -1; % to be set in openFile
+            obj.isCompressed = false; % to be set in openFile
             
             obj.grid3D = -1; % to be set in openFile
             
@@ -323,6 +392,9 @@ classdef SpikeReader < handle
                 return
             end
             
+            % version 0.3 files are compressed
+            obj.isCompressed = floor((version-obj.fileVersionMajor)*10.01)>=3;
+            
             % store the size of the header section, so that we can skip it
             % when re-reading spikes
             obj.fileSizeByteHeader = ftell(obj.fileId);
@@ -48,6 +48,7 @@
 
 #include <periodic_spikegen.h>
 
+#include <carlsim.h>
 #include <user_errors.h>	// fancy error messages
 #include <algorithm>		// std::find
 #include <vector>			// std::vector
@@ -78,6 +79,29 @@ int PeriodicSpikeGenerator::nextSpikeTime(CARLsim* sim, int grpId, int nid, int
 	return lastScheduledSpikeTime+isi_;
 }
 
+bool PeriodicSpikeGenerator::generateSpikes(CARLsim* sim, int grpId, int tStart, int tEnd, SpikeSink& sink) {
+	int numN = sim->getGroupNumNeurons(grpId);
+
+	// the first spike is at t=0 or t=ISI, all following spikes are on the ISI grid
+	int tFirst = spikeAtZero_ ? 0 : isi_;
+	if (isi_ < 1) {
+		// rates above 1kHz: only the spike at t=0 can be scheduled, see nextSpikeTime
+		if (spikeAtZero_ && tStart <= 0 && tEnd > 0)
+			for (int nid = 0; nid < numN; nid++)
+				sink.addSpike(0, nid);
+		return true;
+	}
+
+	int t = tFirst;
+	if (tStart > tFirst)
+		t += (tStart - tFirst + isi_ - 1) / isi_ * isi_; // first grid point >= tStart
+	for (; t < tEnd; t += isi_)
+		for (int nid = 0; nid < numN; nid++)
+			sink.addSpike(t, nid);
+
+	return true;
+}
+
 void PeriodicSpikeGenerator::checkFiringRate() {
 	UserErrors::assertTrue(rate_>0, UserErrors::MUST_BE_POSITIVE, "PeriodicSpikeGenerator", "Firing rate");
 }
\ No newline at end of file
@@ -84,6 +84,20 @@ public:
 	 */
 	int nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice);
 
+	/*!
+	 * \brief schedules all spikes of a group for a scheduling time slice
+	 *
+	 * All neurons of the group spike at multiples of the ISI, starting at t=0 if spikeAtZero was set, and starting at
+	 * t=ISI otherwise. It implements the virtual function of the base class.
+	 * \param[in] sim pointer to a CARLsim object
+	 * \param[in] grpId current group ID for which to schedule spikes
+	 * \param[in] tStart current time (ms), beginning of the scheduling time slice
+	 * \param[in] tEnd end of the scheduling time slice (ms)
+	 * \param[in] sink the SpikeSink to which the spikes are added
+	 * \returns true
+	 */
+	bool generateSpikes(CARLsim* sim, int grpId, int tStart, int tEnd, SpikeSink& sink);
+
 private:
 	void checkFiringRate();
 	
@@ -53,6 +53,7 @@
 #include <stdio.h>				// fopen, fread, fclose
 #include <string.h>				// std::string
 #include <assert.h>				// assert
+#include <algorithm>			// std::min
 
 // #define VERBOSE
 
@@ -62,6 +63,7 @@ SpikeGeneratorFromFile::SpikeGeneratorFromFile(std::string fileName, int offsetT
 
 	nNeur_ = -1;
 	szByteHeader_ = -1;
+	isCompressed_ = false;
 	offsetTimeMs_ = offsetTimeMs;
 
 	// move unsafe operations out of constructor
@@ -111,7 +113,13 @@ void SpikeGeneratorFromFile::openFile() {
 	// needs to be updated every time header changes
 	FILE* fp = fpBegin_;
 	szByteHeader_ = 4*sizeof(int)+1*sizeof(float);
-	fseek(fp, sizeof(int)+sizeof(float), SEEK_SET); // skipping signature+version
+	fseek(fp, sizeof(int), SEEK_SET); // skipping signature
+
+	// version 0.3 files are compressed
+	float version;
+	size_t result = fread(&version, sizeof(float), 1, fp);
+	UserErrors::assertTrue(result == 1, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+	isCompressed_ = version > 0.25f;
 
 	// get number of neurons from header
 	nNeur_ = 1;
@@ -141,6 +149,12 @@ void SpikeGeneratorFromFile::init() {
 	FILE* fp = fpBegin_;
 	fseek(fp, szByteHeader_, SEEK_SET); // skip header section
 
+	if (isCompressed_) {
+		readCompressedSpikes();
+		rewind(offsetTimeMs_);
+		return;
+	}
+
 	std::string funcName = "readFile("+fileName_+")";
 	int tmpTime = -1;
 	int tmpNeurId = -1;
@@ -169,6 +183,54 @@ void SpikeGeneratorFromFile::init() {
 	rewind(offsetTimeMs_);
 }
 
+// reads an unsigned integer that is stored 7 bits at a time (LEB128), returns false if the buffer is exhausted
+static bool readVarint(const std::vector<unsigned char>& bytes, size_t& pos, unsigned int& val) {
+	val = 0;
+	for (int shift = 0; pos < bytes.size() && shift < 35; shift += 7) {
+		unsigned char b = bytes[pos++];
+		val |= (unsigned int)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+// the compressed format is a sequence of blocks, each a header {numBytes, firstTime, lastTime, numSpikes}
+// followed by per-ms spike lists {dt, n, dNId[n]} (see SpikeMonitorCore::encodeSpikeFileBlock)
+void SpikeGeneratorFromFile::readCompressedSpikes() {
+	std::string funcName = "readFile("+fileName_+")";
+	FILE* fp = fpBegin_;
+	std::vector<unsigned char> bytes;
+
+	int header[4];
+	while (fread(header, sizeof(int), 4, fp) == 4) {
+		int numBytes = header[0], time = header[1], numSpikes = header[3];
+		UserErrors::assertTrue(numBytes >= 0 && numSpikes >= 0, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+
+		bytes.resize(numBytes);
+		size_t result = numBytes ? fread(&bytes[0], 1, numBytes, fp) : 0;
+		UserErrors::assertTrue(result == (size_t)numBytes, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+
+		size_t pos = 0;
+		int spikesRead = 0;
+		while (spikesRead < numSpikes) {
+			unsigned int dt = 0, n = 0, dNId = 0;
+			UserErrors::assertTrue(readVarint(bytes, pos, dt), UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+			UserErrors::assertTrue(readVarint(bytes, pos, n), UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+			time += dt;
+
+			int neurId = 0;
+			for (unsigned int i = 0; i < n; i++) {
+				UserErrors::assertTrue(readVarint(bytes, pos, dNId), UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+				neurId += dNId;
+				UserErrors::assertTrue(neurId < nNeur_, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+				spikes_[neurId].push_back(time); // add spike time to 2D vector
+			}
+			spikesRead += n;
+		}
+	}
+}
+
 int SpikeGeneratorFromFile::nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice) {
 	assert(nNeur_>0);
 	assert(nid < nNeur_);
@@ -194,3 +256,28 @@ int SpikeGeneratorFromFile::nextSpikeTime(CARLsim* sim, int grpId, int nid, int
 	// this will signal CARLsim to break the nextSpikeTime loop
 	return -1; // large positive number
 }
+
+bool SpikeGeneratorFromFile::generateSpikes(CARLsim* sim, int grpId, int tStart, int tEnd, SpikeSink& sink) {
+	assert(nNeur_>0);
+
+	// neurons in the file that do not exist in the group are never scheduled, same as in nextSpikeTime
+	int numN = std::min(nNeur_, sim->getGroupNumNeurons(grpId));
+	for (int nid=0; nid<numN; nid++) {
+		std::vector<int>::iterator it = spikesIt_[nid];
+		std::vector<int>::iterator itEnd = spikes_[nid].end();
+
+		// spike times in the past can no longer be scheduled
+		while (it != itEnd && *it+offsetTimeMs_ < tStart)
+			++it;
+
+		// schedule all spikes of this neuron in the current scheduling time slice
+		while (it != itEnd && *it+offsetTimeMs_ < tEnd) {
+			sink.addSpike(*it+offsetTimeMs_, nid);
+			++it;
+		}
+
+		spikesIt_[nid] = it;
+	}
+
+	return true;
+}
@@ -111,6 +111,9 @@ class CARLsim;
  * sim.runNetwork(1,0);
  * \endcode
  *
+ * Both the raw (version 0.2) and the compressed (version 0.3, see SpikeMonitor::setLogFile) spike file formats are
+ * supported.
+ *
  * \note Make sure the new neuron group has the exact same number of neurons as the group that was used to record
  * the spike file.
  * \attention Upon initializiation, all spikes from the spike file will be buffered as vectors of ints, which might
@@ -187,14 +190,33 @@ public:
 	 */
 	int nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice);
 
+	/*!
+	 * \brief schedules all spikes of a scheduling time slice
+	 *
+	 * This function schedules the spikes of all neurons that fall into the current scheduling time slice, in a single
+	 * call. It implements the virtual function of the base class.
+	 * \param[in] sim pointer to a CARLsim object
+	 * \param[in] grpId current group ID for which to schedule spikes
+	 * \param[in] tStart current time (ms), beginning of the scheduling time slice
+	 * \param[in] tEnd end of the scheduling time slice (ms). A spike delivered at a time >= tEnd will be scheduled
+	 *                 in a later time slice
+	 * \param[in] sink the SpikeSink to which the spikes are added
+	 * \returns true
+	 */
+	bool generateSpikes(CARLsim* sim, int grpId, int tStart, int tEnd, SpikeSink& sink);
+
 private:
 	void openFile();
 	void init();
 
+	//! reads the spikes of a compressed spike file (version 0.3) into spikes_
+	void readCompressedSpikes();
+
 	std::string fileName_;		//!< file name
 	FILE* fpBegin_;				//!< pointer to beginning of file
 	int szByteHeader_;          //!< number of bytes in header section
                                 //!< \FIXME: there should be a standardized SpikeReader++ utility
+	bool isCompressed_;         //!< whether the spike file is in the compressed format
 
 	//! A 2D vector of spike times, first dim=neuron ID, second dim=spike times.
 	//! This makes it easy to keep track of which spike needs to be scheduled next, by maintaining
@@ -68,6 +68,17 @@ int SpikeGeneratorFromVector::nextSpikeTime(CARLsim* sim, int grpId, int nid, in
 	return -1; // -1: large positive number
 }
 
+bool SpikeGeneratorFromVector::generateSpikes(CARLsim* sim, int grpId, int tStart, int tEnd, SpikeSink& sink) {
+	// spike times in the past can no longer be scheduled
+	while (currentIndex_ < size_ && spkTimes_[currentIndex_] < tStart)
+		currentIndex_++;
+
+	while (currentIndex_ < size_ && spkTimes_[currentIndex_] < tEnd)
+		sink.addSpike(spkTimes_[currentIndex_++], 0);
+
+	return true;
+}
+
 void SpikeGeneratorFromVector::checkSpikeVector() {
 	UserErrors::assertTrue(size_>0,UserErrors::CANNOT_BE_ZERO, "SpikeGeneratorFromVector", "Vector size");
 	for (int i=0; i<size_; i++) {
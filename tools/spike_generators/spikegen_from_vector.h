@@ -84,6 +84,20 @@ public:
 	 */
 	int nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice);
 
+	/*!
+	 * \brief schedules all spikes of a scheduling time slice
+	 *
+	 * This function schedules all spike times in the vector that fall into the current scheduling time slice. All
+	 * spikes are delivered to the first neuron of the group. It implements the virtual function of the base class.
+	 * \param[in] sim pointer to a CARLsim object
+	 * \param[in] grpId current group ID for which to schedule spikes
+	 * \param[in] tStart current time (ms), beginning of the scheduling time slice
+	 * \param[in] tEnd end of the scheduling time slice (ms)
+	 * \param[in] sink the SpikeSink to which the spikes are added
+	 * \returns true
+	 */
+	bool generateSpikes(CARLsim* sim, int grpId, int tStart, int tEnd, SpikeSink& sink);
+
 private:
 	void checkSpikeVector();
 	